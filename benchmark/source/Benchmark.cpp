@@ -0,0 +1,944 @@
+// Iso3D benchmark: times Crossover (3-band, plus a 2 to 6 band sweep), the
+// linear-phase LinearPhaseCrossover next to it and AudioPluginAudioProcessor::processBlock
+// (with and without band metering), in single and double precision, in ns per sample
+// frame, and saving and restoring the plugin state in ns per instance with the heap
+// allocations each call makes. Writes the results as JSON and compares them with a stored
+// baseline. Exits non-zero when any case is slower than baseline * (1 + tolerance), and
+// with --quick, the mode CTest runs, when there is no baseline to compare with.
+//
+// Usage:
+//   AudioPluginBenchmark [--quick] [--filter=<substring>] [--output=<results.json>]
+//                        [--baseline=<baseline.json>] [--tolerance=<fraction>]
+//                        [--write-baseline]
+
+#include <Iso3D/Constants.h>
+#include <Iso3D/Crossover.h>
+#include <Iso3D/FusedCrossover.h>
+#include <Iso3D/LinearPhaseCrossover.h>
+#include <Iso3D/PluginProcessor.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+using namespace audio_plugin;
+
+// ----- Heap allocation counting -----
+//
+// With glibc the malloc family is interposed, as in the tests' real-time checks, to count
+// the heap allocations the calling thread makes in countAllocations(). Elsewhere they are
+// not counted and cases report -1.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define ISO3D_COUNT_ALLOCATIONS 1
+#else
+#define ISO3D_COUNT_ALLOCATIONS 0
+#endif
+
+#if ISO3D_COUNT_ALLOCATIONS
+
+namespace {
+
+constinit thread_local bool countingAllocations = false;
+constinit thread_local int64_t numAllocations = 0;
+
+void countAllocation() {
+    if (countingAllocations) ++numAllocations;
+}
+
+}  // namespace
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) noexcept {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+    countAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    countAllocation();
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+
+    void* allocated = __libc_memalign(alignment, size);
+    if (allocated == nullptr) return ENOMEM;
+    *pointer = allocated;
+    return 0;
+}
+
+}  // extern "C"
+
+#endif  // ISO3D_COUNT_ALLOCATIONS
+
+namespace {
+
+constexpr double kSampleRates[] = {44100.0, 48000.0, 96000.0, 192000.0};
+constexpr int kBlockSizes[] = {1, 16, 64, 256, 1024, 4096};
+constexpr int kMaxBlockSize = 4096;
+constexpr int kSourceLength = 2 * kMaxBlockSize;
+
+constexpr int kStereoChannels = 2;
+
+// Channel-count sweep (mono, stereo, 5.1, 7.1.4, 32, 64) at a fixed rate and block size.
+// The band-count sweep runs stereo at the same rate and block size.
+constexpr int kChannelCounts[] = {1, 2, 6, 12, 32, kMaxChannels};
+constexpr double kChannelSweepSampleRate = 48000.0;
+constexpr int kChannelSweepBlockSize = 256;
+
+// Deck sweep: multi-deck processors against as many single-deck instances, at the
+// channel-sweep rate and block size
+constexpr int kDeckCounts[] = {2, kMaxDecks};
+
+// Worker sweep: wide layouts with their knobs moving, on the audio thread alone and with
+// 1 to kMaxWorkerThreads workers, as many as the machine has cores besides the audio thread
+constexpr int kWorkerChannelCounts[] = {32, kMaxChannels};
+constexpr int kWorkerBlockSizes[] = {32, 256, 1024};
+
+// Execution sweep: the default crossover vectorized across channels, along time, and as
+// chosen per group, on the large blocks time-parallel execution is meant for. Mono is
+// time-parallel throughout; 5.1 in float splits into a full group and a pair.
+constexpr int kExecutionChannelCounts[] = {1, 6};
+constexpr int kExecutionBlockSizes[] = {kMinTimeParallelSamples, 1024, kMaxBlockSize};
+
+constexpr int kFramesPerRun = 1 << 18;
+constexpr int kQuickFramesPerRun = 1 << 15;
+constexpr int kRepetitions = 5;
+constexpr int kQuickRepetitions = 3;
+constexpr int kWarmupBlocks = 64;
+constexpr int kStateCallsPerRun = 2000;
+constexpr int kQuickStateCallsPerRun = 200;
+constexpr double kDefaultTolerance = 0.25;
+
+constexpr float kAutomationRateHz = 4.0f;
+
+enum class GainState { unity, kill, boost, automation, drive, sweep };
+constexpr GainState kGainStates[] = {GainState::unity,      GainState::kill,  GainState::boost,
+                                     GainState::automation, GainState::drive, GainState::sweep};
+
+const char* gainStateName(GainState state) {
+    switch (state) {
+        case GainState::unity: return "unity";
+        case GainState::kill: return "kill";
+        case GainState::boost: return "boost";
+        case GainState::automation: return "automation";
+        case GainState::drive: return "drive";
+        case GainState::sweep: return "sweep";
+    }
+    return "unknown";
+}
+
+struct Settings {
+    int framesPerRun = kFramesPerRun;
+    int stateCallsPerRun = kStateCallsPerRun;
+    int repetitions = kRepetitions;
+    juce::String filter;
+};
+
+struct Result {
+    juce::String name;
+    juce::String target;
+    juce::String gainState;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int numChannels = 0;
+    double nsPerSample = 0.0;  // per call for state cases, see unit
+
+    const char* unit = "ns/sample";
+    double allocations = -1.0;  // heap allocations per call for state cases, -1 if not counted
+    int numWorkers = -1;  // worker threads for worker cases, -1 otherwise
+};
+
+// Calls fn numCalls times, repeats that, and returns the fastest repetition in ns per
+// call.
+template <typename Fn>
+double measureNsPerCall(const Settings& settings, int numCalls, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+
+    for (int call = 0; call < std::min(numCalls, kWarmupBlocks); ++call) fn();
+
+    double bestNs = std::numeric_limits<double>::max();
+    for (int rep = 0; rep < settings.repetitions; ++rep) {
+        const auto start = Clock::now();
+        for (int call = 0; call < numCalls; ++call) fn();
+        const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        bestNs = std::min(bestNs, elapsed.count());
+    }
+
+    return bestNs / static_cast<double>(numCalls);
+}
+
+// Calls processOneBlock until framesPerRun frames are covered, repeats that, and
+// returns the fastest repetition in ns per sample frame (all channels together).
+template <typename ProcessFn>
+double measureNsPerSample(const Settings& settings, int blockSize, ProcessFn&& processOneBlock) {
+    const int numBlocks = std::max(1, settings.framesPerRun / blockSize);
+    return measureNsPerCall(settings, numBlocks, processOneBlock) / static_cast<double>(blockSize);
+}
+
+// Heap allocations fn() makes on the calling thread, or -1 where they aren't counted
+template <typename Fn>
+int64_t countAllocations(Fn&& fn) {
+#if ISO3D_COUNT_ALLOCATIONS
+    numAllocations = 0;
+    countingAllocations = true;
+    fn();
+    countingAllocations = false;
+    return numAllocations;
+#else
+    fn();
+    return -1;
+#endif
+}
+
+template <typename SampleType>
+juce::AudioBuffer<SampleType> makeNoiseSource() {
+    juce::AudioBuffer<SampleType> source(kMaxChannels, kSourceLength);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<SampleType> dist(static_cast<SampleType>(-0.5),
+                                                static_cast<SampleType>(0.5));
+    for (int ch = 0; ch < kMaxChannels; ++ch)
+        for (int i = 0; i < kSourceLength; ++i) source.setSample(ch, i, dist(rng));
+    return source;
+}
+
+// Walks through the source so consecutive blocks see different data.
+int nextOffset(int offset, int blockSize) {
+    offset += blockSize;
+    return offset + blockSize > kSourceLength ? 0 : offset;
+}
+
+// Double-precision targets carry an "-f64" suffix, e.g. crossover-f64.
+template <typename SampleType>
+juce::String targetName(const juce::String& target) {
+    return std::is_same_v<SampleType, double> ? target + "-f64" : target;
+}
+
+// The default crossover is plain "crossover"; other band counts are tagged, e.g.
+// crossover-5band.
+template <typename SampleType, int NumBands>
+juce::String crossoverTargetName() {
+    if constexpr (NumBands == kNumBands) return targetName<SampleType>("crossover");
+    return targetName<SampleType>("crossover-" + juce::String(NumBands) + "band");
+}
+
+// Stereo cases keep the short name; other channel counts are tagged with ch=<n>.
+juce::String caseName(const juce::String& target, const juce::String& gainState,
+                      double sampleRate, int blockSize, int numChannels = kStereoChannels) {
+    auto name = target;
+    if (gainState.isNotEmpty()) name << "/" << gainState;
+    if (numChannels != kStereoChannels) name << "/ch=" << numChannels;
+    return name << "/sr=" << juce::roundToInt(sampleRate) << "/block=" << blockSize;
+}
+
+// Times processBlock() into band buffers for either crossover engine, which share that
+// interface.
+template <typename Engine, typename SampleType>
+Result benchmarkBandSplit(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                          const juce::String& target, double sampleRate, int blockSize,
+                          int numChannels) {
+    constexpr int numBands = static_cast<int>(std::tuple_size_v<typename Engine::Bands>);
+    juce::ScopedNoDenormals noDenormals;
+
+    Engine xover;
+    xover.prepare(sampleRate, numChannels);
+
+    juce::AudioBuffer<SampleType> bands(numBands * numChannels, blockSize);
+    typename Engine::Bands bandData{};
+    for (int band = 0; band < numBands; ++band)
+        bandData[static_cast<size_t>(band)] = bands.getArrayOfWritePointers() + band * numChannels;
+
+    const SampleType* input[kMaxChannels] = {};
+    int offset = 0;
+
+    const double ns = measureNsPerSample(settings, blockSize, [&] {
+        for (int ch = 0; ch < numChannels; ++ch) input[ch] = source.getReadPointer(ch, offset);
+        xover.processBlock(input, bandData, numChannels, blockSize);
+        offset = nextOffset(offset, blockSize);
+    });
+
+    return {caseName(target, {}, sampleRate, blockSize, numChannels), target, {}, sampleRate,
+            blockSize, numChannels, ns};
+}
+
+template <typename SampleType, int NumBands = kNumBands>
+Result benchmarkCrossover(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                          double sampleRate, int blockSize, int numChannels = kStereoChannels) {
+    return benchmarkBandSplit<Crossover<SampleType, NumBands>>(
+        settings, source, crossoverTargetName<SampleType, NumBands>(), sampleRate, blockSize,
+        numChannels);
+}
+
+using Execution = CrossoverExecution;
+constexpr Execution kExecutions[] = {Execution::channelParallel, Execution::timeParallel,
+                                     Execution::automatic};
+
+juce::String executionGainState(Execution execution) {
+    switch (execution) {
+        case Execution::channelParallel: return "execution=channel";
+        case Execution::timeParallel: return "execution=time";
+        case Execution::automatic: return "execution=auto";
+    }
+    return "execution=unknown";
+}
+
+// The default crossover with its execution mode fixed
+template <typename SampleType>
+Result benchmarkExecution(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                          int blockSize, int numChannels, Execution execution) {
+    juce::ScopedNoDenormals noDenormals;
+
+    Crossover<SampleType> xover;
+    xover.prepare(kChannelSweepSampleRate, numChannels);
+    xover.setExecution(execution);
+
+    juce::AudioBuffer<SampleType> bands(kNumBands * numChannels, blockSize);
+    SampleType* const* bandData = bands.getArrayOfWritePointers();
+    const SampleType* input[kMaxChannels] = {};
+    int offset = 0;
+
+    const double ns = measureNsPerSample(settings, blockSize, [&] {
+        for (int ch = 0; ch < numChannels; ++ch) input[ch] = source.getReadPointer(ch, offset);
+        xover.processBlock(input, {bandData, bandData + numChannels, bandData + 2 * numChannels},
+                           numChannels, blockSize);
+        offset = nextOffset(offset, blockSize);
+    });
+
+    const auto target = targetName<SampleType>("crossover");
+    const auto gainState = executionGainState(execution);
+    return {caseName(target, gainState, kChannelSweepSampleRate, blockSize, numChannels),
+            target, gainState, kChannelSweepSampleRate, blockSize, numChannels, ns};
+}
+
+// The FIR counterpart of the default crossover, in the same cases for comparison.
+template <typename SampleType>
+Result benchmarkLinearPhase(const Settings& settings,
+                            const juce::AudioBuffer<SampleType>& source, double sampleRate,
+                            int blockSize) {
+    return benchmarkBandSplit<LinearPhaseCrossover<SampleType>>(
+        settings, source, targetName<SampleType>("crossover-linear"), sampleRate, blockSize,
+        kStereoChannels);
+}
+
+// The gain-weighted band sum of one block: Crossover into band buffers, then the gains
+// applied and summed, or FusedCrossover in one pass. Steady, distinct band gains.
+template <typename SampleType>
+Result benchmarkGainSum(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                        int numChannels, bool fused) {
+    constexpr double sampleRate = kChannelSweepSampleRate;
+    constexpr int blockSize = kChannelSweepBlockSize;
+    const std::array<SampleType, kNumBands> bandGains = {SampleType(0.5), SampleType(1),
+                                                         SampleType(2)};
+    juce::ScopedNoDenormals noDenormals;
+
+    Crossover<SampleType> xover;
+    xover.prepare(sampleRate, numChannels);
+    FusedCrossover<SampleType> fusedXover;
+    fusedXover.prepare(sampleRate, numChannels);
+
+    juce::AudioBuffer<SampleType> bands(kNumBands * numChannels, blockSize);
+    juce::AudioBuffer<SampleType> output(numChannels, blockSize);
+    SampleType* const* bandData = bands.getArrayOfWritePointers();
+    std::vector<typename FusedCrossover<SampleType>::ChannelGains> gains(
+        static_cast<size_t>(numChannels));
+    for (auto& channelGains : gains) channelGains.current = bandGains;
+
+    const SampleType* input[kMaxChannels] = {};
+    int offset = 0;
+
+    const double ns = measureNsPerSample(settings, blockSize, [&] {
+        for (int ch = 0; ch < numChannels; ++ch) input[ch] = source.getReadPointer(ch, offset);
+        if (fused) {
+            fusedXover.processBlock(input, output.getArrayOfWritePointers(), gains.data(),
+                                    numChannels, blockSize);
+        } else {
+            xover.processBlock(input, {bandData, bandData + numChannels,
+                                       bandData + 2 * numChannels},
+                               numChannels, blockSize);
+            for (int ch = 0; ch < numChannels; ++ch) {
+                auto* out = output.getWritePointer(ch);
+                juce::FloatVectorOperations::copyWithMultiply(out, bandData[ch], bandGains[0],
+                                                              blockSize);
+                for (int band = 1; band < kNumBands; ++band)
+                    juce::FloatVectorOperations::addWithMultiply(
+                        out, bandData[band * numChannels + ch],
+                        bandGains[static_cast<size_t>(band)], blockSize);
+            }
+        }
+        offset = nextOffset(offset, blockSize);
+    });
+
+    const auto target = targetName<SampleType>(fused ? "crossover-fused" : "crossover-gains");
+    return {caseName(target, {}, sampleRate, blockSize, numChannels), target, {}, sampleRate,
+            blockSize, numChannels, ns};
+}
+
+void setParameter(juce::AudioProcessorValueTreeState& apvts, const char* id, float value) {
+    auto* param = apvts.getParameter(id);
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+}
+
+void applyGainState(juce::AudioProcessorValueTreeState& apvts, GainState state) {
+    switch (state) {
+        case GainState::unity:
+            break;
+        case GainState::kill:
+            setParameter(apvts, ParamID::kLow, -100.0f);
+            setParameter(apvts, ParamID::kMid, -100.0f);
+            setParameter(apvts, ParamID::kHigh, -100.0f);
+            break;
+        case GainState::boost:
+            setParameter(apvts, ParamID::kBoost, 2.0f);
+            setParameter(apvts, ParamID::kLow, 12.0f);
+            setParameter(apvts, ParamID::kMid, 6.0f);
+            setParameter(apvts, ParamID::kHigh, 12.0f);
+            break;
+        case GainState::automation:
+            setParameter(apvts, ParamID::kBoost, 1.0f);
+            break;
+        case GainState::drive:
+            // Full drive at unity gains: the oversampled stage on top of the summed path
+            setParameter(apvts, ParamID::kDrive, 100.0f);
+            break;
+        case GainState::sweep:
+            // An octave either way at 2 Hz at unity gains: per-sample split points
+            setParameter(apvts, ParamID::kSweepDepth, 1.0f);
+            setParameter(apvts, ParamID::kSweepRate, 2.0f);
+            break;
+    }
+}
+
+// Sweeps a deck's three bands between -40 dB and +6 dB with staggered phases, like a
+// DJ working the knobs. Parameter writes are part of the measured time.
+void applyAutomation(juce::AudioProcessorValueTreeState& apvts, float phase, size_t deck = 0) {
+    constexpr float kThirdTurn = 2.0f * std::numbers::pi_v<float> / 3.0f;
+    auto sweep = [](float p) { return juce::jmap(std::sin(p), -1.0f, 1.0f, -40.0f, 6.0f); };
+    const auto& ids = kDeckBandIds[deck];
+    setParameter(apvts, ids[0], sweep(phase));
+    setParameter(apvts, ids[1], sweep(phase + kThirdTurn));
+    setParameter(apvts, ids[2], sweep(phase + 2.0f * kThirdTurn));
+}
+
+// Metered cases run with the editor's band metering and spectrum capture on, as while the
+// editor is open.
+template <typename SampleType>
+juce::String processorTargetName(bool metered) {
+    return targetName<SampleType>(metered ? "processor-metered" : "processor");
+}
+
+template <typename SampleType>
+Result benchmarkProcessor(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                          double sampleRate, int blockSize, GainState state, bool metered) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    if constexpr (std::is_same_v<SampleType, double>)
+        processor->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    processor->prepareToPlay(sampleRate, blockSize);
+    processor->setMeteringEnabled(metered);
+    processor->setAnalyzerEnabled(metered);
+
+    auto& apvts = processor->getAPVTS();
+    applyGainState(apvts, state);
+
+    // The processor works in place, so each block is refilled from the source to
+    // keep boosted signals from growing without bound.
+    juce::AudioBuffer<SampleType> work(kStereoChannels, blockSize);
+    juce::MidiBuffer midi;
+    int offset = 0;
+
+    const float phaseIncrement = 2.0f * std::numbers::pi_v<float> * kAutomationRateHz
+        * static_cast<float>(blockSize) / static_cast<float>(sampleRate);
+    float phase = 0.0f;
+
+    const double ns = measureNsPerSample(settings, blockSize, [&] {
+        for (int ch = 0; ch < kStereoChannels; ++ch)
+            juce::FloatVectorOperations::copy(work.getWritePointer(ch),
+                                              source.getReadPointer(ch, offset), blockSize);
+
+        if (state == GainState::automation) {
+            applyAutomation(apvts, phase);
+            phase = std::fmod(phase + phaseIncrement, 2.0f * std::numbers::pi_v<float>);
+        }
+
+        processor->processBlock(work, midi);
+        offset = nextOffset(offset, blockSize);
+
+        // Drained like the editor and its analyzer do, so neither fills up
+        BandLevels levels;
+        while (processor->popBandLevels(levels)) {}
+        auto& spectrum = processor->getSpectrumRing();
+        spectrum.discard(spectrum.getNumReady());
+    });
+
+    const auto target = processorTargetName<SampleType>(metered);
+    return {caseName(target, gainStateName(state), sampleRate, blockSize), target,
+            gainStateName(state), sampleRate, blockSize, kStereoChannels, ns};
+}
+
+juce::String decksTargetName(bool separate) {
+    return separate ? "processor-instances" : "processor-decks";
+}
+
+// numDecks stereo decks with their knobs moving, run either by one multi-deck processor
+// or by a single-deck processor per deck, as a mixer does without the multi-deck build.
+// ns per sample frame of all decks together.
+template <typename SampleType>
+Result benchmarkDecks(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                      int numDecks, bool separate) {
+    constexpr double sampleRate = kChannelSweepSampleRate;
+    constexpr int blockSize = kChannelSweepBlockSize;
+    const int numChannels = numDecks * kStereoChannels;
+
+    std::vector<std::unique_ptr<AudioPluginAudioProcessor>> processors;
+    for (int index = 0; index < (separate ? numDecks : 1); ++index) {
+        auto processor = std::make_unique<AudioPluginAudioProcessor>(separate ? 1 : numDecks);
+        if constexpr (std::is_same_v<SampleType, double>)
+            processor->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+        processor->prepareToPlay(sampleRate, blockSize);
+        applyGainState(processor->getAPVTS(), GainState::automation);
+        processors.push_back(std::move(processor));
+    }
+
+    juce::AudioBuffer<SampleType> work(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    int offset = 0;
+
+    const float phaseIncrement = 2.0f * std::numbers::pi_v<float> * kAutomationRateHz
+        * static_cast<float>(blockSize) / static_cast<float>(sampleRate);
+    float phase = 0.0f;
+
+    const double ns = measureNsPerSample(settings, blockSize, [&] {
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::copy(work.getWritePointer(ch),
+                                              source.getReadPointer(ch, offset), blockSize);
+
+        // Each deck's knobs a radian apart
+        for (int deck = 0; deck < numDecks; ++deck) {
+            auto& processor = *processors[static_cast<size_t>(separate ? deck : 0)];
+            applyAutomation(processor.getAPVTS(), phase + static_cast<float>(deck),
+                            separate ? 0 : static_cast<size_t>(deck));
+        }
+        phase = std::fmod(phase + phaseIncrement, 2.0f * std::numbers::pi_v<float>);
+
+        if (separate) {
+            for (int deck = 0; deck < numDecks; ++deck) {
+                juce::AudioBuffer<SampleType> pair(work.getArrayOfWritePointers()
+                                                       + deck * kStereoChannels,
+                                                   kStereoChannels, blockSize);
+                processors[static_cast<size_t>(deck)]->processBlock(pair, midi);
+            }
+        } else {
+            processors.front()->processBlock(work, midi);
+        }
+        offset = nextOffset(offset, blockSize);
+    });
+
+    const auto target = targetName<SampleType>(decksTargetName(separate));
+    const juce::String gainState = gainStateName(GainState::automation);
+    return {caseName(target, gainState, sampleRate, blockSize, numChannels), target, gainState,
+            sampleRate, blockSize, numChannels, ns};
+}
+
+juce::String workersGainState(int numWorkers) {
+    return juce::String(gainStateName(GainState::automation)) + "/workers="
+        + juce::String(numWorkers);
+}
+
+// A processor on a discrete layout of numChannels with its knobs moving, sharing each
+// block out to numWorkers worker threads (0 for the audio thread alone). Nothing if the
+// workers could not have real-time scheduling, which leaves them off.
+template <typename SampleType>
+std::optional<Result> benchmarkWorkers(const Settings& settings,
+                                       const juce::AudioBuffer<SampleType>& source,
+                                       int numChannels, int blockSize, int numWorkers) {
+    constexpr double sampleRate = kChannelSweepSampleRate;
+
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+    processor->setBusesLayout(layout);
+    if constexpr (std::is_same_v<SampleType, double>)
+        processor->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    processor->prepareToPlay(sampleRate, blockSize);
+    processor->setNumWorkerThreads(numWorkers);
+    if (processor->getNumRunningWorkerThreads() != numWorkers) return std::nullopt;
+
+    auto& apvts = processor->getAPVTS();
+    applyGainState(apvts, GainState::automation);
+
+    juce::AudioBuffer<SampleType> work(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    int offset = 0;
+
+    const float phaseIncrement = 2.0f * std::numbers::pi_v<float> * kAutomationRateHz
+        * static_cast<float>(blockSize) / static_cast<float>(sampleRate);
+    float phase = 0.0f;
+
+    const double ns = measureNsPerSample(settings, blockSize, [&] {
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::copy(work.getWritePointer(ch),
+                                              source.getReadPointer(ch, offset), blockSize);
+
+        applyAutomation(apvts, phase);
+        phase = std::fmod(phase + phaseIncrement, 2.0f * std::numbers::pi_v<float>);
+
+        processor->processBlock(work, midi);
+        offset = nextOffset(offset, blockSize);
+    });
+
+    const auto target = targetName<SampleType>("processor-workers");
+    const auto gainState = workersGainState(numWorkers);
+    return Result{caseName(target, gainState, sampleRate, blockSize, numChannels), target,
+                  gainState, sampleRate, blockSize, numChannels, ns, "ns/sample", -1.0,
+                  numWorkers};
+}
+
+// The XML state saved before the binary format, built the way it was then
+juce::MemoryBlock saveXmlState(AudioPluginAudioProcessor& processor) {
+    std::unique_ptr<juce::XmlElement> xml(processor.getAPVTS().copyState().createXml());
+    processor.getMidiCcMap().saveTo(*xml);
+
+    juce::MemoryBlock state;
+    juce::AudioProcessor::copyXmlToBinary(*xml, state);
+    return state;
+}
+
+juce::String stateTargetName(bool restore) { return restore ? "state-restore" : "state-save"; }
+
+// e.g. state-restore/xml
+juce::String stateCaseName(bool restore, bool xml) {
+    return stateTargetName(restore) + (xml ? "/xml" : "/binary");
+}
+
+// Times saving or restoring one instance's state in the binary format or the XML one
+// earlier versions saved. Restores alternate between two states, the defaults and the
+// boost settings (both with a MIDI assignment), so every restore changes the parameters,
+// as when a session loads into fresh instances.
+Result benchmarkState(const Settings& settings, bool restore, bool xml) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->getMidiCcMap().assign(MidiCcMap::targetFor(ParamID::kLow), {1, 16, true});
+
+    std::array<juce::MemoryBlock, 2> states;
+    for (size_t index = 0; index < states.size(); ++index) {
+        if (index > 0) applyGainState(processor->getAPVTS(), GainState::boost);
+        if (xml)
+            states[index] = saveXmlState(*processor);
+        else
+            processor->getStateInformation(states[index]);
+    }
+
+    size_t next = 0;
+    auto call = [&] {
+        if (restore) {
+            const auto& state = states[next];
+            processor->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+            next = (next + 1) % states.size();
+        } else if (xml) {
+            saveXmlState(*processor);
+        } else {
+            juce::MemoryBlock state;
+            processor->getStateInformation(state);
+        }
+    };
+
+    const double ns = measureNsPerCall(settings, settings.stateCallsPerRun, call);
+    const auto allocations = countAllocations([&] {
+        for (size_t index = 0; index < states.size(); ++index) call();
+    });
+
+    const double allocationsPerCall = allocations < 0 ? -1.0
+        : static_cast<double>(allocations) / static_cast<double>(states.size());
+    return {stateCaseName(restore, xml), stateTargetName(restore), {}, 0.0, 0, 0, ns,
+            restore ? "ns/restore" : "ns/save", allocationsPerCall};
+}
+
+template <typename SampleType, int NumBands, typename Wanted, typename Report>
+void runBandCount(const Settings& settings, const juce::AudioBuffer<SampleType>& source,
+                  Wanted& wanted, Report& report) {
+    const auto target = crossoverTargetName<SampleType, NumBands>();
+    if (wanted(caseName(target, {}, kChannelSweepSampleRate, kChannelSweepBlockSize)))
+        report(benchmarkCrossover<SampleType, NumBands>(settings, source, kChannelSweepSampleRate,
+                                                        kChannelSweepBlockSize));
+}
+
+template <typename SampleType, typename Wanted, typename Report>
+void runPrecision(const Settings& settings, Wanted& wanted, Report& report) {
+    const auto source = makeNoiseSource<SampleType>();
+    const auto crossover = targetName<SampleType>("crossover");
+    const auto linearPhase = targetName<SampleType>("crossover-linear");
+
+    for (double sampleRate : kSampleRates) {
+        for (int blockSize : kBlockSizes) {
+            if (wanted(caseName(crossover, {}, sampleRate, blockSize)))
+                report(benchmarkCrossover(settings, source, sampleRate, blockSize));
+            if (wanted(caseName(linearPhase, {}, sampleRate, blockSize)))
+                report(benchmarkLinearPhase(settings, source, sampleRate, blockSize));
+
+            for (GainState state : kGainStates) {
+                for (bool metered : {false, true}) {
+                    const auto processor = processorTargetName<SampleType>(metered);
+                    if (wanted(caseName(processor, gainStateName(state), sampleRate, blockSize)))
+                        report(benchmarkProcessor(settings, source, sampleRate, blockSize, state,
+                                                  metered));
+                }
+            }
+        }
+    }
+
+    for (int numChannels : kChannelCounts) {
+        if (numChannels == kStereoChannels) continue;  // covered above
+        if (wanted(caseName(crossover, {}, kChannelSweepSampleRate, kChannelSweepBlockSize,
+                            numChannels)))
+            report(benchmarkCrossover(settings, source, kChannelSweepSampleRate,
+                                      kChannelSweepBlockSize, numChannels));
+    }
+
+    for (int numChannels : kExecutionChannelCounts) {
+        for (int blockSize : kExecutionBlockSizes) {
+            for (Execution execution : kExecutions) {
+                if (wanted(caseName(crossover, executionGainState(execution),
+                                    kChannelSweepSampleRate, blockSize, numChannels)))
+                    report(benchmarkExecution(settings, source, blockSize, numChannels,
+                                              execution));
+            }
+        }
+    }
+
+    for (int numChannels : kChannelCounts) {
+        for (bool fused : {false, true}) {
+            const auto target =
+                targetName<SampleType>(fused ? "crossover-fused" : "crossover-gains");
+            if (wanted(caseName(target, {}, kChannelSweepSampleRate, kChannelSweepBlockSize,
+                                numChannels)))
+                report(benchmarkGainSum(settings, source, numChannels, fused));
+        }
+    }
+
+    for (int numDecks : kDeckCounts) {
+        for (bool separate : {false, true}) {
+            const auto target = targetName<SampleType>(decksTargetName(separate));
+            if (wanted(caseName(target, gainStateName(GainState::automation),
+                                kChannelSweepSampleRate, kChannelSweepBlockSize,
+                                numDecks * kStereoChannels)))
+                report(benchmarkDecks(settings, source, numDecks, separate));
+        }
+    }
+
+    // Speed-up over the audio thread alone is printed after each worker sweep
+    const int maxWorkers = AudioPluginAudioProcessor::getMaxWorkerThreads();
+    const auto workers = targetName<SampleType>("processor-workers");
+    for (int numChannels : kWorkerChannelCounts) {
+        for (int blockSize : kWorkerBlockSizes) {
+            double inlineNs = 0.0;
+            juce::String scaling;
+            for (int numWorkers = 0; numWorkers <= maxWorkers; ++numWorkers) {
+                if (!wanted(caseName(workers, workersGainState(numWorkers),
+                                     kChannelSweepSampleRate, blockSize, numChannels)))
+                    continue;
+
+                auto result = benchmarkWorkers(settings, source, numChannels, blockSize,
+                                               numWorkers);
+                if (!result) {
+                    std::printf("  workers skipped: no real-time scheduling\n");
+                    break;
+                }
+                if (numWorkers == 0)
+                    inlineNs = result->nsPerSample;
+                else if (inlineNs > 0.0)
+                    scaling << " " << numWorkers << ": "
+                            << juce::String(inlineNs / result->nsPerSample, 2) << "x";
+                report(std::move(*result));
+            }
+            if (scaling.isNotEmpty())
+                std::printf("  speed-up by workers, ch=%d/block=%d:%s\n", numChannels,
+                            blockSize, scaling.toRawUTF8());
+        }
+    }
+
+    // 3 bands are covered above
+    runBandCount<SampleType, 2>(settings, source, wanted, report);
+    runBandCount<SampleType, 4>(settings, source, wanted, report);
+    runBandCount<SampleType, 5>(settings, source, wanted, report);
+    runBandCount<SampleType, 6>(settings, source, wanted, report);
+}
+
+std::vector<Result> runBenchmarks(const Settings& settings) {
+    std::vector<Result> results;
+
+    auto wanted = [&settings](const juce::String& name) {
+        return settings.filter.isEmpty() || name.contains(settings.filter);
+    };
+    auto report = [&results](Result result) {
+        std::printf("%-48s %10.3f %s", result.name.toRawUTF8(), result.nsPerSample,
+                    result.unit);
+        if (result.allocations >= 0.0) std::printf(", %.1f allocations", result.allocations);
+        std::printf("\n");
+        std::fflush(stdout);
+        results.push_back(std::move(result));
+    };
+
+    runPrecision<float>(settings, wanted, report);
+    runPrecision<double>(settings, wanted, report);
+
+    for (const bool restore : {true, false}) {
+        for (const bool xml : {false, true}) {
+            if (wanted(stateCaseName(restore, xml)))
+                report(benchmarkState(settings, restore, xml));
+        }
+    }
+
+    return results;
+}
+
+juce::var resultsToJson(const std::vector<Result>& results) {
+    juce::Array<juce::var> entries;
+    for (const auto& result : results) {
+        juce::DynamicObject::Ptr entry = new juce::DynamicObject();
+        entry->setProperty("name", result.name);
+        entry->setProperty("target", result.target);
+        entry->setProperty("gainState", result.gainState);
+        entry->setProperty("sampleRate", result.sampleRate);
+        entry->setProperty("blockSize", result.blockSize);
+        entry->setProperty("channels", result.numChannels);
+        entry->setProperty("nsPerSample", result.nsPerSample);
+        entry->setProperty("unit", juce::String(result.unit));
+        if (result.allocations >= 0.0) entry->setProperty("allocations", result.allocations);
+        if (result.numWorkers >= 0) entry->setProperty("workers", result.numWorkers);
+        entries.add(juce::var(entry.get()));
+    }
+
+    juce::DynamicObject::Ptr root = new juce::DynamicObject();
+    root->setProperty("unit", "ns/sample");
+    root->setProperty("results", entries);
+    return juce::var(root.get());
+}
+
+bool writeJson(const std::vector<Result>& results, const juce::File& file) {
+    if (!file.replaceWithText(juce::JSON::toString(resultsToJson(results)))) {
+        std::fprintf(stderr, "Could not write %s\n", file.getFullPathName().toRawUTF8());
+        return false;
+    }
+    std::printf("Wrote %s\n", file.getFullPathName().toRawUTF8());
+    return true;
+}
+
+// Returns the number of cases slower than their baseline by more than tolerance. A
+// missing baseline counts as one unless the check is optional.
+int countRegressions(const std::vector<Result>& results, const juce::File& baselineFile,
+                     double tolerance, bool baselineRequired) {
+    if (!baselineFile.existsAsFile()) {
+        if (!baselineRequired) {
+            std::printf("No baseline at %s, skipping regression check\n",
+                        baselineFile.getFullPathName().toRawUTF8());
+            return 0;
+        }
+        std::fprintf(stderr, "No baseline at %s; record one with --write-baseline\n",
+                     baselineFile.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    const auto baseline = juce::JSON::parse(baselineFile);
+    const auto* entries = baseline["results"].getArray();
+    if (entries == nullptr) {
+        std::fprintf(stderr, "Baseline %s has no results array\n",
+                     baselineFile.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    std::map<juce::String, double> baselineNs;
+    for (const auto& entry : *entries)
+        baselineNs[entry["name"].toString()] = static_cast<double>(entry["nsPerSample"]);
+
+    int regressions = 0;
+    for (const auto& result : results) {
+        const auto it = baselineNs.find(result.name);
+        if (it == baselineNs.end() || it->second <= 0.0) continue;
+
+        const double ratio = result.nsPerSample / it->second;
+        if (ratio > 1.0 + tolerance) {
+            std::printf("REGRESSION %-37s %10.3f %s (baseline %.3f, %+.1f%%)\n",
+                        result.name.toRawUTF8(), result.nsPerSample, result.unit, it->second,
+                        (ratio - 1.0) * 100.0);
+            ++regressions;
+        }
+    }
+
+    std::printf("%d regression(s) against %s (tolerance %.0f%%)\n", regressions,
+                baselineFile.getFullPathName().toRawUTF8(), tolerance * 100.0);
+    return regressions;
+}
+
+juce::File resolvePath(const juce::String& path) {
+    return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h")) {
+        std::printf("AudioPluginBenchmark [--quick] [--filter=<substring>] [--output=<file>]\n"
+                    "                     [--baseline=<file>] [--tolerance=<fraction>]\n"
+                    "                     [--write-baseline]\n");
+        return 0;
+    }
+
+    Settings settings;
+    if (args.containsOption("--quick")) {
+        settings.framesPerRun = kQuickFramesPerRun;
+        settings.stateCallsPerRun = kQuickStateCallsPerRun;
+        settings.repetitions = kQuickRepetitions;
+    }
+    settings.filter = args.getValueForOption("--filter");
+
+    const auto outputPath = args.getValueForOption("--output");
+    const auto outputFile = resolvePath(outputPath.isNotEmpty() ? outputPath
+                                                                : "benchmark_results.json");
+    const auto baselinePath = args.getValueForOption("--baseline");
+    const auto baselineFile = resolvePath(baselinePath.isNotEmpty() ? baselinePath
+                                                                    : ISO3D_BENCHMARK_BASELINE);
+    const auto toleranceArg = args.getValueForOption("--tolerance");
+    const double tolerance = toleranceArg.isNotEmpty() ? toleranceArg.getDoubleValue()
+                                                       : kDefaultTolerance;
+
+    const auto results = runBenchmarks(settings);
+
+    if (!writeJson(results, outputFile)) return 1;
+
+    if (args.containsOption("--write-baseline")) return writeJson(results, baselineFile) ? 0 : 1;
+
+    // A quick run is a check, which passes nothing without a baseline
+    const bool baselineRequired = args.containsOption("--quick");
+    return countRegressions(results, baselineFile, tolerance, baselineRequired) > 0 ? 1 : 0;
+}
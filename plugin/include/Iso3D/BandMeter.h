@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+
+#include "Constants.h"
+
+namespace audio_plugin {
+
+// Levels of each band over one metering window, lowest band first. peak and rms
+// measure the band signal before its gain, across all channels; gain is the gain
+// applied at the end of the window. The editor shows both what a band carries and
+// what gets through, so a killed band still shows what it removes.
+struct BandLevels {
+    std::array<float, kNumBands> peak{};
+    std::array<float, kNumBands> rms{};
+    std::array<float, kNumBands> gain{};
+};
+
+// Gathers per-band peak and RMS over windows of kMeterWindowSec. The processor feeds it
+// the band buffers of each chunk right after the crossover has filled them, and queues
+// every finished window for the editor. Instantiated for float and double.
+template <typename SampleType>
+class BandMeter {
+public:
+    // Per band: one pointer per channel, as filled by Crossover::processBlock()
+    using Bands = std::array<SampleType* const*, kNumBands>;
+    using Gains = std::array<SampleType, kNumBands>;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Adds numSamples of the first numChannels channels of every band, with the gains
+    // reached at their end. Returns true if this completes a window, whose levels
+    // getLevels() then holds until the next call.
+    bool addBlock(const Bands& bands, int numChannels, int numSamples, const Gains& gains);
+
+    const BandLevels& getLevels() const { return levels_; }
+
+private:
+    int windowLength_ = 1;
+    int windowFill_ = 0;  // samples gathered into the current window
+    std::array<SampleType, kNumBands> peak_{};
+    std::array<SampleType, kNumBands> sumOfSquares_{};
+    BandLevels levels_;
+};
+
+}  // namespace audio_plugin
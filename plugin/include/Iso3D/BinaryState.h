@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include <juce_core/juce_core.h>
+
+namespace audio_plugin {
+
+// Chunk tag from four characters, e.g. chunkTag("PARM")
+constexpr uint32_t chunkTag(const char (&name)[5]) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(name[0]))
+        | static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 8
+        | static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 16
+        | static_cast<uint32_t>(static_cast<uint8_t>(name[3])) << 24;
+}
+
+// Iso3D's plugin state: a header followed by tagged chunks, written straight into the
+// host's memory block and read straight out of it, without a ValueTree or XML document
+// in between.
+//
+//   header: uint32 kMagic, uint32 version
+//   chunk:  uint32 tag, uint32 payload size in bytes, payload
+//
+// Everything is little-endian. Readers skip chunks they don't know, so adding a chunk
+// keeps older builds able to read the state; kVersion only goes up when the layout of an
+// existing chunk changes, and states from a newer version are not read at all.
+// Parameters are keyed by ID rather than position, written with writeId().
+struct BinaryState {
+    static constexpr uint32_t kMagic = chunkTag("I3DS");
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 8;
+    static constexpr size_t kChunkHeaderSize = 8;
+
+    // IDs are written as a length byte followed by that many bytes, without terminator
+    static constexpr size_t kMaxIdLength = 255;
+    using IdBuffer = std::array<char, kMaxIdLength>;
+
+    static void writeId(juce::OutputStream& stream, std::string_view id);
+
+    // Reads an ID written by writeId() into buffer; nullopt if the stream ends first
+    static std::optional<std::string_view> readId(juce::InputStream& stream, IdBuffer& buffer);
+};
+
+// Writes a binary state into a memory block, replacing its contents.
+class BinaryStateWriter {
+public:
+    explicit BinaryStateWriter(juce::MemoryBlock& destination);
+
+    // Writes one chunk, whose payload writePayload(juce::OutputStream&) writes
+    template <typename WritePayload>
+    void writeChunk(uint32_t tag, WritePayload&& writePayload) {
+        stream_.writeInt(static_cast<int>(tag));
+        const auto sizePosition = stream_.getPosition();
+        stream_.writeInt(0);  // filled in once the payload is written
+
+        writePayload(static_cast<juce::OutputStream&>(stream_));
+
+        const auto end = stream_.getPosition();
+        stream_.setPosition(sizePosition);
+        stream_.writeInt(static_cast<int>(end - sizePosition - 4));
+        stream_.setPosition(end);
+    }
+
+private:
+    // Room for a typical state, so it is written without growing the block
+    static constexpr size_t kInitialSize = 512;
+
+    juce::MemoryOutputStream stream_;
+};
+
+// Walks the chunks of a binary state held in memory, which must outlive the reader.
+class BinaryStateReader {
+public:
+    // True if data starts with the header of a version this build reads
+    static bool canRead(const void* data, size_t size);
+
+    // data must pass canRead()
+    BinaryStateReader(const void* data, size_t size);
+
+    // Moves to the next chunk; false once there are none left, or the rest is truncated
+    bool nextChunk();
+
+    uint32_t getTag() const { return tag_; }
+
+    // The current chunk's payload, on its own so a reader can't run past its end
+    juce::MemoryInputStream& getPayload() { return *payload_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_ = BinaryState::kHeaderSize;
+    uint32_t tag_ = 0;
+    std::optional<juce::MemoryInputStream> payload_;
+};
+
+}  // namespace audio_plugin
@@ -1,26 +1,89 @@
 #pragma once
 
+#include <array>
+
 namespace audio_plugin {
 
-constexpr int kNumChannels = 2;
+constexpr int kMaxChannels = 64;  // widest supported bus layout
 constexpr int kNumBands = 3;
+constexpr int kMaxBands = 6;  // widest Crossover<SampleType, NumBands> instantiated
+constexpr int kMaxDecks = 4;  // stereo bus pairs with their own band gains, multi-deck builds
 
-// Crossover frequencies (TEIL3-style)
+// Crossover frequencies (TEIL3-style defaults, automatable per venue)
 constexpr float kLowMidCrossoverHz = 250.0f;
 constexpr float kMidHighCrossoverHz = 3140.0f;  // pi kHz
+constexpr float kLowMidCrossoverMinHz = 80.0f;
+constexpr float kLowMidCrossoverMaxHz = 800.0f;
+constexpr float kMidHighCrossoverMinHz = 1000.0f;
+constexpr float kMidHighCrossoverMaxHz = 8000.0f;
+constexpr float kCrossoverGlideTimeSec = 0.01f;  // coefficient interpolation per change
+constexpr int kMinTimeParallelSamples = 256;  // shortest block Crossover vectorizes along time
+
+// Split point sweep: an LFO moves both split points by up to the depth in octaves, within
+// their parameter ranges
+constexpr float kMaxSweepOctaves = 2.0f;
+constexpr float kMinSweepRateHz = 0.05f;
+constexpr float kMaxSweepRateHz = 10.0f;
+constexpr float kDefaultSweepRateHz = 1.0f;
+
+// Linear-phase mode: windowed-sinc FIRs run by uniformly partitioned FFT convolution
+constexpr float kLinearPhasePartitionTimeSec = 0.005f;  // rounded up to a power of 2 samples
+constexpr int kLinearPhaseNumPartitions = 16;  // FIR length = partitions * partition size - 1
+constexpr float kModeCrossfadeTimeSec = 0.02f;  // IIR <-> linear-phase switch
 
 // Gain smoothing: alpha = 1 - exp(-1 / (tau * sr)), computed at prepare()
 constexpr float kGainSmoothTimeSec = 0.005f;  // 5ms time constant
+constexpr float kGainSmoothEpsilon = 1.0e-6f;  // snap to target once this close (linear)
 constexpr float kKillThresholdDb = -100.0f;
+constexpr float kMaxBandGainDb = 12.0f;  // top of the band gain parameters' range
 constexpr float kUnityDeadZoneDb = 0.5f;  // snap to 0 dB within +/-0.5 dB
 constexpr float kBoostLevels[] = {0.0f, 6.0f, 12.0f};
 
+// Idle bypass: input and filter memory below this (-120 dBFS, well clear of denormals)
+// count as silence, and the reported tail lasts until the filters ring down to it
+constexpr float kSilenceThreshold = 1.0e-6f;
+
+// Drive: tanh(k x) / k at twice the sample rate, k up to kMaxDrive at full drive (peaks
+// of a full-scale signal come out 12 dB down). Engaging, disengaging and moving it ramp
+// over kDriveFadeTimeSec.
+constexpr float kMaxDrive = 4.0f;
+constexpr float kDriveFadeTimeSec = 0.01f;
+
+// Worker pool: the most worker threads an instance runs, and the shortest chunk handed
+// out to them, below which the handoff costs more than it saves
+constexpr int kMaxWorkerThreads = 8;
+constexpr int kMinParallelSamples = 64;
+
+// Metering: per-band levels gathered over windows of this length, queued for the editor
+constexpr float kMeterWindowSec = 0.01f;
+
 // Parameter IDs
 namespace ParamID {
 inline constexpr const char* kLow = "low";
 inline constexpr const char* kMid = "mid";
 inline constexpr const char* kHigh = "high";
 inline constexpr const char* kBoost = "boost";
+inline constexpr const char* kLowMidFreq = "lowMidFreq";
+inline constexpr const char* kMidHighFreq = "midHighFreq";
+inline constexpr const char* kLinearPhase = "linearPhase";
+inline constexpr const char* kDrive = "drive";
+inline constexpr const char* kSweepDepth = "sweepDepth";
+inline constexpr const char* kSweepRate = "sweepRate";
 }  // namespace ParamID
 
+// Band gains of each deck, low/mid/high. Deck 1 has the single-deck IDs; decks 2 and up
+// only exist in multi-deck builds.
+inline constexpr std::array<std::array<const char*, kNumBands>, kMaxDecks> kDeckBandIds = {{
+    {ParamID::kLow, ParamID::kMid, ParamID::kHigh},
+    {"low2", "mid2", "high2"},
+    {"low3", "mid3", "high3"},
+    {"low4", "mid4", "high4"},
+}};
+
+// Every parameter of a single-deck build, in the order the layout creates them
+inline constexpr std::array<const char*, 10> kParameterIds = {
+    ParamID::kLow,        ParamID::kMid,         ParamID::kHigh,        ParamID::kBoost,
+    ParamID::kLowMidFreq, ParamID::kMidHighFreq, ParamID::kLinearPhase, ParamID::kDrive,
+    ParamID::kSweepDepth, ParamID::kSweepRate};
+
 }  // namespace audio_plugin
@@ -1,39 +1,423 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
 #include <juce_dsp/juce_dsp.h>
 
 #include "Constants.h"
+#include "CrossoverNetwork.h"
 
 namespace audio_plugin {
 
-struct BandSamples {
-    float low;
-    float mid;
-    float high;
+// LR4 coefficients for every split point at one sample rate. Building them costs a
+// tan() per split, so they are made off the audio thread and handed to glideTo().
+template <int NumBands = kNumBands>
+struct CrossoverCoefficients {
+    static constexpr size_t kNumSplits = static_cast<size_t>(NumBands - 1);
+    using Frequencies = std::array<float, kNumSplits>;
+
+    struct Split {
+        double g = 0.0;  // tan(pi * fc / fs)
+        double k = 0.0;  // R2 + g
+        double h = 0.0;  // 1 / (1 + R2 g + g^2)
+    };
+
+    std::array<Split, kNumSplits> splits{};
+
+    // kLowMidCrossoverHz and kMidHighCrossoverHz, with any further split points spread
+    // evenly in log frequency between them. Two bands split at kLowMidCrossoverHz.
+    static Frequencies defaultFrequencies();
+
+    static CrossoverCoefficients make(double sampleRate, const Frequencies& frequenciesHz);
 };
 
-// LR4 (Linkwitz-Riley 4th order, 24 dB/oct) 3-band crossover.
+// tan(pi * fc / fs) at one sample rate on a grid of kStepsPerOctave points per octave from
+// kMinHz, so split points can move every sample without a tan() each. Positions on the
+// grid come from positionOf(); between grid points g is interpolated linearly, which is
+// within 1e-4 of tan() (relative) below fs / 4 and 1e-2 up to 0.49 fs.
+struct CrossoverCoefficientTable {
+    static constexpr double kMinHz = 20.0;
+    static constexpr int kNumOctaves = 10;
+    static constexpr int kStepsPerOctave = 64;
+    static constexpr size_t kSize = static_cast<size_t>(kNumOctaves * kStepsPerOctave) + 1;
+
+    std::array<double, kSize> g{};
+
+    // As CrossoverCoefficients::make() does, keeps fc below 0.49 fs
+    static CrossoverCoefficientTable make(double sampleRate);
+
+    // Grid position of a frequency, clamped to the grid
+    static float positionOf(float hz);
+
+    double gAt(float position) const {
+        const auto index = std::min(static_cast<size_t>(std::max(position, 0.0f)), kSize - 2);
+        const double fraction = static_cast<double>(position) - static_cast<double>(index);
+        return g[index] + fraction * (g[index + 1] - g[index]);
+    }
+};
+
+// How Crossover vectorizes a block: across channels, or along time, one channel at a
+// time. automatic picks per block and channel group.
+enum class CrossoverExecution { automatic, channelParallel, timeParallel };
+
+// One sample of every band, lowest first. Three bands destructure as [low, mid, high].
+template <typename SampleType, int NumBands = kNumBands>
+using BandSamples = std::array<SampleType, static_cast<size_t>(NumBands)>;
+
+// LR4 (Linkwitz-Riley 4th order, 24 dB/oct) N-band crossover, 3 bands by default.
 //
-// Uses JUCE's LinkwitzRileyFilter (TPT structure) which guarantees:
+// Implements the same TPT structure as JUCE's LinkwitzRileyFilter, which guarantees:
 //   LP(f) + HP(f) = allpass with unit magnitude
 //
-// Topology:
-//   Input -> LR4(lowMid) -> LP -> Low band
+// Topology (3 bands; CrossoverNetwork describes the general N-band tree):
+//   Input -> LR4(lowMid) -> LP -> AP(midHigh) -> Low band
 //                        -> HP -> LR4(midHigh) -> LP -> Mid band
 //                                               -> HP -> High band
 //
-// Perfect reconstruction: Low + Mid + High = Input
+// AP(midHigh) is the midHigh LR4's LP + HP, which keeps the low band in phase with the
+// other two. Perfect reconstruction: Low + Mid + High = AP(lowMid) AP(midHigh) Input,
+// flat in magnitude wherever the split points sit.
+//
+// The tree is fixed at compile time, so the per-sample loops are unrolled over its
+// nodes with no branches on band count or node type.
+//
+// State lives in banks of SIMD registers, one LR4 section (or allpass) per lane. Two
+// layouts:
+//
+//   Pipelined (every split of every channel in one register, every allpass in a
+//   second: up to 4 channels of 2 bands, or 2 of 3 bands): one bank holds the splits
+//     lane 0: lowMid L     lane 2: midHigh L
+//     lane 1: lowMid R     lane 3: midHigh R
+//   and the lagged midHigh lanes are fed with the previous sample's lowMid HP, so both
+//   splits of a frame cost a single vector step. A second bank holds AP(midHigh) in the
+//   lanes of each channel's lowMid, and steps on that sample's lowMid LP right after.
+//
+//   Grouped (everything else, up to kMaxChannels): channels are packed one per lane,
+//   with one bank per network node per group, so cost grows per vector width rather
+//   than per channel.
+//
+// Both vectorize across channels, which leaves lanes idle when there are few of them. A
+// block can instead be vectorized along time, one channel at a time: each node steps
+// kNumLanes samples at once in block state-space form,
+//   out[n .. n + L)   = M z[n] + T x[n .. n + L)
+//   z[n + L]          = A^L z[n] + K x[n .. n + L)
+// with M, T, A^L and K derived from processSection() whenever the coefficients settle.
+// The state stays in the layout's lanes, so the two modes can alternate at any block
+// boundary. By default a group runs time-parallel on blocks of kMinTimeParallelSamples or
+// more if its channels would fill at most half a register: mono and stereo in float, mono
+// in double, whatever the band count or layout. That is where the benchmarks found it
+// faster (see the README); the channel-parallel kernels are bound by the latency of each
+// sample's chain of sections rather than by their vector operation count, so counting
+// operations picked the wrong side.
+// Glides always run channel-parallel, since the block form only holds for fixed
+// coefficients.
+//
+// Coefficients can change at runtime: glideTo() interpolates g linearly per sample over
+// kCrossoverGlideTimeSec and recomputes k and h from it, so every intermediate step is an
+// exact LR4 and sweeps stay click-free. TPT integrators tolerate time-varying g, which is
+// what makes per-sample modulation safe here. For split points that never settle, such as
+// an LFO sweep, modulate() instead sets them from a CrossoverCoefficientTable every sample
+// of a block: a table lookup and one reciprocal per split point, rather than a tan().
+//
+// The lane diagram above is for float (4 lanes). With double (2 lanes) only 2-band mono
+// and stereo and 3-band mono are pipelined, and 3-band stereo runs as one grouped set of
+// three banks.
+// Instantiated for float and double, 2 to kMaxBands bands.
+template <typename SampleType, int NumBands = kNumBands>
 class Crossover {
+    static_assert(NumBands >= 2 && NumBands <= kMaxBands,
+                  "Crossover.cpp instantiates 2 to kMaxBands bands");
+
 public:
-    void prepare(double sampleRate);
-    BandSamples processSample(int channel, float input);
+    using Coefficients = CrossoverCoefficients<NumBands>;
+
+    // Per band, lowest first: one pointer per channel
+    using Bands = std::array<SampleType* const*, static_cast<size_t>(NumBands)>;
+
+    // Starts at Coefficients::defaultFrequencies().
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    int getNumChannels() const { return numChannels_; }
+
+    // True if every filter state is below threshold in magnitude, so silent input would
+    // give (near) silent output.
+    bool isSilent(SampleType threshold) const;
+
+    // Time the filter state takes to fall below threshold once a full-scale input stops,
+    // for the given coefficients. The lowest split points ring longest.
+    static double decayTimeSeconds(double sampleRate, const Coefficients& coefficients,
+                                   SampleType threshold);
+
+    // Vectorization, see above. Takes effect from the next block.
+    using Execution = CrossoverExecution;
+    void setExecution(Execution execution) { execution_ = execution; }
+    Execution getExecution() const { return execution_; }
+
+    // Whether processGroup() would run the group's next block of numSamples along time
+    bool isTimeParallel(int group, int numChannels, int numSamples) const;
+
+    // One channel's integrator states, node by node in CrossoverNetwork order, s1 to s4
+    // (allpass nodes use s1 and s2). For handing the filter over to another engine that
+    // runs the same network, such as FusedCrossover. Not while the allpass sum runs.
+    using ChannelState = std::array<std::array<SampleType, 4>,
+                                    static_cast<size_t>(CrossoverNetwork<NumBands>::kNumNodes)>;
+    ChannelState getChannelState(int channel) const;
+    void setChannelState(int channel, const ChannelState& state);
+
+    // Jumps straight to the given coefficients, dropping any glide in progress.
+    void setCoefficients(const Coefficients& coefficients);
+
+    // Glides from the current coefficients to the given ones during the following
+    // block calls. processSample() uses the current coefficients without advancing.
+    void glideTo(const Coefficients& coefficients);
+    bool isGliding() const { return glideRemaining_ > 0; }
+
+    // Per split point, numSamples grid positions (CrossoverCoefficientTable::positionOf())
+    using Positions = std::array<const float*, Coefficients::kNumSplits>;
+
+    // Moves the split points every sample of the next block, sample n to positions[s][n],
+    // dropping any glide in progress. Lasts until endBlock(), which leaves the block's last
+    // coefficients in place; glideTo() carries on from those. table and positions must stay
+    // valid until then. processSample() uses the current coefficients without advancing.
+    void modulate(const CrossoverCoefficientTable& table, const Positions& positions);
+    bool isModulated() const { return modulationTable_ != nullptr; }
+
+    BandSamples<SampleType, NumBands> processSample(int channel, SampleType input);
+
+    // Splits numSamples of the first numChannels (<= getNumChannels()) input channels
+    // into band buffers. Input may alias none of the band buffers; all pointers must
+    // hold numSamples.
+    void processBlock(const SampleType* const* input, const Bands& bands, int numChannels,
+                      int numSamples);
+
+    // Unity-gain path: writes the band sum straight to output, skipping the band
+    // buffers. Advances exactly the same state as processBlock(), so callers can switch
+    // between the two at any block boundary without a transient. Output may alias input.
+    void processBlockSummed(const SampleType* const* input, SampleType* const* output,
+                            int numChannels, int numSamples);
+
+    // The band sum is AP(split 0) ... AP(split N-2) of the input, so with the split points
+    // settled (neither gliding nor modulated) the summed path can run just that: split 0's
+    // LR4 with LP + HP taken, then one 2nd-order allpass per higher split point and
+    // channel, 3 SVFs a channel for 3 bands where the full network takes 5. It keeps its
+    // state in the split nodes, which in the pipelined layout leaves a single register to
+    // step. Turning it on hands the state over exactly, so the sum carries on without a
+    // transient. Turning it off restores split 0 exactly and starts the nodes above it as
+    // if their inputs had held still, which keeps the handback error 65 dB or more below
+    // the signal, so gain changes that end unity still land on their sample.
+    // processBlock() and processGroup() need it off.
+    void setAllpassSum(bool enabled);
+    bool isAllpassSum() const { return allpassSum_; }
+
+    // Channel groups, which share no state and so can be processed independently, e.g. on
+    // different threads: one per SIMD register of channels in the grouped layout, or all
+    // channels as one group in the pipelined layout. Group g holds channels
+    // [g * getGroupSize(), (g + 1) * getGroupSize()).
+    int getGroupSize() const {
+        return isPipelined() ? numChannels_ : static_cast<int>(kNumLanes);
+    }
+    int getNumGroups(int numChannels) const {
+        return (std::min(numChannels, numChannels_) + getGroupSize() - 1) / getGroupSize();
+    }
+
+    // processBlock() and processBlockSummed() for the channels of one group (those below
+    // numChannels). Each block has every group processed, in any order and concurrently
+    // if need be, then endBlock() called once.
+    void processGroup(int group, const SampleType* const* input, const Bands& bands,
+                      int numChannels, int numSamples);
+    void processGroupSummed(int group, const SampleType* const* input,
+                            SampleType* const* output, int numChannels, int numSamples);
+    void endBlock(int numSamples);
+
+    // isSilent() and reset() for the channels of one group, which callers that skip
+    // silent groups use between blocks
+    bool isGroupSilent(int group, SampleType threshold) const;
+    void resetGroup(int group);
+
+    // One LR4 step (two cascaded 2nd-order SVFs), shared by the scalar and SIMD paths.
+    // Public for kernels that derive their own form from it, such as FusedCrossover.
+    template <typename T>
+    static void processSection(T input, T& s1, T& s2, T& s3, T& s4, T g, T r2, T k, T h,
+                               T& lowOut, T& highOut) {
+        auto yH = (input - k * s1 - s2) * h;
+        auto yB = g * yH + s1;
+        s1 = g * yH + yB;
+        auto yL = g * yB + s2;
+        s2 = g * yB + yL;
+
+        auto yH2 = (yL - k * s3 - s4) * h;
+        auto yB2 = g * yH2 + s3;
+        s3 = g * yH2 + yB2;
+        auto yL2 = g * yB2 + s4;
+        s4 = g * yB2 + yL2;
+
+        lowOut = yL2;
+        highOut = yL - r2 * yB + yH - yL2;
+    }
+
+    // The LR4's LP + HP on its own: the first SVF's 2nd-order allpass output.
+    template <typename T>
+    static void processAllpassSection(T input, T& s1, T& s2, T g, T r2, T k, T h, T& out) {
+        auto yH = (input - k * s1 - s2) * h;
+        auto yB = g * yH + s1;
+        s1 = g * yH + yB;
+        auto yL = g * yB + s2;
+        s2 = g * yB + yL;
+
+        out = yL - r2 * yB + yH;
+    }
 
 private:
-    // Crossover 1: low/mid split at 250 Hz
-    juce::dsp::LinkwitzRileyFilter<float> lowMidSplit_;
+    using Network = CrossoverNetwork<NumBands>;
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t kNumLanes = Vec::SIMDNumElements;
+    static constexpr size_t kNumNodes = static_cast<size_t>(Network::kNumNodes);
+
+    // The pipelined layout needs every split of every channel in one register, with no
+    // split more than one sample behind the input, and every allpass in a second.
+    static constexpr size_t kNumSplitNodes = static_cast<size_t>(Network::kNumSplits);
+    static constexpr size_t kNumAllpassNodes = static_cast<size_t>(Network::kNumAllpasses);
+    static constexpr size_t kMaxPipelinedChannels =
+        Network::kMaxDepth > 1 ? 0 : kNumLanes / std::max(kNumSplitNodes, kNumAllpassNodes);
+    static constexpr size_t kNumPipelinedBanks = kNumAllpassNodes > 0 ? 2 : 1;
+
+    struct alignas(16) LaneArray {
+        SampleType v[kNumLanes] = {};
+    };
+
+    // kNumLanes independent LR4 sections, one per lane. Allpass nodes use only the
+    // first SVF (s1, s2).
+    struct SectionBank {
+        // Coefficients: g = tan(pi * fc / fs), k = R2 + g, h = 1 / (1 + R2 g + g^2)
+        LaneArray g;
+        LaneArray r2;
+        LaneArray k;
+        LaneArray h;
+
+        // Integrator states
+        LaneArray s1;
+        LaneArray s2;
+        LaneArray s3;
+        LaneArray s4;
+
+        // Glide: per-sample step of g, and the exact coefficients it ends on
+        LaneArray gStep;
+        LaneArray gTarget;
+        LaneArray kTarget;
+        LaneArray hTarget;
+
+        void setCoefficients(size_t lane, const typename Coefficients::Split& split);
+        void setModulated(size_t lane, SampleType gValue);
+        void setGlideTarget(size_t lane, const typename Coefficients::Split& split,
+                            size_t glideSamples);
+        void glideStep();
+        void finishGlide();
+        void resetState();
+        void processLane(size_t lane, SampleType input, SampleType& lowOut,
+                         SampleType& highOut);
+        void processAllpassLane(size_t lane, SampleType input, SampleType& out);
+    };
+
+    // A SectionBank loaded into registers for the duration of a block.
+    struct BankRegisters;
+
+    // g of split point s at sample n of a modulated block
+    SampleType modulatedG(size_t split, size_t n) const {
+        return static_cast<SampleType>(modulationTable_->gAt(modulation_[split][n]));
+    }
+
+    // Block state-space form of one node for kNumLanes samples of one channel, lane j
+    // of an output being sample j of the block. The node's states are z = (s1, s2, s3, s4),
+    // packed kNumLanes to a register; allpass nodes use s1, s2 and the low output only.
+    static constexpr size_t kSectionStates = 4;
+    static constexpr size_t kStateVecs = (kSectionStates + kNumLanes - 1) / kNumLanes;
+
+    struct BlockMatrices {
+        std::array<LaneArray, kSectionStates> stateToLow;
+        std::array<LaneArray, kSectionStates> stateToHigh;
+        std::array<LaneArray, kNumLanes> inputToLow;
+        std::array<LaneArray, kNumLanes> inputToHigh;
+        std::array<std::array<LaneArray, kStateVecs>, kSectionStates> stateToState;
+        std::array<std::array<LaneArray, kStateVecs>, kNumLanes> inputToState;
+    };
+
+    // Samples per node buffer when running time-parallel
+    static constexpr size_t kTimeParallelChunk = 64;
+
+    struct LaneRef {
+        size_t bank;
+        size_t lane;
+    };
+
+    bool isPipelined() const { return numChannels_ <= static_cast<int>(kMaxPipelinedChannels); }
+    LaneRef nodeLane(size_t node, size_t channel) const;
+
+    // Banks holding the channels of a group, [first, end)
+    std::pair<size_t, size_t> groupBanks(int group) const;
+
+    // Rebuilds blockMatrices_ from the coefficients in the banks, which must not be gliding
+    void updateBlockMatrices();
+
+    // Whether the group starting at channel first runs this block time-parallel. Never
+    // while modulated.
+    bool runsTimeParallel(size_t first, size_t numChannels, size_t numSamples,
+                          size_t glideSamples) const;
+
+    // Runs the kernel for the active layout over one channel group and hands every band
+    // sample to
+    //   sink(band, channel, sample, value)
+    // Per channel, the bands of sample n arrive in ascending order, all before band 0
+    // of sample n + 1. With the allpass sum on, only the band sum arrives, as band 0.
+    template <typename Sink>
+    void runGroup(int group, const SampleType* const* input, int numChannels, int numSamples,
+                  Sink&& sink);
+
+    // glideSamples (<= numSamples) is how many of the block's samples advance the glide.
+    template <typename Sink>
+    void runPipelined(const SampleType* const* input, size_t numChannels, size_t numSamples,
+                      size_t glideSamples, Sink& sink);
+
+    // The group of kNumLanes channels starting at first
+    template <typename Sink>
+    void runGrouped(size_t first, const SampleType* const* input, size_t numChannels,
+                    size_t numSamples, size_t glideSamples, Sink& sink);
+
+    // The channels of the group starting at first, one at a time
+    template <typename Sink>
+    void runTimeParallel(size_t first, const SampleType* const* input, size_t numChannels,
+                         size_t numSamples, Sink& sink);
+
+    // The allpass sum's counterparts of the three kernels above. Sample n of a channel
+    // goes out as sink(0, channel, n, sum).
+    template <typename Sink>
+    void runPipelinedAllpassSum(const SampleType* const* input, size_t numChannels,
+                                size_t numSamples, Sink& sink);
+    template <typename Sink>
+    void runGroupedAllpassSum(size_t first, const SampleType* const* input, size_t numChannels,
+                              size_t numSamples, Sink& sink);
+    template <typename Sink>
+    void runTimeParallelAllpassSum(size_t first, const SampleType* const* input,
+                                   size_t numChannels, size_t numSamples, Sink& sink);
+
+    // One node's form m over numSamples of the channel state holds: kNumLanes samples per
+    // vector step, then the remainder one by one. low and high are SIMD-aligned.
+    template <bool IsSplit>
+    void runNodeTimeParallel(const BlockMatrices& m, LaneRef state, const SampleType* in,
+                             SampleType* low, SampleType* high, size_t numSamples);
 
-    // Crossover 2: mid/high split at 3140 Hz (applied to HP output of split 1)
-    juce::dsp::LinkwitzRileyFilter<float> midHighSplit_;
+    std::vector<SectionBank> banks_;
+    bool allpassSum_ = false;
+    std::array<BlockMatrices, kNumNodes> blockMatrices_{};
+    Execution execution_ = Execution::automatic;
+    int numChannels_ = 0;
+    size_t glideLength_ = 0;
+    size_t glideRemaining_ = 0;
+    const CrossoverCoefficientTable* modulationTable_ = nullptr;
+    Positions modulation_{};
 };
 
 }  // namespace audio_plugin
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace audio_plugin {
+
+// Compile-time shape of an N-band LR4 crossover.
+//
+// The bands come from a cascade of N - 1 splits, lowest first:
+//   Input -> split 0 -> LP -> band 0
+//                    -> HP -> split 1 -> LP -> band 1
+//                                     -> HP -> ...   -> split N-2 -> LP -> band N-2
+//                                                                 -> HP -> band N-1
+//
+// Summing that cascade gives LP0 + HP0 (LP1 + HP1 (...)), which is only an allpass if
+// every lower band also passes through the allpass (LP + HP) of each split above it:
+//   band i -> AP(i + 1) -> ... -> AP(N - 2)
+// With that compensation the band sum is AP0 AP1 ... AP(N-2), flat in magnitude, at
+// a cost of (N - 1)(N - 2) / 2 second-order allpasses per channel. Two bands need none.
+// From three up it is always on: without it the sum notches wherever two splits come
+// close, -3.6 dB with an octave between them and -12 dB at 800 / 1000 Hz.
+//
+// Every LR4 split and every allpass is a node. Nodes are listed in dependency order,
+// so a single pass over them processes one sample, and a node's depth is how many
+// nodes its input has passed through.
+template <int NumBands>
+struct CrossoverNetwork {
+    static_assert(NumBands >= 2, "a crossover needs at least two bands");
+
+    enum class Kind { split, allpass };
+    enum class Tap { low, high, allpass };
+
+    // Where a node input or a band output comes from. node < 0 is the crossover input.
+    struct Source {
+        int node;
+        Tap tap;
+    };
+
+    struct Node {
+        Kind kind;
+        int split;  // split point whose coefficients the node runs on
+        Source input;
+        int depth;
+    };
+
+    static constexpr int kNumSplits = NumBands - 1;
+    static constexpr bool kCompensated = NumBands >= 3;
+    static constexpr int kNumAllpasses = kCompensated ? kNumSplits * (kNumSplits - 1) / 2 : 0;
+    static constexpr int kNumNodes = kNumSplits + kNumAllpasses;
+
+    static constexpr std::array<Node, static_cast<size_t>(kNumNodes)> makeNodes() {
+        std::array<Node, static_cast<size_t>(kNumNodes)> nodes{};
+        for (int s = 0; s < kNumSplits; ++s)
+            nodes[static_cast<size_t>(s)] = {Kind::split, s, {s - 1, Tap::high}, s};
+
+        if constexpr (kCompensated) {
+            int next = kNumSplits;
+            for (int band = 0; band < kNumSplits - 1; ++band) {
+                Source chain{band, Tap::low};
+                for (int s = band + 1; s < kNumSplits; ++s) {
+                    nodes[static_cast<size_t>(next)] = {Kind::allpass, s, chain, s};
+                    chain = {next++, Tap::allpass};
+                }
+            }
+        }
+        return nodes;
+    }
+
+    static constexpr std::array<Source, static_cast<size_t>(NumBands)> makeBands() {
+        std::array<Source, static_cast<size_t>(NumBands)> bands{};
+        for (int band = 0; band < kNumSplits; ++band)
+            bands[static_cast<size_t>(band)] = {band, Tap::low};
+        bands[static_cast<size_t>(kNumSplits)] = {kNumSplits - 1, Tap::high};
+
+        // Compensated bands come out of the last allpass of their chain
+        if constexpr (kCompensated) {
+            int last = kNumSplits - 1;
+            for (int band = 0; band < kNumSplits - 1; ++band) {
+                last += kNumSplits - 1 - band;
+                bands[static_cast<size_t>(band)] = {last, Tap::allpass};
+            }
+        }
+        return bands;
+    }
+
+    static constexpr auto nodes = makeNodes();
+    static constexpr auto bands = makeBands();
+
+    static constexpr int depthOf(Source source) {
+        return source.node < 0 ? -1 : nodes[static_cast<size_t>(source.node)].depth;
+    }
+
+    static constexpr int kMaxDepth = kNumSplits - 1;
+};
+
+}  // namespace audio_plugin
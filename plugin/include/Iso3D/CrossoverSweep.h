@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "Constants.h"
+#include "Crossover.h"
+
+namespace audio_plugin {
+
+// LFO sweep of both split points, for Crossover::modulate(): a sine of up to
+// kMaxSweepOctaves either side of the split points the parameters set, moving both the same
+// way, each kept within its parameter's range. The split points are handed over as
+// positions on a CrossoverCoefficientTable made at prepare(), so the crossover follows the
+// sweep every sample without a tan() per split point.
+//
+// The sine comes from a rotating phasor rather than std::sin(), and depth and split points
+// move linearly across each call from where the last one left them, so parameter changes
+// don't step. A sweep that starts from rest does so at phase 0, on the split points.
+class CrossoverSweep {
+public:
+    using Frequencies = CrossoverCoefficients<>::Frequencies;
+    using Positions = Crossover<float>::Positions;
+
+    // Allocates for numSamples up to maxSamples per call
+    void prepare(double sampleRate, int maxSamples);
+    void reset();
+
+    // Moves the sweep on by numSamples, filling getPositions() for them. Returns false,
+    // with nothing filled, while the depth is and was 0.
+    bool advance(const Frequencies& frequenciesHz, float depthOctaves, float rateHz,
+                 int numSamples);
+
+    const CrossoverCoefficientTable& getTable() const { return table_; }
+    Positions getPositions() const;
+
+private:
+    static constexpr size_t kNumSplits = CrossoverCoefficients<>::kNumSplits;
+
+    CrossoverCoefficientTable table_;
+    double sampleRate_ = 0.0;
+
+    // Each split point's parameter range as grid positions
+    std::array<float, kNumSplits> minPositions_{};
+    std::array<float, kNumSplits> maxPositions_{};
+
+    std::array<std::vector<float>, kNumSplits> positions_;
+
+    // Phasor (cos, sin) and its rotation per sample at rate_
+    double cos_ = 1.0;
+    double sin_ = 0.0;
+    double rotationCos_ = 1.0;
+    double rotationSin_ = 0.0;
+    float rate_ = 0.0f;
+
+    // Where the last call ended, in grid steps
+    float depth_ = 0.0f;
+    std::array<float, kNumSplits> centres_{};
+};
+
+}  // namespace audio_plugin
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+
+#include <juce_core/juce_core.h>
+
+#include "Crossover.h"
+#include "DoubleBuffer.h"
+#include "LinearPhaseCrossover.h"
+
+namespace audio_plugin {
+
+// Turns the crossover frequency parameters into LR4 coefficients and linear-phase FIR
+// kernels on a background thread and publishes them through lock-free DoubleBuffers, so
+// the audio thread only ever picks up finished results and never calls tan() or
+// designs a filter.
+//
+// The thread polls the parameter values rather than being woken by listeners, because
+// hosts deliver automation on the audio thread and waking a thread from there is not
+// real-time safe. Offline there is no deadline to protect and polling would land changes
+// wherever the thread happened to wake, so no thread runs: update() does the same work
+// on the thread rendering the audio, and every render takes a change at the same sample.
+class CrossoverTuner : private juce::Thread {
+public:
+    CrossoverTuner(const std::atomic<float>& lowMidHz, const std::atomic<float>& midHighHz);
+    ~CrossoverTuner() override;
+
+    using Frequencies = CrossoverCoefficients<>::Frequencies;
+
+    // Message thread. Returns the current parameter values, to prime the crossovers
+    // with, and (re)starts watching the parameters at this sample rate: from the
+    // background thread when realtime, else only in update().
+    Frequencies start(double sampleRate, bool realtime);
+    void stop();
+
+    // Message thread, between blocks. Starts or stops the background thread for a switch
+    // to or from offline rendering, keeping what has been published.
+    void setRealtime(bool realtime);
+
+    // Offline audio thread. Publishes whatever the parameters have moved to since the
+    // last result, ready for pull(). Does nothing while the background thread runs.
+    void update();
+
+    // Audio thread. Return true and fill out if a result was published since the last
+    // call. A kernel is copied into out, which never allocates once out has been made at
+    // the same sample rate.
+    bool pull(CrossoverCoefficients<>& out) { return published_.pull(out); }
+    bool pull(LinearPhaseKernel<>& out) { return publishedKernel_.pull(out); }
+
+private:
+    void run() override;
+
+    // One poll of the parameters, publishing what they have moved to
+    void tune();
+
+    const std::atomic<float>& lowMidHz_;
+    const std::atomic<float>& midHighHz_;
+
+    // Written only while the thread is stopped
+    double sampleRate_ = 0.0;
+
+    // Frequencies behind the most recent publish of each kind (tuner thread only)
+    Frequencies publishedFrequencies_{};
+    Frequencies publishedKernelFrequencies_{};
+
+    DoubleBuffer<CrossoverCoefficients<>> published_;
+    DoubleBuffer<LinearPhaseKernel<>> publishedKernel_;
+
+    JUCE_DECLARE_NON_COPYABLE(CrossoverTuner)
+};
+
+}  // namespace audio_plugin
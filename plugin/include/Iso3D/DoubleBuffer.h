@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace audio_plugin {
+
+// Lock-free single-producer, single-consumer hand-off of the latest value.
+//
+// The producer fills the back slot and flips it to the front; the consumer copies the
+// front slot out. The producer will not write again until the consumer has taken the
+// published value, so the two sides never touch the same slot at once and neither
+// ever blocks. A refused push() is simply retried later with fresher data.
+template <typename T>
+class DoubleBuffer {
+public:
+    // Producer. Returns false, publishing nothing, while the previous value is unread.
+    bool push(const T& value) {
+        if (pending_.load(std::memory_order_acquire)) return false;
+
+        const int back = 1 - front_.load(std::memory_order_relaxed);
+        slots_[static_cast<size_t>(back)] = value;
+        front_.store(back, std::memory_order_relaxed);
+        pending_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Producer. True if push() would publish now, to skip building a value that would
+    // only be refused.
+    bool canPush() const { return !pending_.load(std::memory_order_acquire); }
+
+    // Consumer. Copies the newest value into out and returns true if one was published
+    // since the last pull().
+    bool pull(T& out) {
+        if (!pending_.load(std::memory_order_acquire)) return false;
+
+        out = slots_[static_cast<size_t>(front_.load(std::memory_order_relaxed))];
+        pending_.store(false, std::memory_order_release);
+        return true;
+    }
+
+    // Drops any unread value. Neither side may be running.
+    void clear() { pending_.store(false); }
+
+private:
+    std::array<T, 2> slots_{};
+    std::atomic<int> front_{0};
+    std::atomic<bool> pending_{false};
+};
+
+}  // namespace audio_plugin
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "Constants.h"
+#include "Crossover.h"
+
+namespace audio_plugin {
+
+// The 3-band LR4 crossover, its low band's allpass compensation included, and the
+// gain-weighted sum of its bands as one state-space system per channel:
+//   z[n + 1] = A z[n] + B x[n]
+//   y[n]     = C(gains) z[n] + D(gains) x[n]
+//
+// A, B and the bands' output rows come from the TPT sections Crossover runs, probed in
+// double precision with the same split coefficients, and are then moved to a basis where
+// the update is cheap:
+//   - The mid/high section and the allpass are decoupled from the low/mid section (a
+//     Sylvester solve each), so both are driven by the input rather than by the low/mid
+//     section's outputs.
+//   - Each section, two identical second-order SVFs in cascade, becomes a real Jordan
+//     block: the SVF's pole pair as a rotation R = [s w; -w s], twice over, the second
+//     half fed by the first and the input entering a single state:
+//       u' = R u + (x, 0)
+//       w' = R w + u
+//     The allpass, a single SVF, keeps only u.
+// That costs 15 operations per section, 7 for the allpass and 23 for the output row, 60
+// per channel sample against 65 for the TPT network (two LR4s and the allpass) and 5 for
+// the gains, and the bands are never written to buffers and read back. The sections and
+// allpass of one channel are slots sharing SIMD registers, so a mono frame in float is a
+// single register step.
+//
+// C and D are the bands' output rows weighted by the band gains, and are only rebuilt
+// when the gains change: once for a new steady value, every sample while a gain ramps.
+//
+// Coefficient changes take effect at once, with the state carried over through the TPT
+// basis, as with Crossover::setCoefficients(). The same basis change hands the state to
+// and from a Crossover, so the processor runs this in its place whenever nothing needs
+// the separate bands and the split points hold still. Instantiated for float and double.
+template <typename SampleType>
+class FusedCrossover {
+public:
+    using Coefficients = CrossoverCoefficients<kNumBands>;
+    using Gains = std::array<SampleType, kNumBands>;
+
+    // One channel's band gains over a block: current, or per sample from ramps (all three
+    // set, or none)
+    struct ChannelGains {
+        Gains current{};
+        std::array<const SampleType*, kNumBands> ramps{};
+    };
+
+    // Starts at Coefficients::defaultFrequencies() and unity gains.
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    int getNumChannels() const { return numChannels_; }
+
+    // Folded (every slot of every channel in one register: mono in float) or grouped
+    // (a bank per slot for each kNumLanes channels). Folded, each sample waits on the
+    // last, so Crossover running along time outpaces it even with the gains on top.
+    bool isFolded() const {
+        return static_cast<int>(kNumSlots) * numChannels_ <= static_cast<int>(kNumLanes);
+    }
+
+    void setCoefficients(const Coefficients& coefficients);
+
+    // Writes the gain-weighted band sum of the first numChannels (<= getNumChannels())
+    // channels to output, with channel ch's gains in gains[ch]. Output may alias input.
+    void processBlock(const SampleType* const* input, SampleType* const* output,
+                      const ChannelGains* gains, int numChannels, int numSamples);
+
+    // Channel groups, which share no state: the same channels as Crossover<SampleType>'s
+    // groups on the same channel count. Group g holds channels
+    // [g * getGroupSize(), (g + 1) * getGroupSize()).
+    int getGroupSize() const { return isFolded() ? numChannels_ : static_cast<int>(kNumLanes); }
+    int getNumGroups(int numChannels) const {
+        return (std::min(numChannels, numChannels_) + getGroupSize() - 1) / getGroupSize();
+    }
+
+    // processBlock() for the channels of one group, which can run concurrently with the
+    // others
+    void processGroup(int group, const SampleType* const* input, SampleType* const* output,
+                      const ChannelGains* gains, int numChannels, int numSamples);
+
+    // As Crossover's, with the threshold applied to the TPT integrators the state stands
+    // for, so both engines go idle on the same signal
+    bool isSilent(SampleType threshold) const;
+    bool isGroupSilent(int group, SampleType threshold) const;
+    void resetGroup(int group);
+
+    // Takes over the filter state of crossover, which must run the same channels on the
+    // coefficients last passed to setCoefficients() with its allpass sum off, or hands
+    // this one's back to it. Exact up to rounding, so the two can take turns at any block
+    // boundary.
+    void takeState(const Crossover<SampleType>& crossover);
+    void handState(Crossover<SampleType>& crossover) const;
+
+private:
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t kNumLanes = Vec::SIMDNumElements;
+    static constexpr size_t kNumSections = static_cast<size_t>(kNumBands - 1);
+    static constexpr size_t kNumSlots = kNumSections + 1;  // the sections, then the allpass
+    static constexpr size_t kSectionStates = 4;            // u1, u2, w1, w2
+    static constexpr size_t kAllpassStates = 2;            // u1, u2
+    static constexpr size_t kNumStates = kNumSections * kSectionStates + kAllpassStates;
+
+    static constexpr size_t statesOf(size_t slot) {
+        return slot < kNumSections ? kSectionStates : kAllpassStates;
+    }
+
+    // Output row of one slot: a weight per state, then the input's (nonzero only in
+    // the first section's slot, so each channel counts D once). The allpass slot's w
+    // weights are 0.
+    static constexpr size_t kRowSize = kSectionStates + 1;
+
+    // The system for one set of split coefficients, in double precision
+    struct Design {
+        using Matrix = std::array<std::array<double, kNumStates>, kNumStates>;
+
+        std::array<double, kNumSlots> sigma{};
+        std::array<double, kNumSlots> omega{};
+
+        // Per band, a weight per state and the input's
+        std::array<std::array<double, kNumStates + 1>, kNumBands> rows{};
+
+        // Change of basis: TPT integrator states = toTpt z
+        Matrix toTpt{};
+        Matrix fromTpt{};
+
+        static Design make(const Coefficients& coefficients);
+    };
+
+    struct alignas(16) LaneArray {
+        SampleType v[kNumLanes] = {};
+    };
+
+    // kNumLanes slots, each one section or the allpass of one channel
+    struct SlotBank {
+        LaneArray sigma;
+        LaneArray omega;
+        std::array<std::array<LaneArray, kRowSize>, kNumBands> bandRows;
+
+        // Gain-weighted row, and the gains it was built for
+        std::array<LaneArray, kRowSize> row;
+        std::array<LaneArray, kNumBands> rowGains;
+
+        LaneArray u1;
+        LaneArray u2;
+        LaneArray w1;
+        LaneArray w2;
+
+        // Channel of each lane, -1 where unused
+        std::array<int, kNumLanes> channels{};
+    };
+
+    struct SlotRef {
+        size_t bank;
+        size_t lane;
+    };
+
+    SlotRef slot(size_t channel, size_t index) const;
+
+    // A channel's state in the TPT basis, in Design's order, and back
+    std::array<double, kNumStates> tptState(size_t channel) const;
+    void setTptState(size_t channel, const std::array<double, kNumStates>& state);
+
+    // One bank loaded into registers for the duration of a block, with its gains
+    class BankRun;
+
+    void processFolded(const SampleType* const* input, SampleType* const* output,
+                       const ChannelGains* gains, size_t numChannels, size_t numSamples);
+    void processGrouped(size_t first, const SampleType* const* input,
+                        SampleType* const* output, const ChannelGains* gains,
+                        size_t numChannels, size_t numSamples);
+
+    std::vector<SlotBank> banks_;
+    int numChannels_ = 0;
+    Design design_;
+};
+
+}  // namespace audio_plugin
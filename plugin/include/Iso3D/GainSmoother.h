@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "Constants.h"
+
+namespace audio_plugin {
+
+// Per-band EMA gain smoother, evaluated in closed form once per block.
+//
+// The per-sample recurrence g[n] = g[n-1] + alpha * (target - g[n-1]) has the solution
+//   g[n] = target + (g[-1] - target) * r^(n+1),  r = 1 - alpha
+// so a block's ramp is one multiply-add against a decay table r^(n+1) computed in
+// prepare(), with no serial dependency between samples.
+//
+// Once every band is within kGainSmoothEpsilon of its target the smoother snaps to
+// the targets and reports itself steady, so callers can apply constant gains.
+// Instantiated for float and double.
+template <typename SampleType>
+class GainSmoother {
+public:
+    using Gains = std::array<SampleType, kNumBands>;
+
+    void prepare(double sampleRate, int maxBlockSize);
+    void reset(SampleType gain);
+
+    // Computes the gains for the next numSamples (<= maxBlockSize) samples.
+    // Returns true if all bands hold constant gains for the block, in which case
+    // getCurrent() is valid and the ramps are left untouched.
+    bool advance(const Gains& targets, int numSamples);
+
+    // Per-sample gains of the last non-steady advance()
+    const SampleType* getRamp(int band) const { return ramps_.getReadPointer(band); }
+
+    // Gain reached at the end of the last advance()
+    SampleType getCurrent(int band) const { return current_[static_cast<size_t>(band)]; }
+
+private:
+    Gains current_{};
+    std::vector<SampleType> decay_;  // decay_[n] = r^(n+1)
+    juce::AudioBuffer<SampleType> ramps_;
+};
+
+}  // namespace audio_plugin
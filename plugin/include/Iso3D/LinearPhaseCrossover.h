@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "Constants.h"
+#include "Crossover.h"
+
+namespace audio_plugin {
+
+// Frequency-domain FIR kernels for LinearPhaseCrossover at one sample rate: the spectra
+// of one windowed-sinc low-pass per split point, cut into partitions for uniformly
+// partitioned convolution. Designing them costs a few FFTs, so like
+// CrossoverCoefficients they are made off the audio thread.
+template <int NumBands = kNumBands>
+struct LinearPhaseKernel {
+    static constexpr size_t kNumSplits = static_cast<size_t>(NumBands - 1);
+    using Frequencies = typename CrossoverCoefficients<NumBands>::Frequencies;
+
+    size_t partitionSize = 0;  // B; each partition is convolved with a 2B-point FFT
+    size_t numPartitions = 0;
+
+    // [split][partition][bin], B + 1 bins per partition, real and imaginary parts apart
+    std::vector<float> real;
+    std::vector<float> imag;
+
+    static size_t partitionSizeFor(double sampleRate);
+    static LinearPhaseKernel make(double sampleRate, const Frequencies& frequenciesHz);
+};
+
+// Linear-phase N-band crossover, the FIR counterpart of Crossover.
+//
+// Each split point gets a symmetric windowed-sinc low-pass LP_s of odd length
+// N = kLinearPhaseNumPartitions * B - 1, so every filter has the same pure delay
+// L = (N - 1) / 2. The bands are differences of those low-passes:
+//   band 0     = LP_0
+//   band i     = LP_i - LP_(i-1)
+//   band N - 1 = delay(L) - LP_(N-2)
+// which makes them linear-phase and exactly complementary: they sum to the input
+// delayed by L, with no phase shift between bands.
+//
+// Only the low-passes are convolved, with uniformly partitioned overlap-save FFT
+// convolution: input is gathered into partitions of B samples, each partition is
+// transformed once into a spectrum history, and every low-pass costs one complex
+// multiply-accumulate over that history plus one inverse FFT per partition.
+// Gathering adds B samples, so the total latency is L + B.
+//
+// Convolution runs in single precision (juce::dsp::FFT is float only). The double
+// instantiation converts at the edges; the band sum and delay path stay in double.
+template <typename SampleType, int NumBands = kNumBands>
+class LinearPhaseCrossover {
+public:
+    using Kernel = LinearPhaseKernel<NumBands>;
+
+    // Per band, lowest first: one pointer per channel
+    using Bands = std::array<SampleType* const*, static_cast<size_t>(NumBands)>;
+
+    // Starts on a kernel for CrossoverCoefficients::defaultFrequencies().
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+
+    int getNumChannels() const { return numChannels_; }
+
+    // Delay of every band, and of the band sum, relative to the input.
+    int getLatencySamples() const { return static_cast<int>(latency_); }
+
+    // Samples after reset() until the output no longer depends on the cleared history.
+    int getWarmupSamples() const {
+        return static_cast<int>(partitionSize_ * (numPartitions_ + 1));
+    }
+
+    // Jumps straight to the given kernel, dropping any crossfade not yet started.
+    void setKernel(const Kernel& kernel) {
+        kernels_[current_] = kernel;
+        fadePending_ = false;
+    }
+
+    // Calls fill(Kernel&) with a kernel slot sized for the prepared sample rate. If fill
+    // returns true, the slot becomes the current kernel and the change is crossfaded over
+    // the next partition whose bands are computed. Never allocates as long as fill only
+    // copies in a kernel made at the prepared sample rate.
+    template <typename Fill>
+    bool updateKernel(Fill&& fill) {
+        Kernel& slot = kernels_[fadePending_ ? current_ : 1 - current_];
+        if (!fill(slot)) return false;
+        jassert(slot.real.size() == kernels_[current_].real.size());
+
+        // While a change is pending the current slot was never heard, so it is simply
+        // replaced and the crossfade still starts from the kernel last used.
+        if (!fadePending_) current_ = 1 - current_;
+        fadePending_ = true;
+        return true;
+    }
+
+    // Splits numSamples of the first numChannels (<= getNumChannels()) input channels
+    // into band buffers, getLatencySamples() late. Input may alias none of the band
+    // buffers; all pointers must hold numSamples.
+    void processBlock(const SampleType* const* input, const Bands& bands, int numChannels,
+                      int numSamples);
+
+    // Unity-gain path: the band sum is the delayed input, so this only keeps the
+    // spectrum history current and skips the convolutions. Callers can switch
+    // between this and processBlock() at any block boundary. Output may alias input.
+    void processBlockSummed(const SampleType* const* input, SampleType* const* output,
+                            int numChannels, int numSamples);
+
+private:
+    static constexpr size_t kNumSplits = Kernel::kNumSplits;
+
+    // Appends n samples of every channel to the partition being gathered and to the
+    // delay line, writing what leaves the delay line to delayed[ch] + offset.
+    void pushInput(const SampleType* const* input, SampleType* const* delayed,
+                   size_t numChannels, size_t offset, size_t n);
+
+    // Transforms the completed partition of every channel into the spectrum history.
+    void finishPartition(size_t numChannels);
+
+    // Convolves the low-passes played back during the current partition, for the
+    // channels not done yet. Deferred until some band is needed, so the summed path
+    // never pays for it.
+    void computeLowPasses(size_t numChannels);
+    void convolve(const Kernel& kernel, size_t channel, size_t split, float* out);
+
+    // Walks the block in spans that end on partition boundaries and hands each to
+    //   span(offset, length, numChannels)
+    template <typename Span>
+    void run(int numChannels, int numSamples, Span&& span);
+
+    std::unique_ptr<juce::dsp::FFT> fft_;
+    std::array<Kernel, 2> kernels_;
+    size_t current_ = 0;
+    bool fadePending_ = false;
+    bool fadeActive_ = false;
+
+    int numChannels_ = 0;
+    size_t partitionSize_ = 0;
+    size_t numPartitions_ = 0;
+    size_t numBins_ = 0;
+    size_t latency_ = 0;
+
+    // Per channel: the previous and the partition being gathered (2B), the spectrum
+    // history of the last numPartitions_ partitions ([partition][bin]), the low-pass
+    // outputs being played back ([split][sample]) and the delay line (latency_ samples)
+    std::vector<float> frames_;
+    std::vector<float> spectraReal_;
+    std::vector<float> spectraImag_;
+    std::vector<float> lowPasses_;
+    std::vector<SampleType> delayLines_;
+
+    // Shared scratch: FFT work buffer (4B), spectrum accumulators, crossfade source
+    std::vector<float> fftBuffer_;
+    std::vector<float> accReal_;
+    std::vector<float> accImag_;
+    std::vector<float> fadeSource_;
+
+    size_t fill_ = 0;  // samples gathered into the current partition
+    size_t head_ = 0;  // spectrum history slot of the newest partition
+    size_t delayPos_ = 0;
+    size_t computedChannels_ = 0;  // channels whose low-passes are current
+};
+
+}  // namespace audio_plugin
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "BinaryState.h"
+
+namespace audio_plugin {
+
+// What processBlock costs against its real-time budget, the time the block's samples
+// last at the prepared sample rate. Load is time taken / budget: at 1.0 the host drops
+// out.
+struct LoadStats {
+    // Blocks per load range, kBinWidth wide up to the budget, then one bin for overruns
+    static constexpr int kNumBins = 21;
+    static constexpr double kBinWidth = 0.05;
+
+    std::array<int64_t, kNumBins> histogram{};
+    int64_t numBlocks = 0;
+    int64_t numOverruns = 0;  // blocks over budget, the last histogram bin
+    double averageLoad = 0.0;  // smoothed over recent blocks by AudioProcessLoadMeasurer
+    double worstLoad = 0.0;
+    double worstBlockMs = 0.0;  // time taken by the worst block
+    int worstBlockSize = 0;
+
+    // Chunk of the block AudioPluginAudioProcessor::getLoadStatsInformation() writes,
+    // for hosts and tools that read it. readFrom() returns nullopt if the payload is cut
+    // short or has a different bin count.
+    static constexpr uint32_t kChunkTag = chunkTag("LOAD");
+    void writeTo(juce::OutputStream& stream) const;
+    static std::optional<LoadStats> readFrom(juce::InputStream& stream);
+
+    // Element the figures were saved as in XML states. They describe a run, not a
+    // session, so states no longer hold them; restoring skips this and earlier binary
+    // states' LOAD chunk.
+    static constexpr const char* kStateTag = "Load";
+};
+
+// Times processBlock calls and gathers LoadStats for them.
+//
+// The audio thread is the only writer, and every figure is its own atomic, so
+// getStats() can run on any thread at any time; figures read while a block is being
+// added may be that one block apart.
+class LoadProfiler {
+public:
+    // Message thread, with audio stopped. Starts over with the new budget.
+    void prepare(double sampleRate, int samplesPerBlock);
+
+    // Any thread. The figures start over at the next block.
+    void reset() { resetRequested_.store(true); }
+
+    LoadStats getStats() const;
+
+    // Audio thread. Adds one block of numSamples that took milliseconds.
+    void addBlock(double milliseconds, int numSamples);
+
+    // Audio thread. Times its own lifetime as one block of numSamples.
+    class ScopedBlock {
+    public:
+        ScopedBlock(LoadProfiler& profiler, int numSamples)
+            : profiler_(profiler),
+              numSamples_(numSamples),
+              startTicks_(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlock() {
+            const auto ticks = juce::Time::getHighResolutionTicks() - startTicks_;
+            profiler_.addBlock(1000.0 * juce::Time::highResolutionTicksToSeconds(ticks),
+                               numSamples_);
+        }
+
+        ScopedBlock(const ScopedBlock&) = delete;
+        ScopedBlock& operator=(const ScopedBlock&) = delete;
+
+    private:
+        LoadProfiler& profiler_;
+        int numSamples_;
+        juce::int64 startTicks_;
+    };
+
+private:
+    void clear();
+
+    juce::AudioProcessLoadMeasurer measurer_;
+    double sampleRate_ = 0.0;
+    int samplesPerBlock_ = 0;
+
+    std::array<std::atomic<int64_t>, LoadStats::kNumBins> histogram_{};
+    std::atomic<int64_t> numBlocks_{0};
+    std::atomic<double> worstLoad_{0.0};
+    std::atomic<double> worstBlockMs_{0.0};
+    std::atomic<int> worstBlockSize_{0};
+    std::atomic<bool> resetRequested_{false};
+};
+
+}  // namespace audio_plugin
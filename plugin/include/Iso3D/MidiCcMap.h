@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include <juce_core/juce_core.h>
+
+#include "BinaryState.h"
+#include "Constants.h"
+
+namespace audio_plugin {
+
+// Parameters a MIDI controller can be assigned to, by target index. The band gains of
+// decks 2 and up only exist in multi-deck builds.
+inline constexpr std::array<const char*, 19> kMidiTargets = {
+    ParamID::kLow,        ParamID::kMid,         ParamID::kHigh,        ParamID::kBoost,
+    ParamID::kLowMidFreq, ParamID::kMidHighFreq, ParamID::kLinearPhase, ParamID::kDrive,
+    ParamID::kSweepDepth, ParamID::kSweepRate,   kDeckBandIds[1][0],    kDeckBandIds[1][1],
+    kDeckBandIds[1][2],   kDeckBandIds[2][0],    kDeckBandIds[2][1],    kDeckBandIds[2][2],
+    kDeckBandIds[3][0],   kDeckBandIds[3][1],    kDeckBandIds[3][2]};
+
+// MIDI-learn map from control change messages to parameters.
+//
+// Assignments are kept in a preallocated table with one atomic byte per channel and
+// controller, so the audio thread resolves a CC with a single load and never locks or
+// allocates. The table is only written from one thread at a time, normally the message
+// thread.
+//
+// Controllers 0-31 can be assigned as 14-bit pairs, as in the MIDI spec: the controller
+// carries the 7 most significant bits and controller + 32 the 7 least. A new MSB resets
+// the LSB, so a controller that only sends MSBs still works, at 7-bit resolution.
+//
+// Learning spans both threads: the message thread arms it for a target, the audio
+// thread records the first controller that moves (and its LSB partner, if that follows
+// in the same block), and the message thread assigns it with commitLearned().
+class MidiCcMap {
+public:
+    static constexpr int kNumTargets = static_cast<int>(kMidiTargets.size());
+    static constexpr int kNumChannels = 16;
+    static constexpr int kNumControllers = 128;
+
+    // Target index of a parameter, or kNumTargets if it cannot be assigned
+    static constexpr int targetFor(std::string_view paramId) {
+        for (size_t target = 0; target < kMidiTargets.size(); ++target)
+            if (paramId == kMidiTargets[target]) return static_cast<int>(target);
+        return kNumTargets;
+    }
+
+    struct Assignment {
+        int channel = 1;  // 1-16
+        int controller = 0;
+        bool highResolution = false;  // 14-bit pair with controller + 32
+
+        bool operator==(const Assignment&) const = default;
+    };
+
+    // A mapped controller's new value, normalised to 0-1 for the target's parameter
+    struct Change {
+        int target = 0;
+        float value = 0.0f;
+    };
+
+    // Message thread. Assigning a controller takes it, and its LSB partner for a 14-bit
+    // pair, away from any other target.
+    void assign(int target, const Assignment& assignment);
+    void clear(int target);
+    void clearAll();
+    std::optional<Assignment> getAssignment(int target) const {
+        return assignments_[index(target)];
+    }
+
+    // Message thread. Learning replaces the target's assignment with the next controller
+    // received; stopLearning() cancels it.
+    void startLearning(int target);
+    void stopLearning();
+    int getLearningTarget() const { return learningTarget_.load(); }
+
+    // Message thread. Assigns a controller the audio thread has learned, if any; true if
+    // the map changed.
+    bool commitLearned();
+
+    // Audio thread. While learning this only records the controller; true once one is
+    // waiting for commitLearned().
+    std::optional<Change> handleController(int channel, int controller, int value);
+    bool hasLearned() const { return learned_.load(std::memory_order_relaxed) != 0; }
+
+    // Stores the assignments as a kStateTag child of state, or restores them from one. A
+    // state without one (older sessions) clears the map. Kept for XML states saved before
+    // the binary format.
+    static constexpr const char* kStateTag = "MidiCc";
+    void saveTo(juce::XmlElement& state) const;
+    void loadFrom(const juce::XmlElement& state);
+
+    // Binary form, the payload of a kChunkTag chunk of the binary state: a count byte,
+    // then per assignment the target's parameter ID and channel, controller and
+    // high-resolution bytes. Reading replaces the whole map and skips what it can't use.
+    static constexpr uint32_t kChunkTag = chunkTag("MIDI");
+    void writeTo(juce::OutputStream& stream) const;
+    void readFrom(juce::InputStream& stream);
+
+private:
+    // Table entries: 0 for none, else target + 1, with kHighResolutionFlag for the MSB
+    // controller of a 14-bit pair
+    static constexpr uint8_t kHighResolutionFlag = 0x80;
+    static constexpr int kNumHighResolutionPairs = 32;
+
+    static size_t index(int target) { return static_cast<size_t>(target); }
+    static size_t slot(int channel, int controller) {
+        return static_cast<size_t>((channel - 1) * kNumControllers + controller);
+    }
+    static size_t msbSlot(int channel, int controller) {
+        return static_cast<size_t>((channel - 1) * kNumHighResolutionPairs + controller);
+    }
+
+    void learn(int channel, int controller);
+    void removeSlot(int channel, int controller);
+
+    std::array<std::atomic<uint8_t>, kNumChannels * kNumControllers> table_{};
+    std::array<std::optional<Assignment>, kNumTargets> assignments_;
+
+    // Learning: target being learned (-1 for none) and the controller recorded for it,
+    // packed as (1 << 16) | (highResolution << 15) | (channel << 8) | controller
+    std::atomic<int> learningTarget_{-1};
+    std::atomic<uint32_t> learned_{0};
+
+    // Audio thread: last MSB of every 14-bit capable controller, per channel
+    std::array<uint8_t, kNumChannels * kNumHighResolutionPairs> msb_{};
+};
+
+}  // namespace audio_plugin
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
@@ -30,35 +32,23 @@ public:
         setColour(juce::PopupMenu::highlightedTextColourId, juce::Colours::white);
     }
 
+    // Draws a pre-rendered sprite: background and cap composited at the nearest of
+    // kNumSpriteFrames angles, rendered at device resolution so the blit is never
+    // resampled. Frames are made the first time they are shown.
     void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height,
                           float sliderPosProportional, float /*rotaryStartAngle*/,
                           float /*rotaryEndAngle*/, juce::Slider& /*slider*/) override {
-        auto bounds = juce::Rectangle<int>(x, y, width, height).toFloat();
-        auto side = juce::jmin(bounds.getWidth(), bounds.getHeight());
-        auto knobBounds = bounds.withSizeKeepingCentre(side, side);
-
-        // Draw static background (ticks + base)
-        if (knobBg_.isValid()) {
-            g.drawImage(knobBg_, knobBounds,
-                        juce::RectanglePlacement::centred);
-        }
+        const auto bounds = juce::Rectangle<int>(x, y, width, height);
+        const int side = juce::jmin(width, height);
+        const auto knobBounds = bounds.withSizeKeepingCentre(side, side);
 
-        // Rotation: 270-degree sweep from -135 to +135 degrees
-        constexpr float kStartAngle = -135.0f * (juce::MathConstants<float>::pi / 180.0f);
-        constexpr float kEndAngle = 135.0f * (juce::MathConstants<float>::pi / 180.0f);
-        float angle = kStartAngle + sliderPosProportional * (kEndAngle - kStartAngle);
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const int pixels = juce::roundToInt(static_cast<float>(side) * scale);
+        if (pixels <= 0) return;
 
-        // Draw rotating cap
-        if (knobCap_.isValid()) {
-            auto cx = knobBounds.getCentreX();
-            auto cy = knobBounds.getCentreY();
-
-            g.saveState();
-            g.addTransform(juce::AffineTransform::rotation(angle, cx, cy));
-            g.drawImage(knobCap_, knobBounds,
-                        juce::RectanglePlacement::centred);
-            g.restoreState();
-        }
+        const int frame = juce::roundToInt(juce::jlimit(0.0f, 1.0f, sliderPosProportional)
+                                           * static_cast<float>(kNumSpriteFrames - 1));
+        g.drawImage(getSpriteFrame(pixels, frame), knobBounds.toFloat());
     }
 
     void drawLabel(juce::Graphics& g, juce::Label& label) override {
@@ -68,10 +58,63 @@ public:
                    label.getJustificationType(), true);
     }
 
+    // Sprite frames across the 270-degree sweep, about 2 degrees apart
+    static constexpr int kNumSpriteFrames = 128;
+
 private:
+    // Rotation: 270-degree sweep from -135 to +135 degrees
+    static constexpr float kStartAngle = -135.0f * (juce::MathConstants<float>::pi / 180.0f);
+    static constexpr float kEndAngle = 135.0f * (juce::MathConstants<float>::pi / 180.0f);
+
+    const juce::Image& getSpriteFrame(int pixels, int frame) {
+        // Every knob in the editor has the same size, so one cache is enough; a resize
+        // or a move to a screen with another scale starts a new one.
+        if (spritePixels_ != pixels) {
+            spritePixels_ = pixels;
+            spriteBg_ = juce::Image();
+            sprites_.assign(static_cast<size_t>(kNumSpriteFrames), juce::Image());
+        }
+
+        auto& sprite = sprites_[static_cast<size_t>(frame)];
+        if (!sprite.isValid()) sprite = renderSpriteFrame(frame);
+        return sprite;
+    }
+
+    juce::Image renderSpriteFrame(int frame) {
+        const auto area = juce::Rectangle<int>(spritePixels_, spritePixels_).toFloat();
+
+        // The background is resampled once per size and copied into every frame
+        if (!spriteBg_.isValid()) {
+            spriteBg_ = juce::Image(juce::Image::ARGB, spritePixels_, spritePixels_, true);
+            juce::Graphics g(spriteBg_);
+            g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+            if (knobBg_.isValid()) g.drawImage(knobBg_, area, juce::RectanglePlacement::centred);
+        }
+
+        juce::Image sprite(juce::Image::ARGB, spritePixels_, spritePixels_, true);
+        juce::Graphics g(sprite);
+        g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+        g.drawImageAt(spriteBg_, 0, 0);
+
+        if (knobCap_.isValid()) {
+            const float proportion =
+                static_cast<float>(frame) / static_cast<float>(kNumSpriteFrames - 1);
+            const float angle = kStartAngle + proportion * (kEndAngle - kStartAngle);
+            g.addTransform(juce::AffineTransform::rotation(angle, area.getCentreX(),
+                                                           area.getCentreY()));
+            g.drawImage(knobCap_, area, juce::RectanglePlacement::centred);
+        }
+        return sprite;
+    }
+
     juce::Image knobBg_;
     juce::Image knobCap_;
 
+    // Sprite cache for knobs spritePixels_ device pixels across
+    int spritePixels_ = 0;
+    juce::Image spriteBg_;
+    std::vector<juce::Image> sprites_;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MoogKnobLookAndFeel)
 };
 
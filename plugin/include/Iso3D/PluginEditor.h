@@ -1,16 +1,45 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <functional>
 
 #include <juce_audio_processors/juce_audio_processors.h>
 
 #include "Constants.h"
 #include "MoogKnobLookAndFeel.h"
 #include "PluginProcessor.h"
+#include "SpectrumAnalyzer.h"
 
 namespace audio_plugin {
 
-class NotchedSlider : public juce::Slider {
+// Slider that hands popup-menu clicks (right-click, or ctrl-click on macOS) to
+// onContextMenu instead of treating them as the start of a drag.
+class ContextMenuSlider : public juce::Slider {
+public:
+    std::function<void()> onContextMenu;
+
+    void mouseDown(const juce::MouseEvent& e) override {
+        contextClick_ = e.mods.isPopupMenu() && onContextMenu != nullptr;
+        if (contextClick_)
+            onContextMenu();
+        else
+            juce::Slider::mouseDown(e);
+    }
+
+    void mouseDrag(const juce::MouseEvent& e) override {
+        if (!contextClick_) juce::Slider::mouseDrag(e);
+    }
+
+    void mouseUp(const juce::MouseEvent& e) override {
+        if (!contextClick_) juce::Slider::mouseUp(e);
+    }
+
+private:
+    bool contextClick_ = false;
+};
+
+class NotchedSlider : public ContextMenuSlider {
 public:
     double snapValue(double attemptedValue, DragMode) override {
         if (std::abs(attemptedValue) <= static_cast<double>(kUnityDeadZoneDb))
@@ -19,7 +48,7 @@ public:
     }
 };
 
-class BoostSelectorSlider : public juce::Slider {
+class BoostSelectorSlider : public ContextMenuSlider {
 public:
     enum ColourIds {
         titleTextColourId = 0x2801000,
@@ -255,15 +284,202 @@ private:
     }
 };
 
-class AudioPluginAudioProcessorEditor : public juce::AudioProcessorEditor {
+// Vertical level meter for one band. A dim bar shows the RMS the band carries before
+// its gain, a bright bar the RMS that gets through, and a line the held output peak, so
+// a killed band still shows how much it removes. Levels are set in dB by the editor.
+class BandLevelMeter : public juce::Component {
+public:
+    enum ColourIds {
+        backgroundColourId = 0x2802000,
+        outlineColourId,
+        bandLevelColourId,
+        outputLevelColourId,
+        peakColourId
+    };
+
+    BandLevelMeter() {
+        setColour(backgroundColourId, juce::Colour(0xff0b0d10));
+        setColour(outlineColourId, juce::Colour(0xff55585c));
+        setColour(bandLevelColourId, juce::Colour(0xff3a4a3c));
+        setColour(outputLevelColourId, juce::Colour(0xff7fd46b));
+        setColour(peakColourId, juce::Colour(0xffe5e5e5));
+    }
+
+    void setLevels(float bandRmsDb, float outputRmsDb, float outputPeakDb) {
+        bandRmsDb_ = bandRmsDb;
+        outputRmsDb_ = outputRmsDb;
+        outputPeakDb_ = outputPeakDb;
+        repaint();
+    }
+
+    void paint(juce::Graphics& g) override {
+        const auto bounds = getLocalBounds().toFloat();
+        g.setColour(findColour(backgroundColourId));
+        g.fillRoundedRectangle(bounds, kCornerRadius);
+
+        const auto inner = bounds.reduced(kBarInset);
+        auto barFor = [&inner](float db) {
+            return inner.withTop(inner.getBottom() - inner.getHeight() * dbToProportion(db));
+        };
+        g.setColour(findColour(bandLevelColourId));
+        g.fillRect(barFor(bandRmsDb_));
+        g.setColour(findColour(outputLevelColourId));
+        g.fillRect(barFor(outputRmsDb_));
+
+        if (outputPeakDb_ > kMinDb) {
+            g.setColour(findColour(peakColourId));
+            g.fillRect(barFor(outputPeakDb_).withHeight(kPeakLineHeight));
+        }
+
+        g.setColour(findColour(outlineColourId));
+        g.drawRoundedRectangle(bounds, kCornerRadius, kOutlineThickness);
+    }
+
+    static constexpr float kMinDb = -60.0f;
+    static constexpr float kMaxDb = 12.0f;  // top of the scale, the most a band can boost
+
+private:
+    static constexpr float kCornerRadius = 2.0f;
+    static constexpr float kBarInset = 1.5f;
+    static constexpr float kPeakLineHeight = 1.5f;
+    static constexpr float kOutlineThickness = 1.0f;
+
+    static float dbToProportion(float db) {
+        return juce::jlimit(0.0f, 1.0f, (db - kMinDb) / (kMaxDb - kMinDb));
+    }
+
+    float bandRmsDb_ = kMinDb;
+    float outputRmsDb_ = kMinDb;
+    float outputPeakDb_ = kMinDb;
+};
+
+// Input and per-band spectra from a SpectrumAnalyzer, over a grid of decades and 24 dB
+// steps. The analyzer builds the paths across the unit square, so a repaint only scales
+// and strokes them.
+class SpectrumView : public juce::Component {
+public:
+    enum ColourIds {
+        backgroundColourId = 0x2803000,
+        outlineColourId,
+        gridColourId,
+        inputColourId,
+        lowBandColourId,
+        midBandColourId,
+        highBandColourId
+    };
+
+    SpectrumView() {
+        setColour(backgroundColourId, juce::Colour(0xff0b0d10));
+        setColour(outlineColourId, juce::Colour(0xff55585c));
+        setColour(gridColourId, juce::Colour(0xff25282c));
+        setColour(inputColourId, juce::Colour(0xff6f7378));
+        setColour(lowBandColourId, juce::Colour(0xffd4a26b));
+        setColour(midBandColourId, juce::Colour(0xff7fd46b));
+        setColour(highBandColourId, juce::Colour(0xff6bb4d4));
+        setInterceptsMouseClicks(false, false);
+    }
+
+    // Message thread. Takes the analyzer's newest paths, if it has published any.
+    void update(SpectrumAnalyzer& analyzer) {
+        if (analyzer.pullPaths(paths_)) repaint();
+    }
+
+    void paint(juce::Graphics& g) override {
+        const auto bounds = getLocalBounds().toFloat();
+        g.setColour(findColour(backgroundColourId));
+        g.fillRoundedRectangle(bounds, kCornerRadius);
+
+        const auto inner = bounds.reduced(kInset);
+        g.setColour(findColour(gridColourId));
+        for (float hz = 100.0f; hz < SpectrumAnalyzer::kMaxHz; hz *= 10.0f) {
+            const float x = inner.getX() + inner.getWidth() * hzToProportion(hz);
+            g.drawVerticalLine(juce::roundToInt(x), inner.getY(), inner.getBottom());
+        }
+        for (float db = 0.0f; db > SpectrumAnalyzer::kMinDb; db -= kGridStepDb) {
+            const float y = inner.getY() + inner.getHeight() * dbToProportion(db);
+            g.drawHorizontalLine(juce::roundToInt(y), inner.getX(), inner.getRight());
+        }
+
+        // The input behind the bands
+        const auto toBounds = juce::AffineTransform::scale(inner.getWidth(), inner.getHeight())
+                                  .translated(inner.getX(), inner.getY());
+        const std::array<int, kNumSpectrumTraces> colours = {
+            inputColourId, lowBandColourId, midBandColourId, highBandColourId};
+        for (size_t trace = 0; trace < kNumSpectrumTraces; ++trace) {
+            g.setColour(findColour(colours[trace]));
+            g.strokePath(paths_[trace], juce::PathStrokeType(kStrokeThickness), toBounds);
+        }
+
+        g.setColour(findColour(outlineColourId));
+        g.drawRoundedRectangle(bounds, kCornerRadius, kOutlineThickness);
+    }
+
+private:
+    static constexpr float kCornerRadius = 2.0f;
+    static constexpr float kInset = 2.0f;
+    static constexpr float kGridStepDb = 24.0f;
+    static constexpr float kStrokeThickness = 1.25f;
+    static constexpr float kOutlineThickness = 1.0f;
+
+    static float hzToProportion(float hz) {
+        return std::log(hz / SpectrumAnalyzer::kMinHz)
+            / std::log(SpectrumAnalyzer::kMaxHz / SpectrumAnalyzer::kMinHz);
+    }
+
+    static float dbToProportion(float db) {
+        constexpr float kRangeDb = SpectrumAnalyzer::kMaxDb - SpectrumAnalyzer::kMinDb;
+        return (SpectrumAnalyzer::kMaxDb - db) / kRangeDb;
+    }
+
+    SpectrumAnalyzer::Paths paths_;
+};
+
+class AudioPluginAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer {
 public:
     explicit AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor&);
     ~AudioPluginAudioProcessorEditor() override;
 
     void paint(juce::Graphics&) override;
+    void paintOverChildren(juce::Graphics&) override;
     void resized() override;
 
+    // Clicking the DSP load readout starts its figures over; right-clicking it picks the
+    // number of worker threads
+    void mouseDown(const juce::MouseEvent& e) override;
+
+    // Time spent in editor repaints, from paint() to paintOverChildren() so children are
+    // included, over the last full second. Logged every second when built with
+    // ISO3D_PAINT_TIMING.
+    struct PaintStats {
+        int numPaints = 0;
+        double meanMs = 0.0;
+        double maxMs = 0.0;
+    };
+    PaintStats getPaintStats() const { return paintStats_; }
+
+    // Time the spectrum analyzer's thread spends on a frame, over the last full second.
+    // Logged along with the paint times.
+    SpectrumAnalyzer::FrameStats getSpectrumFrameStats() const {
+        return analyzer_.getFrameStats();
+    }
+
 private:
+    // Drains the processor's meter queue and redraws the meters, and takes the newest
+    // spectra, at a fixed frame rate. Also rolls the paint timing over and refreshes the
+    // DSP load once a second.
+    void timerCallback() override;
+    void publishPaintStats();
+    void updateLoadLabel();
+
+    // Worker thread menu of the DSP load readout
+    void showWorkerMenu();
+
+    // MIDI learn menu for the control of one MidiCcMap target
+    void showMidiMenu(juce::Component& control, int target);
+
+    // Attaches the band knobs and meters to a deck's band gains
+    void selectDeck(int deck);
+
     AudioPluginAudioProcessor& processorRef_;
     MoogKnobLookAndFeel moogLookAndFeel_;
 
@@ -272,6 +488,32 @@ private:
     NotchedSlider highSlider_;
     BoostSelectorSlider boostSlider_;
 
+    std::array<BandLevelMeter, kNumBands> meters_;
+
+    // Spectra of the metered deck, analysed only while the editor is open
+    SpectrumAnalyzer analyzer_;
+    SpectrumView spectrumView_;
+
+    // Multi-deck builds: the deck the band knobs show, picked with these buttons
+    std::array<juce::TextButton, kMaxDecks> deckButtons_;
+    int deck_ = 0;
+
+    // Processor load: average, worst block and overruns, from AudioPluginAudioProcessor
+    juce::Label loadLabel_;
+
+    // Meter ballistics, per band: smoothed RMS (linear) and held output peak (dB)
+    std::array<float, kNumBands> bandRms_{};
+    std::array<float, kNumBands> outputRms_{};
+    std::array<float, kNumBands> outputPeakDb_{};
+
+    // Paint timing: the paint in progress and the second being gathered
+    juce::int64 paintStartTicks_ = 0;
+    int paintCount_ = 0;
+    double paintTotalMs_ = 0.0;
+    double paintMaxMs_ = 0.0;
+    int framesSincePublish_ = 0;
+    PaintStats paintStats_;
+
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lowAttachment_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> midAttachment_;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> highAttachment_;
@@ -1,21 +1,48 @@
 #pragma once
 
+#include <mutex>
+
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#include "BandMeter.h"
 #include "Constants.h"
 #include "Crossover.h"
+#include "CrossoverSweep.h"
+#include "CrossoverTuner.h"
+#include "DoubleBuffer.h"
+#include "Drive.h"
+#include "FusedCrossover.h"
+#include "GainSmoother.h"
+#include "LinearPhaseCrossover.h"
+#include "LoadProfiler.h"
+#include "MidiCcMap.h"
+#include "Scenes.h"
+#include "SpectrumAnalyzer.h"
+#include "SpscFifo.h"
+#include "WorkerPool.h"
 
 namespace audio_plugin {
 
-class AudioPluginAudioProcessor : public juce::AudioProcessor {
+// With numDecks above 1 the processor is a multi-deck isolator for a DJ mixer: one stereo
+// input and output bus per deck, each deck with its own band gains (kDeckBandIds), and the
+// boost, split points and mode shared. All decks' channels go through one crossover, which
+// packs four channels per SIMD register, so every two decks share a register pass. The
+// plugin is built with ISO3D_NUM_DECKS decks.
+class AudioPluginAudioProcessor : public juce::AudioProcessor, private juce::Timer {
 public:
-    AudioPluginAudioProcessor();
+    explicit AudioPluginAudioProcessor(int numDecks = 1);
     ~AudioPluginAudioProcessor() override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    // Hosts that switch between realtime and offline without preparing again move the
+    // split point tuning to or from the audio thread here
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -32,32 +59,353 @@ public:
     const juce::String getProgramName(int index) override;
     void changeProgramName(int index, const juce::String& newName) override;
 
+    // Saves the binary state (see BinaryState). Restoring also takes the XML states saved
+    // by earlier versions.
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts_; }
 
+    int getNumDecks() const { return numDecks_; }
+
+    // Per-band metering for the editor. Off by default, so headless use does not pay for
+    // it; while on, unity gain also runs through the bands so there is something to meter.
+    void setMeteringEnabled(bool enabled) { meteringEnabled_.store(enabled); }
+
+    // Deck whose bands are metered, in a multi-deck build
+    void setMeteredDeck(int deck) { meteredDeck_.store(juce::jlimit(0, numDecks_ - 1, deck)); }
+
+    // Consumer side of the meter queue: pops the oldest window of band levels.
+    bool popBandLevels(BandLevels& out) { return meterQueue_.pop(out); }
+
+    // Samples for the editor's spectrum analyzer: the metered deck's input and each of
+    // its bands after the gain, mixed to mono. Off by default, like metering, and unity
+    // gain also runs through the bands while on.
+    void setAnalyzerEnabled(bool enabled) { analyzerEnabled_.store(enabled); }
+    SpectrumRing& getSpectrumRing() { return spectrumRing_; }
+
+    // MIDI-learn assignments of controllers to parameters, applied in processBlock
+    MidiCcMap& getMidiCcMap() { return midiCcMap_; }
+
+    // Cost of every processBlock call against its real-time budget since prepareToPlay()
+    // or the last reset. Not saved with the state.
+    LoadStats getLoadStats() const { return loadProfiler_.getStats(); }
+    void resetLoadStats() { loadProfiler_.reset(); }
+
+    // The same figures as a binary state block of their own (the state's header and one
+    // LoadStats::kChunkTag chunk), for hosts and tools that read state blocks. Separate
+    // from getStateInformation(), so playing never marks a session as edited.
+    void getLoadStatsInformation(juce::MemoryBlock& destData) const;
+
+    // Opt-in parallel processing for wide layouts: the IIR crossover and gain stage of
+    // each SIMD register's channels (four channels, or two in double precision) become
+    // tasks shared between the audio thread and this many real-time worker threads (0 to
+    // getMaxWorkerThreads(), 0 by default). Chunks shorter than kMinParallelSamples,
+    // layouts of a single register and the linear-phase mode run on the audio thread
+    // alone, as does everything if the system refuses the workers real-time scheduling.
+    // Saved with the state, which only stores the count: the workers start on the next
+    // timer tick or prepareToPlay(). Message thread.
+    void setNumWorkerThreads(int numWorkers);
+    int getNumWorkerThreads() const { return numWorkerThreads_.load(); }
+    int getNumRunningWorkerThreads() const { return workerPool_.getNumWorkers(); }
+
+    // One fewer than the machine's cores, leaving one to the audio thread, up to
+    // kMaxWorkerThreads
+    static int getMaxWorkerThreads();
+
+    // True while silent input passes through without being processed
+    bool isIdle() const { return idle_.load(std::memory_order_relaxed); }
+
+    // Scenes: stored band gains and boost, recalled at once or morphed in over a time.
+    // MIDI program change n recalls scene n at the message's sample position, with the
+    // scene's own morph time; recallScene() recalls at the start of the next block. A
+    // recall sets the parameters to the scene without going through the host first, as
+    // mapped MIDI controllers do. Multi-deck builds recall onto one deck, the deck
+    // numbered by the program change's MIDI channel. Message thread.
+    const Scene& getScene(int index) const { return scenes_[index]; }
+    void storeScene(int index, const Scene& scene);
+
+    // A deck's band gains and the boost as they stand, as a scene with the given morph time
+    Scene captureScene(float morphTimeSec = 0.0f, int deck = 0) const;
+
+    // False, recalling nothing, if the audio thread has not taken the last few recalls
+    bool recallScene(int index) { return recallScene(index, scenes_[index].morphTimeSec); }
+    bool recallScene(int index, float morphTimeSec, int deck = 0);
+
 private:
-    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    static BusesProperties createBusesProperties();
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(int numDecks);
+    static BusesProperties createBusesProperties(int numDecks);
+
+    // DSP state for one sample type. Only the instance matching the host's processing
+    // precision is prepared; the other stays empty.
+    template <typename SampleType>
+    struct Dsp {
+        // The gain stage of one deck: its channels (every channel in a single-deck build),
+        // smoothed band gains and scene morph
+        struct Deck {
+            int firstChannel = 0;
+            int numChannels = 0;
+
+            // Smoothed band gains (linear), indexed low/mid/high, and whether they held
+            // steady over the last chunk
+            GainSmoother<SampleType> gainSmoother;
+            bool gainsSteady = true;
+
+            // Morph from the gains in effect at the last scene recall to the parameters
+            SceneMorph sceneMorph;
+        };
+
+        void prepare(double sampleRate, int samplesPerBlock, int numChannels, int deckCount,
+                     const CrossoverTuner::Frequencies& frequencies, bool useLinearPhase);
+
+        // Runs one chunk through engine (crossover or linearPhase) into output: straight
+        // through the summed path when unity is set, else through the bands and each
+        // deck's gains, which advanceGains() has set for the chunk.
+        template <typename Engine>
+        void render(Engine& engine, SampleType* const* input, SampleType* const* output,
+                    int numChannels, int numSamples, bool unity);
+
+        // render() with the IIR crossover in place, one channel group of the crossover
+        // and its gains at a time (of fused instead while it runs): each a task of the
+        // worker pool on chunks of kMinParallelSamples or more, else in turn on the audio
+        // thread. A group whose input and filter state are both below kSilenceThreshold
+        // passes through untouched with silent bands, so a wide layout only filters the
+        // channels playing.
+        void renderGroups(WorkerPool& pool, SampleType* const* channels, int numChannels,
+                          int numSamples, bool unity);
+
+        // Picks how the IIR crossover runs the next chunk, in steady IIR mode on settled
+        // split points: at unity through its allpass sum (Crossover::setAllpassSum()),
+        // else through fused when nothing reads the bands (bandsRead), unless fused is
+        // folded and the crossover would run along time, where the crossover is faster.
+        // Elsewhere the crossover runs its full network. Filter state follows the engine
+        // in use.
+        void updateIirEngine(bool unity, bool bandsRead, int numChannels, int numSamples);
+
+        // Each deck's gains over the band buffers into output, for channels
+        // [firstChannel, endChannel)
+        void applyGains(SampleType* const* output, int firstChannel, int endChannel,
+                        int numSamples);
+
+        // Samples, up to maxSamples, before any deck's scene morph next changes its values
+        int getStepSamples(int maxSamples) const;
+
+        // Moves every deck's gains on by a chunk of numSamples, towards the parameter
+        // values as their scene morphs have them. Returns true if all decks hold unity.
+        bool advanceGains(const std::array<SceneMorph::Values, kMaxDecks>& parameters,
+                          int numSamples);
+
+        // Moves the split point sweep on by a chunk of numSamples and has the crossover
+        // follow it. Once the sweep stops, the crossover glides back to
+        // staticCoefficients.
+        void advanceSweep(const CrossoverSweep::Frequencies& frequencies, float depthOctaves,
+                          float rateHz, int numSamples);
+
+        // Starts running the other engine from a clean state. The outgoing one keeps
+        // running until the crossfade into the new mode has finished.
+        void beginModeSwitch(bool useLinearPhase);
+        bool isSwitchingMode() const { return modeSwitchPosition >= 0; }
+
+        int getLatencySamples() const {
+            return linearPhaseMode ? linearPhase.getLatencySamples() : 0;
+        }
+
+        // Checks a block's input before it is processed. Returns true if it can pass
+        // through untouched: every channel's input is below kSilenceThreshold, and so is
+        // the memory of the engine in use (the IIR state, or the FIR's span of past
+        // input) and of the drive stage. Entering idle clears that memory, so processing
+        // resumes from rest.
+        bool updateIdle(const juce::AudioBuffer<SampleType>& buffer, int numChannels,
+                        bool modeChangeRequested);
+
+        // Band buffers as the engines fill them
+        typename Crossover<SampleType>::Bands getBands();
+
+        Crossover<SampleType> crossover;
+        LinearPhaseCrossover<SampleType> linearPhase;
+
+        // The IIR crossover and the gains as one system, holding the filter state while
+        // fusedActive. Its coefficients are brought up to staticCoefficients as it takes
+        // over, and each channel's gains for the chunk are in fusedGains.
+        FusedCrossover<SampleType> fused;
+        bool fusedActive = false;
+        bool fusedCoefficientsStale = false;
+        std::array<typename FusedCrossover<SampleType>::ChannelGains, kMaxChannels> fusedGains{};
+
+        // Coefficients of the split points as the parameters set them, which the crossover
+        // glides to whenever it isn't being swept
+        CrossoverCoefficients<> staticCoefficients;
+        CrossoverSweep sweep;
+        bool sweeping = false;
+
+        // Per-band scratch, kNumBands * (prepared channel count) channels of samplesPerBlock
+        juce::AudioBuffer<SampleType> bandBuffer;
+
+        // Output of the outgoing engine during a mode switch, one channel per channel
+        juce::AudioBuffer<SampleType> fadeBuffer;
+
+        // Mode being run, or faded into while switching. The incoming engine is muted
+        // for modeWarmupSamples, until its output no longer depends on the reset, then
+        // ramps in over modeCrossfadeSamples.
+        bool linearPhaseMode = false;
+        int modeSwitchPosition = -1;  // samples since the switch began, -1 if none
+        int modeWarmupSamples = 0;
+        int modeCrossfadeSamples = 1;
+
+        std::array<Deck, kMaxDecks> decks;
+        int numDecks = 1;
+
+        // Saturation of every channel after the gains, off until the drive goes up
+        DriveStage<SampleType> drive;
+
+        BandMeter<SampleType> bandMeter;
+
+        // Idle bypass: samples since any channel's input last reached kSilenceThreshold
+        // (counted up to the linear-phase warmup), and whether blocks are passing through
+        int silentSamples = 0;
+        bool idle = false;
+
+        // Crossover groups renderGroups() passed through last time, their state cleared
+        std::array<bool, kMaxChannels> idleGroups{};
+    };
+
+    template <typename SampleType>
+    Dsp<SampleType>& getDsp();
+
+    // Shared body of both processBlock() overloads
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages);
+
+    // Renders numSamples of the block from offset, with the parameters as they stand
+    template <typename SampleType>
+    void processSegment(Dsp<SampleType>& dsp, SampleType* const* channelData, int numChannels,
+                        int offset, int numSamples);
+
+    // Feeds the chunk's band buffers to the band meter and queues finished windows
+    template <typename SampleType>
+    void meter(Dsp<SampleType>& dsp, int numChannels, int numSamples, bool metering);
+
+    // Writes the metered deck's chunk of input to the spectrum ring, before it renders,
+    // then its bands once it has and publishes the chunk
+    template <typename SampleType>
+    void captureInput(const Dsp<SampleType>& dsp, const SampleType* const* channels,
+                      int numChannels, int numSamples);
+    template <typename SampleType>
+    void captureBands(Dsp<SampleType>& dsp, int numChannels, int numSamples);
+
+    // A deck's band gains and the boost ceiling as the parameters have them, in dB
+    SceneMorph::Values readGainParameters(int deck) const;
+
+    // Audio thread. Starts morphing the deck from the values in effect to scene, and sets
+    // its parameters to it.
+    template <typename SampleType>
+    void recall(Dsp<SampleType>& dsp, const Scene& scene, float morphTimeSec, int deck);
+
+    // Message thread. Hands the scenes to the audio thread, or leaves that to
+    // timerCallback() if it has not taken the last bank yet.
+    void publishScenes() { scenesPending_ = !sceneBankBuffer_.push(scenes_); }
+
+    // Restores a state that passes BinaryStateReader::canRead(), and one in the XML
+    // format used before it
+    void setBinaryState(const void* data, size_t size);
+    void setXmlState(const void* data, int sizeInBytes);
+
+    // Message thread side of what the audio thread changes: reports its latency, passes
+    // MIDI controller values on to their parameters and assigns a learned controller.
+    // Polled, so the audio thread only ever writes atomics. Also starts the worker count
+    // a restored state asked for.
+    void timerCallback() override;
+
+    // Restarts the worker pool if it is prepared and numWorkerThreads_ has changed since
+    // it last started
+    void applyNumWorkerThreads();
+
+    // Current value of a MIDI target's parameter (denormalised), including a controller
+    // change the message thread has not passed on to the parameter yet
+    float readParameter(int target, const std::atomic<float>& value) const;
+
+    const int numDecks_;
 
     juce::AudioProcessorValueTreeState apvts_;
 
-    Crossover crossover_;
+    Dsp<float> floatDsp_;
+    Dsp<double> doubleDsp_;
 
-    // Parameter pointers for lock-free access in audio thread
-    std::atomic<float>* lowParam_ = nullptr;
-    std::atomic<float>* midParam_ = nullptr;
-    std::atomic<float>* highParam_ = nullptr;
-    std::atomic<float>* boostParam_ = nullptr;
+    // Crossover frequency parameters -> coefficients and kernels, off the audio thread
+    CrossoverTuner crossoverTuner_;
+
+    // Latency of the mode the audio thread switched to, for timerCallback()
+    std::atomic<int> latencySamples_{0};
+
+    // How long the output can go on after the input stops, set at prepareToPlay()
+    std::atomic<double> tailLengthSeconds_{0.0};
 
-    // Smoothed gain values (linear)
-    float smoothedLowGain_ = 1.0f;
-    float smoothedMidGain_ = 1.0f;
-    float smoothedHighGain_ = 1.0f;
+    // Whether the last block was passed through idle
+    std::atomic<bool> idle_{false};
 
-    // Smoothing coefficient, computed in prepareToPlay
-    float smoothAlpha_ = 1.0f;
+    // Finished meter windows, audio thread -> editor. Windows that find it full are
+    // dropped; at 100 windows a second it holds well over half a second.
+    static constexpr size_t kMeterQueueSize = 64;
+    std::atomic<bool> meteringEnabled_{false};
+    std::atomic<int> meteredDeck_{0};
+    SpscFifo<BandLevels, kMeterQueueSize> meterQueue_;
+
+    // Spectrum analyzer samples, audio thread -> editor. Chunks that find it full are
+    // dropped.
+    std::atomic<bool> analyzerEnabled_{false};
+    SpectrumRing spectrumRing_;
+
+    LoadProfiler loadProfiler_;
+
+    // Worker threads asked for, and the pool running them between prepareToPlay() and
+    // releaseResources(). Starting and stopping the pool, which hosts may do from
+    // different threads, holds workerPoolMutex_, as do the count it started with and
+    // prepared_ changing.
+    std::atomic<int> numWorkerThreads_{0};
+    std::atomic<bool> prepared_{false};
+    std::mutex workerPoolMutex_;
+    int startedWorkerThreads_ = 0;
+    WorkerPool workerPool_;
+
+    // Scenes as the message thread keeps them, and the audio thread's copy, which it
+    // takes from sceneBankBuffer_ at the start of every block. Recalls made through
+    // recallScene() wait in sceneRecalls_, with the scene as it was when recalled.
+    struct SceneRecall {
+        Scene scene;
+        float morphTimeSec = 0.0f;
+        int deck = 0;
+    };
+    static constexpr size_t kSceneRecallQueueSize = 16;
+    SceneBank scenes_;
+    SceneBank audioScenes_;
+    DoubleBuffer<SceneBank> sceneBankBuffer_;
+    bool scenesPending_ = false;
+    SpscFifo<SceneRecall, kSceneRecallQueueSize> sceneRecalls_;
+
+    // MIDI controllers -> parameters, with the parameter of every target (null for the
+    // decks a build doesn't have). midiValues_ holds the last controller value
+    // (normalised) per target until timerCallback() has set the parameter to it, or
+    // kNoMidiValue.
+    static constexpr float kNoMidiValue = -1.0f;
+    MidiCcMap midiCcMap_;
+    std::array<juce::RangedAudioParameter*, MidiCcMap::kNumTargets> midiTargets_{};
+    std::array<std::atomic<float>, MidiCcMap::kNumTargets> midiValues_;
+
+    // Every parameter, in kParameterIds order followed by the band gains of decks 2 and
+    // up, for saving and restoring state. Null for the decks a build doesn't have.
+    static constexpr size_t kMaxParameters =
+        kParameterIds.size() + (kMaxDecks - 1) * kNumBands;
+    std::array<juce::RangedAudioParameter*, kMaxParameters> parameters_{};
+
+    // Parameter pointers for lock-free access in audio thread, band gains per deck
+    std::array<std::array<std::atomic<float>*, kNumBands>, kMaxDecks> bandParams_{};
+    std::atomic<float>* boostParam_ = nullptr;
+    std::atomic<float>* linearPhaseParam_ = nullptr;
+    std::atomic<float>* driveParam_ = nullptr;
+    std::atomic<float>* sweepDepthParam_ = nullptr;
+    std::atomic<float>* sweepRateParam_ = nullptr;
+    std::atomic<float>* lowMidFreqParam_ = nullptr;
+    std::atomic<float>* midHighFreqParam_ = nullptr;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessor)
 };
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include <juce_core/juce_core.h>
+
+#include "BinaryState.h"
+#include "Constants.h"
+
+namespace audio_plugin {
+
+// A stored setting of the band gains and boost, for instant recall on a drop
+struct Scene {
+    std::array<float, kNumBands> gainsDb{};  // low, mid, high
+    int boost = 0;  // index into kBoostLevels
+    float morphTimeSec = 0.0f;  // how long a recall takes to get there, 0 for at once
+
+    bool operator==(const Scene&) const = default;
+};
+
+// The scenes a processor holds, copied whole to the audio thread whenever one changes.
+struct SceneBank {
+    static constexpr int kNumScenes = 8;
+
+    std::array<Scene, kNumScenes> scenes{};
+
+    const Scene& operator[](int index) const { return scenes[static_cast<size_t>(index)]; }
+    Scene& operator[](int index) { return scenes[static_cast<size_t>(index)]; }
+
+    // Saved as a kChunkTag chunk of the plugin state: a count byte, then per scene the
+    // three gains, the boost index and the morph time. Reading resets scenes the payload
+    // doesn't hold, and keeps values within the parameters' ranges.
+    static constexpr uint32_t kChunkTag = chunkTag("SCNE");
+    void writeTo(juce::OutputStream& stream) const;
+    void readFrom(juce::InputStream& stream);
+};
+
+// Audio thread. Morphs the band gains and boost ceiling from the values in effect when a
+// scene was recalled to the values the parameters hold, linearly in dB over the morph
+// time. The recall sets the parameters to the scene, so the morph ends on it; moving a
+// parameter meanwhile changes where it ends.
+//
+// The values are constant for steps of kStepSamples, which the gain smoother turns into
+// a continuous ramp.
+class SceneMorph {
+public:
+    struct Values {
+        std::array<float, kNumBands> gainsDb{};
+        float boostMaxDb = 0.0f;
+    };
+
+    static constexpr int kStepSamples = 32;
+
+    // Stops any morph in progress
+    void prepare(double sampleRate);
+
+    // Morphs from values over morphTimeSec; at once (no morph) if that is under a sample
+    void start(const Values& from, float morphTimeSec);
+    bool isActive() const { return position_ < length_; }
+
+    // Values in effect now, given those the parameters hold
+    Values apply(const Values& target) const;
+
+    // Samples, up to maxSamples, before the values next change
+    int getStepSamples(int maxSamples) const {
+        return isActive() ? std::min(maxSamples, kStepSamples) : maxSamples;
+    }
+
+    void advance(int numSamples);
+
+private:
+    double sampleRate_ = 0.0;
+    Values from_;
+    int position_ = 0;
+    int length_ = 0;
+};
+
+}  // namespace audio_plugin
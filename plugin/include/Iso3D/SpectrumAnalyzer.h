@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include <juce_graphics/juce_graphics.h>
+
+#include "Constants.h"
+#include "DoubleBuffer.h"
+
+namespace audio_plugin {
+
+// Signals the spectrum analyzer shows: the input, then each band after its gain
+inline constexpr size_t kNumSpectrumTraces = 1 + kNumBands;
+
+// Wait-free single-producer, single-consumer ring of kNumSpectrumTraces parallel mono
+// sample streams, audio thread -> SpectrumAnalyzer.
+//
+// The producer writes a chunk of every trace past the published end, then publishes it
+// with a single atomic store in commit(). A chunk that doesn't fit is dropped whole, so a
+// consumer that falls behind only loses samples, and the audio thread never waits.
+class SpectrumRing {
+public:
+    static constexpr size_t kCapacity = size_t{1} << 14;  // 0.34 s at 48 kHz
+
+    // Producer. True if a chunk of numSamples fits.
+    bool hasRoom(int numSamples) const {
+        const size_t used = write_.load(std::memory_order_relaxed)
+            - read_.load(std::memory_order_acquire);
+        return static_cast<size_t>(numSamples) <= kCapacity - used;
+    }
+
+    // Producer. Sample n of the chunk being written, which hasRoom() has checked.
+    void set(size_t trace, size_t n, float value) {
+        traces_[trace][(write_.load(std::memory_order_relaxed) + n) & kMask] = value;
+    }
+
+    // Producer. Publishes the chunk's first numSamples samples of every trace.
+    void commit(int numSamples) {
+        write_.store(write_.load(std::memory_order_relaxed) + static_cast<size_t>(numSamples),
+                     std::memory_order_release);
+    }
+
+    // Any thread. Rate of the samples, which the processor sets at prepare time.
+    void setSampleRate(double sampleRate) { sampleRate_.store(sampleRate); }
+    double getSampleRate() const { return sampleRate_.load(); }
+
+    // Consumer. Samples published and not yet read.
+    size_t getNumReady() const {
+        return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_relaxed);
+    }
+
+    // Consumer. Copies the oldest numSamples (<= getNumReady()) of a trace, to be
+    // followed by discard() once every trace has been read.
+    void read(size_t trace, float* destination, size_t numSamples) const;
+    void discard(size_t numSamples) {
+        read_.store(read_.load(std::memory_order_relaxed) + numSamples,
+                    std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t kMask = kCapacity - 1;
+
+    std::array<std::array<float, kCapacity>, kNumSpectrumTraces> traces_{};
+    std::atomic<double> sampleRate_{0.0};
+
+    // Free-running counters on separate cache lines, as in SpscFifo
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+};
+
+// Input and per-band spectra for the editor, worked out on a background thread so the
+// audio thread only ever copies samples into a SpectrumRing.
+//
+// kFrameRateHz times a second the thread drains the ring, takes a Hann-windowed FFT of
+// the latest kFftSize samples of each trace and maps the bins onto kNumPoints frequencies
+// spaced evenly in log frequency from kMinHz to kMaxHz, each point the loudest bin near
+// it. Levels are in dB against a full-scale sine, smoothed with a fast rise and a fall
+// over kFallTimeSec. Each trace then becomes a juce::Path across the unit square, x from
+// kMinHz to kMaxHz and y from kMaxDb at 0 to kMinDb at 1, and the paths go to the message
+// thread through a DoubleBuffer, so a repaint only strokes finished paths, scaled to fit.
+//
+// Once kStaleTimeSec passes with no samples (transport stopped, or the input idling) the
+// spectra fall back to the floor. Frame times, from draining the ring to publishing the
+// paths, are gathered per second for getFrameStats().
+class SpectrumAnalyzer : private juce::Thread {
+public:
+    static constexpr int kFftOrder = 12;
+    static constexpr size_t kFftSize = size_t{1} << kFftOrder;
+    static constexpr size_t kNumPoints = 256;
+    static constexpr int kFrameRateHz = 30;
+    static constexpr float kMinHz = 20.0f;
+    static constexpr float kMaxHz = 20000.0f;
+    static constexpr float kMinDb = -90.0f;
+    static constexpr float kMaxDb = 12.0f;  // the most a band can boost
+    static constexpr float kFallTimeSec = 0.3f;
+    static constexpr float kStaleTimeSec = 0.25f;
+
+    using Spectrum = std::array<float, kNumPoints>;  // dB per point, lowest first
+    using Paths = std::array<juce::Path, kNumSpectrumTraces>;
+
+    struct FrameStats {
+        int numFrames = 0;
+        double meanMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    explicit SpectrumAnalyzer(SpectrumRing& ring);
+    ~SpectrumAnalyzer() override;
+
+    // Message thread. Starts and stops the analysis thread; frames are only worked out
+    // in between.
+    void start();
+    void stop();
+
+    // Message thread. Copies the newest paths into out and returns true if any were
+    // published since the last call.
+    bool pullPaths(Paths& out) { return paths_.pull(out); }
+
+    // Any thread. Frame times over the last full second.
+    FrameStats getFrameStats() const;
+
+    // One frame, as the thread runs it. Tests call it directly, with the thread stopped.
+    void processFrame();
+
+    // The analysis thread's spectra, for tests with the thread stopped
+    const Spectrum& getSpectrum(size_t trace) const { return spectra_[trace]; }
+
+    // Frequency of a point, in Hz
+    static float frequencyOf(size_t point);
+
+private:
+    void run() override;
+
+    // Starts over at a new sample rate: bin ranges, window scaling, history and spectra
+    void prepare(double sampleRate);
+
+    // Bins read for one point: the loudest of [first, last], or, where the point falls
+    // between two bins, first interpolated towards first + 1 by fraction
+    struct PointBins {
+        size_t first = 0;
+        size_t last = 0;
+        float fraction = 0.0f;
+    };
+
+    SpectrumRing& ring_;
+    double sampleRate_ = 0.0;
+
+    juce::dsp::FFT fft_{kFftOrder};
+    std::vector<float> window_;
+    std::vector<float> fftData_;
+    std::array<PointBins, kNumPoints> pointBins_{};
+    float magnitudeScale_ = 1.0f;  // magnitude of a full-scale sine's bin -> 1
+
+    // Latest kFftSize samples of each trace, oldest first
+    std::array<std::vector<float>, kNumSpectrumTraces> history_;
+    int framesWithoutSamples_ = 0;
+
+    std::array<Spectrum, kNumSpectrumTraces> spectra_{};
+    DoubleBuffer<Paths> paths_;
+
+    // Frame timing: the second being gathered, then the last full one
+    int frameCount_ = 0;
+    double frameTotalMs_ = 0.0;
+    double frameMaxMs_ = 0.0;
+    std::atomic<int> statsFrames_{0};
+    std::atomic<double> statsMeanMs_{0.0};
+    std::atomic<double> statsMaxMs_{0.0};
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumAnalyzer)
+};
+
+}  // namespace audio_plugin
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace audio_plugin {
+
+// Wait-free single-producer, single-consumer FIFO of up to Capacity values.
+//
+// Unlike DoubleBuffer, which only ever hands over the latest value, every value pushed
+// is popped in order. Both sides copy into or out of a preallocated slot and publish
+// with a single atomic store, so neither ever blocks or allocates. A full FIFO refuses
+// the push; the producer decides whether to drop the value or retry.
+template <typename T, size_t Capacity>
+class SpscFifo {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    // Producer. Returns false, queueing nothing, while the FIFO is full.
+    bool push(const T& value) {
+        const size_t write = write_.load(std::memory_order_relaxed);
+        if (write - read_.load(std::memory_order_acquire) == Capacity) return false;
+
+        slots_[write & kMask] = value;
+        write_.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer. Moves the oldest value into out and returns true, or returns false if
+    // the FIFO is empty.
+    bool pop(T& out) {
+        const size_t read = read_.load(std::memory_order_relaxed);
+        if (read == write_.load(std::memory_order_acquire)) return false;
+
+        out = slots_[read & kMask];
+        read_.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    std::array<T, Capacity> slots_{};
+
+    // Free-running counters on separate cache lines, so the two sides do not keep
+    // invalidating each other's line
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+};
+
+}  // namespace audio_plugin
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+namespace audio_plugin {
+
+// Real-time worker threads that share out the tasks of a parallel section with the
+// audio thread.
+//
+// run() publishes a job (a task function and a task count) and bumps a generation
+// counter. The calling thread and every worker then claim task indices from one atomic
+// counter until none are left, so work is distributed without locks or queues, and the
+// caller waits only for tasks a worker has already claimed: a worker that is asleep or
+// late to wake costs parallelism, never a missed deadline. That holds because workers
+// run at real-time priority, so none is preempted by ordinary threads mid-task; without
+// it the pool does not start. Once the last claimed task has finished, run() returns (a
+// spin barrier on a completion count).
+//
+// Workers spin for a short while after each job, so back-to-back blocks find them
+// awake, then park on the generation counter with C++20 atomic wait. run() only wakes
+// them (atomic notify, a futex on Linux) when one is parked, and never takes a lock.
+class WorkerPool {
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    // Message thread. (Re)starts numWorkers real-time threads, sized for blocks of
+    // samplesPerBlock at sampleRate, or stops them all for 0. Safe while the audio thread
+    // is in run(): the tasks it has published are finished either way. Returns false,
+    // with no workers running, if the system refuses real-time scheduling: a worker at
+    // normal priority could be descheduled holding a task the audio thread waits for.
+    bool start(int numWorkers, double sampleRate, int samplesPerBlock);
+    void stop();
+
+    int getNumWorkers() const { return numActiveWorkers_.load(std::memory_order_relaxed); }
+
+    // Audio thread. Calls task(index) for every index below numTasks, on the calling
+    // thread and any worker that is free, and returns once every call has returned.
+    // Tasks must be independent of each other. With no workers, or a single task, the
+    // calls are made in order on the calling thread.
+    template <typename Task>
+    void run(int numTasks, Task& task) {
+        if (numTasks <= 1 || getNumWorkers() == 0) {
+            for (int index = 0; index < numTasks; ++index) task(index);
+            return;
+        }
+        runJob(numTasks, &task, [](void* context, int index) {
+            (*static_cast<Task*>(context))(index);
+        });
+    }
+
+private:
+    using TaskFunction = void (*)(void* context, int index);
+
+    class Worker;
+
+    void runJob(int numTasks, void* context, TaskFunction function);
+
+    // Claims and runs tasks of the current job until none are left
+    void work();
+
+    // Worker side of the generation counter: spins, then parks until it moves on from
+    // seen or the worker is asked to exit. Returns the new generation.
+    int waitForJob(const Worker& worker, int seen);
+
+    // The current job. nextTask_ is closed (at kClosed or above) between jobs, so a
+    // worker that wakes late claims nothing; opening it publishes the job's fields.
+    static constexpr int kClosed = 1 << 30;
+    std::atomic<TaskFunction> function_{nullptr};
+    std::atomic<void*> context_{nullptr};
+    std::atomic<int> numTasks_{0};
+    std::atomic<int> nextTask_{kClosed};
+    std::atomic<int> completedTasks_{0};
+
+    std::atomic<int> generation_{0};
+    std::atomic<int> numParked_{0};
+    std::atomic<int> numActiveWorkers_{0};
+
+    // How long a worker spins after a job before parking
+    juce::int64 spinTicks_ = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+};
+
+}  // namespace audio_plugin
@@ -0,0 +1,85 @@
+#include <Iso3D/BandMeter.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <juce_core/juce_core.h>
+
+namespace audio_plugin {
+
+namespace {
+
+// Peak and sum of squares of one channel, in independent lanes so the compiler can
+// vectorise both without reassociating floating-point sums
+template <typename SampleType>
+void accumulate(const SampleType* data, size_t numSamples, SampleType& peak,
+                SampleType& sumOfSquares) {
+    constexpr size_t kLanes = 8;
+    std::array<SampleType, kLanes> peaks{};
+    std::array<SampleType, kLanes> sums{};
+
+    size_t i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            const SampleType x = data[i + lane];
+            peaks[lane] = std::max(peaks[lane], std::abs(x));
+            sums[lane] += x * x;
+        }
+    }
+    for (size_t lane = 0; i < numSamples; ++i, ++lane) {
+        const SampleType x = data[i];
+        peaks[lane] = std::max(peaks[lane], std::abs(x));
+        sums[lane] += x * x;
+    }
+
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        peak = std::max(peak, peaks[lane]);
+        sumOfSquares += sums[lane];
+    }
+}
+
+}  // namespace
+
+template <typename SampleType>
+void BandMeter<SampleType>::prepare(double sampleRate) {
+    const double windowSamples = static_cast<double>(kMeterWindowSec) * sampleRate;
+    windowLength_ = juce::jmax(1, juce::roundToInt(windowSamples));
+    reset();
+}
+
+template <typename SampleType>
+void BandMeter<SampleType>::reset() {
+    windowFill_ = 0;
+    peak_.fill(SampleType{});
+    sumOfSquares_.fill(SampleType{});
+}
+
+template <typename SampleType>
+bool BandMeter<SampleType>::addBlock(const Bands& bands, int numChannels, int numSamples,
+                                     const Gains& gains) {
+    if (numChannels <= 0 || numSamples <= 0) return false;
+
+    for (size_t band = 0; band < bands.size(); ++band)
+        for (int ch = 0; ch < numChannels; ++ch)
+            accumulate(bands[band][ch], static_cast<size_t>(numSamples), peak_[band],
+                       sumOfSquares_[band]);
+
+    // Windows end on block boundaries, so they run up to one block long
+    windowFill_ += numSamples;
+    if (windowFill_ < windowLength_) return false;
+
+    const auto count = static_cast<SampleType>(windowFill_) * static_cast<SampleType>(numChannels);
+    for (size_t band = 0; band < bands.size(); ++band) {
+        levels_.peak[band] = static_cast<float>(peak_[band]);
+        levels_.rms[band] = static_cast<float>(std::sqrt(sumOfSquares_[band] / count));
+        levels_.gain[band] = static_cast<float>(gains[band]);
+    }
+
+    reset();
+    return true;
+}
+
+template class BandMeter<float>;
+template class BandMeter<double>;
+
+}  // namespace audio_plugin
@@ -0,0 +1,65 @@
+#include <Iso3D/BinaryState.h>
+
+#include <algorithm>
+
+namespace audio_plugin {
+
+namespace {
+
+uint32_t readUint32(const char* bytes) {
+    return static_cast<uint32_t>(juce::ByteOrder::littleEndianInt(bytes));
+}
+
+}  // namespace
+
+void BinaryState::writeId(juce::OutputStream& stream, std::string_view id) {
+    const auto length = std::min(id.size(), kMaxIdLength);
+    stream.writeByte(static_cast<char>(length));
+    stream.write(id.data(), length);
+}
+
+std::optional<std::string_view> BinaryState::readId(juce::InputStream& stream,
+                                                    IdBuffer& buffer) {
+    if (stream.getNumBytesRemaining() < 1) return std::nullopt;
+
+    const auto length = static_cast<uint8_t>(stream.readByte());
+    if (stream.read(buffer.data(), length) != length) return std::nullopt;
+    return std::string_view(buffer.data(), length);
+}
+
+BinaryStateWriter::BinaryStateWriter(juce::MemoryBlock& destination)
+    : stream_(destination, false) {
+    stream_.preallocate(kInitialSize);
+    stream_.writeInt(static_cast<int>(BinaryState::kMagic));
+    stream_.writeInt(static_cast<int>(BinaryState::kVersion));
+}
+
+bool BinaryStateReader::canRead(const void* data, size_t size) {
+    if (data == nullptr || size < BinaryState::kHeaderSize) return false;
+
+    const auto* bytes = static_cast<const char*>(data);
+    return readUint32(bytes) == BinaryState::kMagic
+        && readUint32(bytes + 4) <= BinaryState::kVersion;
+}
+
+BinaryStateReader::BinaryStateReader(const void* data, size_t size)
+    : data_(static_cast<const char*>(data)), size_(size) {
+    jassert(canRead(data, size));
+}
+
+bool BinaryStateReader::nextChunk() {
+    payload_.reset();
+    if (size_ - position_ < BinaryState::kChunkHeaderSize) return false;
+
+    const auto* header = data_ + position_;
+    const size_t payloadSize = readUint32(header + 4);
+    const size_t payloadStart = position_ + BinaryState::kChunkHeaderSize;
+    if (payloadSize > size_ - payloadStart) return false;
+
+    tag_ = readUint32(header);
+    payload_.emplace(data_ + payloadStart, payloadSize, false);
+    position_ = payloadStart + payloadSize;
+    return true;
+}
+
+}  // namespace audio_plugin
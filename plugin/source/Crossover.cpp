@@ -1,32 +1,1145 @@
 #include <Iso3D/Crossover.h>
 
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
 namespace audio_plugin {
 
-void Crossover::prepare(double sampleRate) {
-    juce::dsp::ProcessSpec spec{};
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = 0;  // sample-by-sample processing
-    spec.numChannels = static_cast<juce::uint32>(kNumChannels);
+namespace {
+
+// Calls fn(std::integral_constant<size_t, I>{}) for I = 0 .. Count - 1, fully unrolled.
+template <size_t Count, typename Fn>
+void unroll(Fn&& fn) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (fn(std::integral_constant<size_t, I>{}), ...);
+    }(std::make_index_sequence<Count>{});
+}
+
+// Resolves a CrossoverNetwork source to a value: the crossover input, or a node's low
+// or high output. Allpass nodes write their output to the low slot.
+template <auto source, typename T, typename Outputs>
+T tap(const T& input, const Outputs& low, const Outputs& high) {
+    using Tap = decltype(source.tap);
+    if constexpr (source.node < 0)
+        return input;
+    else if constexpr (source.tap == Tap::high)
+        return high[static_cast<size_t>(source.node)];
+    else
+        return low[static_cast<size_t>(source.node)];
+}
+
+// Samples a network node runs behind the input in the pipelined layout: a split its
+// depth, an allpass as far as the node feeding it, since it steps right after that node.
+// The crossover input (node < 0) is current.
+template <typename Network>
+constexpr int pipelineLag(int node) {
+    if (node < 0) return 0;
+    const auto& n = Network::nodes[static_cast<size_t>(node)];
+    return n.kind == Network::Kind::split ? n.depth : pipelineLag<Network>(n.input.node);
+}
+
+// The first allpass node on a split point. Every allpass on it shares its block form.
+template <typename Network>
+constexpr size_t allpassOn(int split) {
+    for (size_t node = 0; node < Network::nodes.size(); ++node)
+        if (Network::nodes[node].kind == Network::Kind::allpass
+            && Network::nodes[node].split == split)
+            return node;
+    return 0;
+}
+
+}  // namespace
+
+template <int NumBands>
+typename CrossoverCoefficients<NumBands>::Frequencies
+CrossoverCoefficients<NumBands>::defaultFrequencies() {
+    Frequencies frequencies{};
+    frequencies.front() = kLowMidCrossoverHz;
+    if constexpr (kNumSplits > 1) {
+        const double lowHz = static_cast<double>(kLowMidCrossoverHz);
+        const double ratio = static_cast<double>(kMidHighCrossoverHz) / lowHz;
+        const double lastSplit = static_cast<double>(kNumSplits - 1);
+        for (size_t s = 1; s + 1 < kNumSplits; ++s)
+            frequencies[s] =
+                static_cast<float>(lowHz * std::pow(ratio, static_cast<double>(s) / lastSplit));
+        frequencies.back() = kMidHighCrossoverHz;
+    }
+    return frequencies;
+}
+
+template <int NumBands>
+CrossoverCoefficients<NumBands> CrossoverCoefficients<NumBands>::make(
+    double sampleRate, const Frequencies& frequenciesHz) {
+    CrossoverCoefficients coefficients;
+    for (size_t s = 0; s < kNumSplits; ++s) {
+        // Keeps tan() finite when a split point is near Nyquist at low sample rates
+        const double fc = std::min(static_cast<double>(frequenciesHz[s]), 0.49 * sampleRate);
+        const double g = std::tan(juce::MathConstants<double>::pi * fc / sampleRate);
+        const double r2 = std::sqrt(2.0);
+        coefficients.splits[s] = {g, r2 + g, 1.0 / (1.0 + r2 * g + g * g)};
+    }
+    return coefficients;
+}
+
+CrossoverCoefficientTable CrossoverCoefficientTable::make(double sampleRate) {
+    CrossoverCoefficientTable table;
+    for (size_t i = 0; i < kSize; ++i) {
+        const double octaves = static_cast<double>(i) / static_cast<double>(kStepsPerOctave);
+        const double fc = std::min(kMinHz * std::exp2(octaves), 0.49 * sampleRate);
+        table.g[i] = std::tan(juce::MathConstants<double>::pi * fc / sampleRate);
+    }
+    return table;
+}
+
+float CrossoverCoefficientTable::positionOf(float hz) {
+    const double octaves = std::log2(std::max(static_cast<double>(hz), kMinHz) / kMinHz);
+    return static_cast<float>(std::min(octaves * kStepsPerOctave, static_cast<double>(kSize - 1)));
+}
+
+template <typename SampleType, int NumBands>
+struct Crossover<SampleType, NumBands>::BankRegisters {
+    void load(const SectionBank& bank) {
+        g = Vec::fromRawArray(bank.g.v);
+        r2 = Vec::fromRawArray(bank.r2.v);
+        k = Vec::fromRawArray(bank.k.v);
+        h = Vec::fromRawArray(bank.h.v);
+        gStep = Vec::fromRawArray(bank.gStep.v);
+        s1 = Vec::fromRawArray(bank.s1.v);
+        s2 = Vec::fromRawArray(bank.s2.v);
+        s3 = Vec::fromRawArray(bank.s3.v);
+        s4 = Vec::fromRawArray(bank.s4.v);
+    }
+
+    void loadCoefficients(const SectionBank& bank) {
+        g = Vec::fromRawArray(bank.g.v);
+        k = Vec::fromRawArray(bank.k.v);
+        h = Vec::fromRawArray(bank.h.v);
+    }
+
+    // Every lane on the same coefficients
+    void setCoefficients(SampleType gValue, SampleType kValue, SampleType hValue) {
+        g = Vec::expand(gValue);
+        k = Vec::expand(kValue);
+        h = Vec::expand(hValue);
+    }
+
+    void store(SectionBank& bank) const {
+        g.copyToRawArray(bank.g.v);
+        k.copyToRawArray(bank.k.v);
+        h.copyToRawArray(bank.h.v);
+        s1.copyToRawArray(bank.s1.v);
+        s2.copyToRawArray(bank.s2.v);
+        s3.copyToRawArray(bank.s3.v);
+        s4.copyToRawArray(bank.s4.v);
+    }
+
+    void process(Vec input, Vec& lowOut, Vec& highOut) {
+        processSection(input, s1, s2, s3, s4, g, r2, k, h, lowOut, highOut);
+    }
+
+    void processAllpass(Vec input, Vec& out) {
+        processAllpassSection(input, s1, s2, g, r2, k, h, out);
+    }
+
+    // Vector form of SectionBank::glideStep(). SIMDRegister has no divide, so h takes
+    // one scalar reciprocal per lane.
+    void glideStep() {
+        g += gStep;
+        k = r2 + g;
+
+        LaneArray denominator;
+        (Vec::expand(1) + g * k).copyToRawArray(denominator.v);
+        for (auto& d : denominator.v) d = 1 / d;
+        h = Vec::fromRawArray(denominator.v);
+    }
+
+    Vec g;
+    Vec r2;
+    Vec k;
+    Vec h;
+    Vec gStep;
+    Vec s1;
+    Vec s2;
+    Vec s3;
+    Vec s4;
+};
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::setCoefficients(
+    size_t lane, const typename Coefficients::Split& split) {
+    r2.v[lane] = static_cast<SampleType>(std::sqrt(2.0));
+    g.v[lane] = gTarget.v[lane] = static_cast<SampleType>(split.g);
+    k.v[lane] = kTarget.v[lane] = static_cast<SampleType>(split.k);
+    h.v[lane] = hTarget.v[lane] = static_cast<SampleType>(split.h);
+    gStep.v[lane] = 0;
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::setModulated(size_t lane, SampleType gValue) {
+    g.v[lane] = gValue;
+    k.v[lane] = r2.v[lane] + gValue;
+    h.v[lane] = 1 / (1 + gValue * k.v[lane]);
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::setGlideTarget(
+    size_t lane, const typename Coefficients::Split& split, size_t glideSamples) {
+    gTarget.v[lane] = static_cast<SampleType>(split.g);
+    kTarget.v[lane] = static_cast<SampleType>(split.k);
+    hTarget.v[lane] = static_cast<SampleType>(split.h);
+    gStep.v[lane] = (gTarget.v[lane] - g.v[lane]) / static_cast<SampleType>(glideSamples);
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::glideStep() {
+    for (size_t lane = 0; lane < kNumLanes; ++lane) {
+        g.v[lane] += gStep.v[lane];
+        k.v[lane] = r2.v[lane] + g.v[lane];
+        h.v[lane] = 1 / (1 + g.v[lane] * k.v[lane]);
+    }
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::finishGlide() {
+    // Land exactly on the target rather than on the accumulated steps
+    g = gTarget;
+    k = kTarget;
+    h = hTarget;
+    gStep = {};
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::resetState() {
+    s1 = {};
+    s2 = {};
+    s3 = {};
+    s4 = {};
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::processLane(size_t lane, SampleType input,
+                                                               SampleType& lowOut,
+                                                               SampleType& highOut) {
+    processSection(input, s1.v[lane], s2.v[lane], s3.v[lane], s4.v[lane], g.v[lane],
+                   r2.v[lane], k.v[lane], h.v[lane], lowOut, highOut);
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::SectionBank::processAllpassLane(size_t lane,
+                                                                      SampleType input,
+                                                                      SampleType& out) {
+    processAllpassSection(input, s1.v[lane], s2.v[lane], g.v[lane], r2.v[lane], k.v[lane],
+                          h.v[lane], out);
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::prepare(double sampleRate, int numChannels) {
+    jassert(numChannels >= 1 && numChannels <= kMaxChannels);
+    numChannels_ = juce::jlimit(1, kMaxChannels, numChannels);
+
+    const auto channels = static_cast<size_t>(numChannels_);
+    const size_t numGroups = (channels + kNumLanes - 1) / kNumLanes;
+    banks_.assign(isPipelined() ? kNumPipelinedBanks : kNumNodes * numGroups, SectionBank{});
+    allpassSum_ = false;
+
+    const double glideSamples = static_cast<double>(kCrossoverGlideTimeSec) * sampleRate;
+    glideLength_ = static_cast<size_t>(juce::jmax(1, juce::roundToInt(glideSamples)));
+    setCoefficients(Coefficients::make(sampleRate, Coefficients::defaultFrequencies()));
+
+    reset();
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::setCoefficients(const Coefficients& coefficients) {
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) {
+        for (size_t node = 0; node < kNumNodes; ++node) {
+            const auto split = static_cast<size_t>(Network::nodes[node].split);
+            const auto ref = nodeLane(node, ch);
+            banks_[ref.bank].setCoefficients(ref.lane, coefficients.splits[split]);
+        }
+    }
+    glideRemaining_ = 0;
+    modulationTable_ = nullptr;
+    updateBlockMatrices();
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::glideTo(const Coefficients& coefficients) {
+    // A new target mid-glide starts a fresh glide from wherever g has got to
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) {
+        for (size_t node = 0; node < kNumNodes; ++node) {
+            const auto split = static_cast<size_t>(Network::nodes[node].split);
+            const auto ref = nodeLane(node, ch);
+            banks_[ref.bank].setGlideTarget(ref.lane, coefficients.splits[split], glideLength_);
+        }
+    }
+    glideRemaining_ = glideLength_;
+    modulationTable_ = nullptr;
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::modulate(const CrossoverCoefficientTable& table,
+                                              const Positions& positions) {
+    glideRemaining_ = 0;
+    modulationTable_ = &table;
+    modulation_ = positions;
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::setAllpassSum(bool enabled) {
+    if (enabled == allpassSum_) return;
+    jassert(!enabled || (!isGliding() && !isModulated()));
+    allpassSum_ = enabled;
+
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) {
+        auto stateOf = [&](size_t node) -> SectionBank& {
+            return banks_[nodeLane(node, ch).bank];
+        };
+        auto laneOf = [&](size_t node) { return nodeLane(node, ch).lane; };
+
+        // Every node on a split point runs its first SVF on the same coefficients, and the
+        // outputs that SVF feeds add up to its allpass, so the allpass of the sum holds the
+        // sum of their states. The split node keeps it. Split 0 has no allpass on it and
+        // runs on as it was, since it rings longest.
+        if (enabled) {
+            for (size_t node = kNumSplitNodes; node < kNumNodes; ++node) {
+                const auto split = static_cast<size_t>(Network::nodes[node].split);
+                auto& from = stateOf(node);
+                auto& to = stateOf(split);
+                to.s1.v[laneOf(split)] += from.s1.v[laneOf(node)];
+                to.s2.v[laneOf(split)] += from.s2.v[laneOf(node)];
+                from.s1.v[laneOf(node)] = from.s2.v[laneOf(node)] = 0;
+            }
+            for (size_t split = 1; split < kNumSplitNodes; ++split)
+                stateOf(split).s3.v[laneOf(split)] = stateOf(split).s4.v[laneOf(split)] = 0;
+            continue;
+        }
+
+        // Handing back, the nodes on higher splits start as if their input had held still
+        // at its last value, which is where most of the signal sits relative to them: an
+        // SVF with input u then holds (0, u) and outputs u from its low-pass and allpass.
+        // A split node takes what is left of its split's sum once the compensation
+        // allpasses on it have theirs. Their inputs come from lower splits, done first.
+        for (size_t split = 1; split < kNumSplitNodes; ++split) {
+            SampleType rest = stateOf(split).s2.v[laneOf(split)];
+            for (size_t node = kNumSplitNodes; node < kNumNodes; ++node) {
+                if (static_cast<size_t>(Network::nodes[node].split) != split) continue;
+                const auto source = Network::nodes[node].input;
+                const auto from = static_cast<size_t>(source.node);
+                const SampleType input = source.tap == Network::Tap::allpass
+                    ? stateOf(from).s2.v[laneOf(from)]
+                    : stateOf(from).s4.v[laneOf(from)];
+                stateOf(node).s2.v[laneOf(node)] = input;
+                rest -= input;
+            }
+
+            auto& bank = stateOf(split);
+            bank.s2.v[laneOf(split)] = rest;
+            bank.s3.v[laneOf(split)] = 0;
+            bank.s4.v[laneOf(split)] = rest;
+        }
+    }
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::reset() {
+    for (auto& bank : banks_) bank.resetState();
+}
+
+template <typename SampleType, int NumBands>
+bool Crossover<SampleType, NumBands>::isSilent(SampleType threshold) const {
+    for (int group = 0; group < getNumGroups(numChannels_); ++group)
+        if (!isGroupSilent(group, threshold)) return false;
+    return true;
+}
+
+template <typename SampleType, int NumBands>
+bool Crossover<SampleType, NumBands>::isGroupSilent(int group, SampleType threshold) const {
+    // Unused lanes hold zero state, so whole banks can be checked
+    const auto [first, end] = groupBanks(group);
+    for (size_t index = first; index < end; ++index) {
+        const auto& bank = banks_[index];
+        for (const auto* state : {&bank.s1, &bank.s2, &bank.s3, &bank.s4})
+            for (const auto value : state->v)
+                if (std::abs(value) >= threshold) return false;
+    }
+    return true;
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::resetGroup(int group) {
+    const auto [first, end] = groupBanks(group);
+    for (size_t index = first; index < end; ++index) banks_[index].resetState();
+}
+
+template <typename SampleType, int NumBands>
+bool Crossover<SampleType, NumBands>::isTimeParallel(int group, int numChannels,
+                                                     int numSamples) const {
+    const auto channels = static_cast<size_t>(std::min(numChannels, numChannels_));
+    const auto samples = static_cast<size_t>(numSamples);
+    const size_t first = isPipelined() ? 0 : static_cast<size_t>(group) * kNumLanes;
+    return runsTimeParallel(first, channels, samples, std::min(glideRemaining_, samples));
+}
+
+template <typename SampleType, int NumBands>
+typename Crossover<SampleType, NumBands>::ChannelState
+Crossover<SampleType, NumBands>::getChannelState(int channel) const {
+    jassert(channel >= 0 && channel < numChannels_ && !allpassSum_);
+    ChannelState state{};
+    for (size_t node = 0; node < kNumNodes; ++node) {
+        const auto ref = nodeLane(node, static_cast<size_t>(channel));
+        const auto& bank = banks_[ref.bank];
+        state[node] = {bank.s1.v[ref.lane], bank.s2.v[ref.lane], bank.s3.v[ref.lane],
+                       bank.s4.v[ref.lane]};
+    }
+    return state;
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::setChannelState(int channel, const ChannelState& state) {
+    jassert(channel >= 0 && channel < numChannels_ && !allpassSum_);
+    for (size_t node = 0; node < kNumNodes; ++node) {
+        const auto ref = nodeLane(node, static_cast<size_t>(channel));
+        auto& bank = banks_[ref.bank];
+        bank.s1.v[ref.lane] = state[node][0];
+        bank.s2.v[ref.lane] = state[node][1];
+        bank.s3.v[ref.lane] = state[node][2];
+        bank.s4.v[ref.lane] = state[node][3];
+    }
+}
+
+template <typename SampleType, int NumBands>
+double Crossover<SampleType, NumBands>::decayTimeSeconds(double sampleRate,
+                                                        const Coefficients& coefficients,
+                                                        SampleType threshold) {
+    Crossover xover;
+    xover.prepare(sampleRate, 1);
+    xover.setCoefficients(coefficients);
+
+    // Settle on full-scale DC, which leaves the integrators at their largest, then let go
+    const auto settleSamples = static_cast<int>(sampleRate / 10.0);
+    for (int n = 0; n < settleSamples; ++n) xover.processSample(0, SampleType{1});
+
+    const auto maxSamples = static_cast<int>(sampleRate * 10.0);
+    int n = 0;
+    while (n < maxSamples && !xover.isSilent(threshold)) {
+        xover.processSample(0, SampleType{});
+        ++n;
+    }
+    return static_cast<double>(n) / sampleRate;
+}
+
+template <typename SampleType, int NumBands>
+typename Crossover<SampleType, NumBands>::LaneRef Crossover<SampleType, NumBands>::nodeLane(
+    size_t node, size_t channel) const {
+    if (isPipelined()) {
+        if (node < kNumSplitNodes) return {0, node * kMaxPipelinedChannels + channel};
+        return {1, (node - kNumSplitNodes) * kMaxPipelinedChannels + channel};
+    }
+    return {(channel / kNumLanes) * kNumNodes + node, channel % kNumLanes};
+}
+
+template <typename SampleType, int NumBands>
+std::pair<size_t, size_t> Crossover<SampleType, NumBands>::groupBanks(int group) const {
+    if (isPipelined()) return {0, banks_.size()};
+    const size_t first = static_cast<size_t>(group) * kNumNodes;
+    return {first, std::min(first + kNumNodes, banks_.size())};
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::updateBlockMatrices() {
+    if (banks_.empty()) return;
+
+    for (size_t node = 0; node < kNumNodes; ++node) {
+        // Every channel runs a node on the same coefficients
+        const auto ref = nodeLane(node, 0);
+        const auto& bank = banks_[ref.bank];
+        const auto g = static_cast<double>(bank.g.v[ref.lane]);
+        const auto r2 = static_cast<double>(bank.r2.v[ref.lane]);
+        const auto k = static_cast<double>(bank.k.v[ref.lane]);
+        const auto h = static_cast<double>(bank.h.v[ref.lane]);
+        const bool split = Network::nodes[node].kind == Network::Kind::split;
+
+        // The block is linear in z and x, so kNumLanes steps from each unit state and unit
+        // input give the matrices column by column
+        auto& m = blockMatrices_[node];
+        for (size_t column = 0; column < kSectionStates + kNumLanes; ++column) {
+            const bool fromState = column < kSectionStates;
+            const size_t index = fromState ? column : column - kSectionStates;
+
+            std::array<double, kSectionStates> z{};
+            if (fromState) z[index] = 1.0;
+            for (size_t j = 0; j < kNumLanes; ++j) {
+                const double x = !fromState && j == index ? 1.0 : 0.0;
+                double low = 0.0;
+                double high = 0.0;
+                if (split)
+                    processSection(x, z[0], z[1], z[2], z[3], g, r2, k, h, low, high);
+                else
+                    processAllpassSection(x, z[0], z[1], g, r2, k, h, low);
+
+                (fromState ? m.stateToLow[index] : m.inputToLow[index]).v[j] =
+                    static_cast<SampleType>(low);
+                (fromState ? m.stateToHigh[index] : m.inputToHigh[index]).v[j] =
+                    static_cast<SampleType>(high);
+            }
+
+            auto& toState = fromState ? m.stateToState[index] : m.inputToState[index];
+            for (size_t i = 0; i < kSectionStates; ++i)
+                toState[i / kNumLanes].v[i % kNumLanes] = static_cast<SampleType>(z[i]);
+        }
+    }
+}
+
+template <typename SampleType, int NumBands>
+bool Crossover<SampleType, NumBands>::runsTimeParallel(size_t first, size_t numChannels,
+                                                       size_t numSamples,
+                                                       size_t glideSamples) const {
+    if (glideSamples > 0 || isModulated() || execution_ == Execution::channelParallel)
+        return false;
+    if (execution_ == Execution::timeParallel) return true;
+
+    // Measured, with the band sum or the allpass sum alike: time-parallel wins while the
+    // group's channels would leave at least half the lanes idle, and loses or ties after
+    const size_t groupChannels = isPipelined() ? numChannels
+                                               : std::min(kNumLanes, numChannels - first);
+    return numSamples >= static_cast<size_t>(kMinTimeParallelSamples)
+        && 2 * groupChannels <= kNumLanes;
+}
+
+template <typename SampleType, int NumBands>
+BandSamples<SampleType, NumBands> Crossover<SampleType, NumBands>::processSample(
+    int channel, SampleType input) {
+    jassert(channel >= 0 && channel < numChannels_);
+    const auto ch = static_cast<size_t>(channel);
+
+    std::array<SampleType, kNumNodes> low{};
+    std::array<SampleType, kNumNodes> high{};
+    unroll<kNumNodes>([&](auto i) {
+        constexpr size_t I = decltype(i)::value;
+        constexpr auto node = Network::nodes[I];
+        const auto ref = nodeLane(I, ch);
+        const SampleType in = tap<node.input>(input, low, high);
+
+        if constexpr (node.kind == Network::Kind::split)
+            banks_[ref.bank].processLane(ref.lane, in, low[I], high[I]);
+        else
+            banks_[ref.bank].processAllpassLane(ref.lane, in, low[I]);
+    });
 
-    lowMidSplit_.setCutoffFrequency(kLowMidCrossoverHz);
-    lowMidSplit_.prepare(spec);
-    lowMidSplit_.reset();
+    BandSamples<SampleType, NumBands> bands{};
+    unroll<static_cast<size_t>(NumBands)>([&](auto b) {
+        constexpr size_t B = decltype(b)::value;
+        bands[B] = tap<Network::bands[B]>(input, low, high);
+    });
+    return bands;
+}
+
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runGroup(int group, const SampleType* const* input,
+                                               int numChannels, int numSamples, Sink&& sink) {
+    jassert(numChannels >= 1 && numChannels <= numChannels_);
+    jassert(group >= 0 && group < getNumGroups(numChannels));
+    if (numSamples <= 0 || numChannels <= 0) return;
+
+    const auto channels = static_cast<size_t>(std::min(numChannels, numChannels_));
+    const auto samples = static_cast<size_t>(numSamples);
 
-    midHighSplit_.setCutoffFrequency(kMidHighCrossoverHz);
-    midHighSplit_.prepare(spec);
-    midHighSplit_.reset();
+    // The glide moves on in endBlock(), so every group sees it where the block started.
+    // Modulated blocks don't glide.
+    const size_t glideSamples = std::min(glideRemaining_, samples);
+
+    const size_t first = isPipelined() ? 0 : static_cast<size_t>(group) * kNumLanes;
+    const bool timeParallel = runsTimeParallel(first, channels, samples, glideSamples);
+    if (allpassSum_) {
+        if (timeParallel)
+            runTimeParallelAllpassSum(first, input, channels, samples, sink);
+        else if (isPipelined())
+            runPipelinedAllpassSum(input, channels, samples, sink);
+        else
+            runGroupedAllpassSum(first, input, channels, samples, sink);
+    } else if (timeParallel)
+        runTimeParallel(first, input, channels, samples, sink);
+    else if (isPipelined())
+        runPipelined(input, channels, samples, glideSamples, sink);
+    else
+        runGrouped(first, input, channels, samples, glideSamples, sink);
 }
 
-BandSamples Crossover::processSample(int channel, float input) {
-    float low = 0.0f;
-    float hp1Out = 0.0f;
-    lowMidSplit_.processSample(channel, input, low, hp1Out);
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::endBlock(int numSamples) {
+    if (isModulated()) {
+        modulationTable_ = nullptr;
+        updateBlockMatrices();
+        return;
+    }
+
+    const size_t glideSamples = std::min(glideRemaining_, static_cast<size_t>(numSamples));
+    if (glideSamples > 0) {
+        glideRemaining_ -= glideSamples;
+        if (glideRemaining_ == 0) {
+            for (auto& bank : banks_) bank.finishGlide();
+            updateBlockMatrices();
+        }
+    }
+}
+
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runPipelined(const SampleType* const* input,
+                                                   size_t numChannels, size_t numSamples,
+                                                   size_t glideSamples, Sink& sink) {
+    if constexpr (kMaxPipelinedChannels == 0) {
+        juce::ignoreUnused(input, numChannels, numSamples, glideSamples, sink);
+        jassertfalse;
+    } else {
+        constexpr bool kLagged = Network::kMaxDepth > 0;
+        constexpr bool kHasAllpasses = kNumAllpassNodes > 0;
+
+        // The allpass steps on lowMid's LP, whose lanes it shares in its own bank
+        static_assert(!kHasAllpasses || (kNumAllpassNodes == 1 && kNumSplitNodes == 2
+                                         && Network::nodes[kNumSplitNodes].input.node == 0));
+
+        constexpr auto laneOf = [](size_t node, size_t ch) {
+            const size_t index = node < kNumSplitNodes ? node : node - kNumSplitNodes;
+            return index * kMaxPipelinedChannels + ch;
+        };
+        constexpr auto lagOf = [](int node) { return pipelineLag<Network>(node); };
+
+        auto& splitBank = banks_.front();
+        auto& allpassBank = banks_.back();
+        const size_t last = numSamples - 1;
+
+        // Input each lagged split lane consumes on its next step
+        LaneArray carry;
+
+        // One scalar step of the nodes at the given lag, for filling and draining the
+        // pipeline. Emits that lag's bands and feeds the lanes that depend on them.
+        auto scalarStep = [&](auto lag, size_t n) {
+            constexpr int kLag = decltype(lag)::value;
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                std::array<SampleType, kNumNodes> low{};
+                std::array<SampleType, kNumNodes> high{};
+                unroll<kNumNodes>([&](auto i) {
+                    constexpr size_t I = decltype(i)::value;
+                    constexpr auto node = Network::nodes[I];
+                    if constexpr (lagOf(static_cast<int>(I)) == kLag) {
+                        SampleType in;
+                        if constexpr (lagOf(node.input.node) == kLag)
+                            in = tap<node.input>(input[ch][n], low, high);
+                        else
+                            in = carry.v[laneOf(I, ch)];
+
+                        const auto ref = nodeLane(I, ch);
+                        if constexpr (node.kind == Network::Kind::split)
+                            banks_[ref.bank].processLane(ref.lane, in, low[I], high[I]);
+                        else
+                            banks_[ref.bank].processAllpassLane(ref.lane, in, low[I]);
+                    }
+                });
+                unroll<static_cast<size_t>(NumBands)>([&](auto b) {
+                    constexpr size_t B = decltype(b)::value;
+                    if constexpr (lagOf(Network::bands[B].node) == kLag)
+                        sink(B, ch, n, tap<Network::bands[B]>(SampleType{}, low, high));
+                });
+                unroll<kNumNodes>([&](auto i) {
+                    constexpr size_t I = decltype(i)::value;
+                    constexpr auto source = Network::nodes[I].input;
+                    if constexpr (lagOf(source.node) == kLag && lagOf(static_cast<int>(I)) > kLag)
+                        carry.v[laneOf(I, ch)] = tap<source>(SampleType{}, low, high);
+                });
+            }
+        };
+
+        // Modulated, each lane takes the coefficients of the sample it runs: for lanes at
+        // the given lag (or all, with -1), those of loop step n
+        const bool modulated = isModulated();
+        auto modulateLanes = [&](int lag, size_t n) {
+            unroll<kNumNodes>([&](auto i) {
+                constexpr size_t I = decltype(i)::value;
+                constexpr int kNodeLag = lagOf(static_cast<int>(I));
+                if ((lag >= 0 && kNodeLag != lag) || n < static_cast<size_t>(kNodeLag)) return;
+                const auto split = static_cast<size_t>(Network::nodes[I].split);
+                const SampleType g = modulatedG(split, n - static_cast<size_t>(kNodeLag));
+                for (size_t ch = 0; ch < numChannels; ++ch) {
+                    const auto ref = nodeLane(I, ch);
+                    banks_[ref.bank].setModulated(ref.lane, g);
+                }
+            });
+        };
+
+        // While gliding, each sample steps the coefficients first. Lagged lanes see each
+        // step one sample late, which is inaudible.
+        if (glideSamples > 0)
+            for (auto& bank : banks_) bank.glideStep();
+        if (modulated) modulateLanes(0, 0);
+
+        // Prologue: the lagged lanes have nothing to consume until the first output of
+        // the lanes ahead of them exists, so sample 0 of those runs on its own.
+        if constexpr (kLagged) scalarStep(std::integral_constant<int, 0>{}, 0);
+
+        BankRegisters splitRegs;
+        BankRegisters allpassRegs;
+        splitRegs.load(splitBank);
+        if constexpr (kHasAllpasses) allpassRegs.load(allpassBank);
+
+        // Only the channels in use feed the allpass, so the other lanes keep zero state
+        auto allpassMask = Vec::expand(0);
+        for (size_t ch = 0; ch < numChannels; ++ch) allpassMask.set(laneOf(0, ch), 1);
+
+        // Steady state: lowMid and the allpass run sample n while midHigh runs sample
+        // n - 1. All input for sample n is read before any output for sample n - 1 is
+        // written, which keeps in-place processing safe.
+        auto x = Vec::expand(0);
+        for (size_t n = kLagged ? 1 : 0; n <= last; ++n) {
+            if (n > 0 && n < glideSamples) {
+                splitRegs.glideStep();
+                if constexpr (kHasAllpasses) allpassRegs.glideStep();
+            }
+            if (modulated && n > 0) {
+                modulateLanes(-1, n);
+                splitRegs.loadCoefficients(splitBank);
+                if constexpr (kHasAllpasses) allpassRegs.loadCoefficients(allpassBank);
+            }
+
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                unroll<kNumSplitNodes>([&](auto i) {
+                    constexpr size_t I = decltype(i)::value;
+                    if constexpr (Network::nodes[I].depth == 0)
+                        x.set(laneOf(I, ch), input[ch][n]);
+                    else
+                        x.set(laneOf(I, ch), carry.v[laneOf(I, ch)]);
+                });
+            }
+
+            Vec lp;
+            Vec hp;
+            Vec ap;
+            splitRegs.process(x, lp, hp);
+            if constexpr (kHasAllpasses) allpassRegs.processAllpass(lp * allpassMask, ap);
+
+            // Per channel, the lagged bands of n - 1 go out before the bands of n
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                auto emit = [&](auto b, size_t sample) {
+                    constexpr auto source = Network::bands[decltype(b)::value];
+                    const size_t lane = laneOf(static_cast<size_t>(source.node), ch);
+                    if constexpr (source.tap == Network::Tap::allpass)
+                        sink(decltype(b)::value, ch, sample, ap.get(lane));
+                    else if constexpr (source.tap == Network::Tap::high)
+                        sink(decltype(b)::value, ch, sample, hp.get(lane));
+                    else
+                        sink(decltype(b)::value, ch, sample, lp.get(lane));
+                };
+                unroll<static_cast<size_t>(NumBands)>([&](auto b) {
+                    if constexpr (lagOf(Network::bands[decltype(b)::value].node) == 1)
+                        emit(b, n - 1);
+                });
+                unroll<static_cast<size_t>(NumBands)>([&](auto b) {
+                    if constexpr (lagOf(Network::bands[decltype(b)::value].node) == 0)
+                        emit(b, n);
+                });
+                unroll<kNumSplitNodes>([&](auto i) {
+                    constexpr auto source = Network::nodes[decltype(i)::value].input;
+                    if constexpr (source.node >= 0) {
+                        const size_t lane = laneOf(static_cast<size_t>(source.node), ch);
+                        carry.v[laneOf(decltype(i)::value, ch)] = hp.get(lane);
+                    }
+                });
+            }
+        }
+
+        splitRegs.store(splitBank);
+        if constexpr (kHasAllpasses) allpassRegs.store(allpassBank);
+
+        // Epilogue: drain the lagged lanes for the final sample.
+        if constexpr (kLagged) {
+            if (modulated) modulateLanes(1, last + 1);
+            scalarStep(std::integral_constant<int, 1>{}, last);
+        }
+    }
+}
+
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runGrouped(size_t first, const SampleType* const* input,
+                                                 size_t numChannels, size_t numSamples,
+                                                 size_t glideSamples, Sink& sink) {
+    const size_t groupChannels = std::min(kNumLanes, numChannels - first);
+    SectionBank* groupBanks = banks_.data() + (first / kNumLanes) * kNumNodes;
+
+    std::array<BankRegisters, kNumNodes> regs;
+    for (size_t node = 0; node < kNumNodes; ++node) regs[node].load(groupBanks[node]);
+
+    // Modulated, the coefficients of each split point are worked out once per sample and
+    // shared by every node on it
+    constexpr size_t kNumSplits = Coefficients::kNumSplits;
+    const bool modulated = isModulated();
+    const auto r2 = static_cast<SampleType>(std::sqrt(2.0));
+
+    // Lanes beyond groupChannels stay at zero input, so their state stays silent.
+    auto x = Vec::expand(0);
+    for (size_t n = 0; n < numSamples; ++n) {
+        if (n < glideSamples)
+            for (auto& nodeRegs : regs) nodeRegs.glideStep();
+
+        if (modulated) {
+            std::array<SampleType, kNumSplits> g;
+            std::array<SampleType, kNumSplits> k;
+            std::array<SampleType, kNumSplits> h;
+            for (size_t split = 0; split < kNumSplits; ++split) {
+                g[split] = modulatedG(split, n);
+                k[split] = r2 + g[split];
+                h[split] = 1 / (1 + g[split] * k[split]);
+            }
+            for (size_t node = 0; node < kNumNodes; ++node) {
+                const auto split = static_cast<size_t>(Network::nodes[node].split);
+                regs[node].setCoefficients(g[split], k[split], h[split]);
+            }
+        }
+
+        for (size_t lane = 0; lane < groupChannels; ++lane)
+            x.set(lane, input[first + lane][n]);
+
+        std::array<Vec, kNumNodes> low{};
+        std::array<Vec, kNumNodes> high{};
+        unroll<kNumNodes>([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            constexpr auto node = Network::nodes[I];
+            const Vec in = tap<node.input>(x, low, high);
+
+            if constexpr (node.kind == Network::Kind::split)
+                regs[I].process(in, low[I], high[I]);
+            else
+                regs[I].processAllpass(in, low[I]);
+        });
+
+        for (size_t lane = 0; lane < groupChannels; ++lane) {
+            unroll<static_cast<size_t>(NumBands)>([&](auto b) {
+                constexpr size_t B = decltype(b)::value;
+                sink(B, first + lane, n, tap<Network::bands[B]>(x, low, high).get(lane));
+            });
+        }
+    }
+
+    for (size_t node = 0; node < kNumNodes; ++node) regs[node].store(groupBanks[node]);
+}
+
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runTimeParallel(size_t first,
+                                                      const SampleType* const* input,
+                                                      size_t numChannels, size_t numSamples,
+                                                      Sink& sink) {
+    const size_t end = isPipelined() ? numChannels : std::min(first + kNumLanes, numChannels);
+
+    struct alignas(16) NodeBuffer {
+        SampleType v[kTimeParallelChunk];
+    };
+    std::array<NodeBuffer, kNumNodes> low;
+    std::array<NodeBuffer, kNumNodes> high;
+    std::array<const SampleType*, kNumNodes> lowOut{};
+    std::array<const SampleType*, kNumNodes> highOut{};
+    for (size_t node = 0; node < kNumNodes; ++node) {
+        lowOut[node] = low[node].v;
+        highOut[node] = high[node].v;
+    }
+
+    // Each chunk is read in full before its bands go out, which keeps in-place
+    // processing safe
+    for (size_t ch = first; ch < end; ++ch) {
+        for (size_t start = 0; start < numSamples; start += kTimeParallelChunk) {
+            const size_t length = std::min(kTimeParallelChunk, numSamples - start);
+            const SampleType* x = input[ch] + start;
 
-    float mid = 0.0f;
-    float high = 0.0f;
-    midHighSplit_.processSample(channel, hp1Out, mid, high);
+            unroll<kNumNodes>([&](auto i) {
+                constexpr size_t I = decltype(i)::value;
+                constexpr auto node = Network::nodes[I];
+                runNodeTimeParallel<node.kind == Network::Kind::split>(
+                    blockMatrices_[I], nodeLane(I, ch), tap<node.input>(x, lowOut, highOut),
+                    low[I].v, high[I].v, length);
+            });
 
-    return {low, mid, high};
+            for (size_t n = 0; n < length; ++n) {
+                unroll<static_cast<size_t>(NumBands)>([&](auto b) {
+                    constexpr size_t B = decltype(b)::value;
+                    sink(B, ch, start + n, tap<Network::bands[B]>(x, lowOut, highOut)[n]);
+                });
+            }
+        }
+    }
 }
 
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runPipelinedAllpassSum(const SampleType* const* input,
+                                                             size_t numChannels,
+                                                             size_t numSamples, Sink& sink) {
+    if constexpr (kMaxPipelinedChannels == 0) {
+        juce::ignoreUnused(input, numChannels, numSamples, sink);
+        jassertfalse;
+    } else {
+        // With two splits, split 1 runs a sample behind split 0 on its LP + HP. Its lanes
+        // step the whole LR4, but only the first SVF's LP + HP is taken from them.
+        constexpr size_t kLag = kNumSplitNodes - 1;
+        constexpr auto laneOf = [](size_t split, size_t ch) {
+            return split * kMaxPipelinedChannels + ch;
+        };
+
+        auto& bank = banks_.front();
+        const size_t last = numSamples - 1;
+        LaneArray carry;
+
+        // Prologue: split 0 alone on sample 0
+        if constexpr (kLag > 0) {
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                SampleType low;
+                SampleType high;
+                bank.processLane(laneOf(0, ch), input[ch][0], low, high);
+                carry.v[laneOf(1, ch)] = low + high;
+            }
+        }
+
+        BankRegisters regs;
+        regs.load(bank);
+
+        // All input for sample n is read before the sum of n - kLag is written, which
+        // keeps in-place processing safe
+        auto x = Vec::expand(0);
+        for (size_t n = kLag; n <= last; ++n) {
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                x.set(laneOf(0, ch), input[ch][n]);
+                if constexpr (kLag > 0) x.set(laneOf(1, ch), carry.v[laneOf(1, ch)]);
+            }
+
+            Vec lp;
+            Vec hp;
+            regs.process(x, lp, hp);
+            const Vec ap = lp + hp;
+
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                sink(0, ch, n - kLag, ap.get(laneOf(kLag, ch)));
+                if constexpr (kLag > 0) carry.v[laneOf(1, ch)] = ap.get(laneOf(0, ch));
+            }
+        }
+
+        regs.store(bank);
+
+        // Epilogue: split 1 drains the final sample
+        if constexpr (kLag > 0) {
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                SampleType sum;
+                bank.processAllpassLane(laneOf(1, ch), carry.v[laneOf(1, ch)], sum);
+                sink(0, ch, last, sum);
+            }
+        }
+    }
+}
+
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runGroupedAllpassSum(size_t first,
+                                                           const SampleType* const* input,
+                                                           size_t numChannels,
+                                                           size_t numSamples, Sink& sink) {
+    const size_t groupChannels = std::min(kNumLanes, numChannels - first);
+    SectionBank* groupBanks = banks_.data() + (first / kNumLanes) * kNumNodes;
+
+    std::array<BankRegisters, kNumSplitNodes> regs;
+    for (size_t split = 0; split < kNumSplitNodes; ++split) regs[split].load(groupBanks[split]);
+
+    // Lanes beyond groupChannels stay at zero input, so their state stays silent.
+    auto x = Vec::expand(0);
+    for (size_t n = 0; n < numSamples; ++n) {
+        for (size_t lane = 0; lane < groupChannels; ++lane)
+            x.set(lane, input[first + lane][n]);
+
+        Vec low;
+        Vec high;
+        regs[0].process(x, low, high);
+        Vec y = low + high;
+        unroll<kNumSplitNodes - 1>(
+            [&](auto split) { regs[decltype(split)::value + 1].processAllpass(y, y); });
+
+        for (size_t lane = 0; lane < groupChannels; ++lane) sink(0, first + lane, n, y.get(lane));
+    }
+
+    for (size_t split = 0; split < kNumSplitNodes; ++split) regs[split].store(groupBanks[split]);
+}
+
+template <typename SampleType, int NumBands>
+template <typename Sink>
+void Crossover<SampleType, NumBands>::runTimeParallelAllpassSum(size_t first,
+                                                                const SampleType* const* input,
+                                                                size_t numChannels,
+                                                                size_t numSamples,
+                                                                Sink& sink) {
+    const size_t end = isPipelined() ? numChannels : std::min(first + kNumLanes, numChannels);
+
+    struct alignas(16) NodeBuffer {
+        SampleType v[kTimeParallelChunk];
+    };
+    NodeBuffer sum;
+    NodeBuffer high;
+
+    // Each chunk is read in full before its sum goes out, which keeps in-place
+    // processing safe
+    for (size_t ch = first; ch < end; ++ch) {
+        for (size_t start = 0; start < numSamples; start += kTimeParallelChunk) {
+            const size_t length = std::min(kTimeParallelChunk, numSamples - start);
+
+            runNodeTimeParallel<true>(blockMatrices_[0], nodeLane(0, ch), input[ch] + start,
+                                      sum.v, high.v, length);
+            for (size_t n = 0; n < length; ++n) sum.v[n] += high.v[n];
+            unroll<kNumSplitNodes - 1>([&](auto i) {
+                constexpr size_t kSplit = decltype(i)::value + 1;
+                constexpr size_t kForm = allpassOn<Network>(static_cast<int>(kSplit));
+                runNodeTimeParallel<false>(blockMatrices_[kForm], nodeLane(kSplit, ch), sum.v,
+                                           sum.v, high.v, length);
+            });
+
+            for (size_t n = 0; n < length; ++n) sink(0, ch, start + n, sum.v[n]);
+        }
+    }
+}
+
+template <typename SampleType, int NumBands>
+template <bool IsSplit>
+void Crossover<SampleType, NumBands>::runNodeTimeParallel(const BlockMatrices& m,
+                                                          LaneRef state,
+                                                          const SampleType* in,
+                                                          SampleType* low, SampleType* high,
+                                                          size_t numSamples) {
+    constexpr size_t kStates = IsSplit ? kSectionStates : 2;
+    auto& bank = banks_[state.bank];
+    const size_t lane = state.lane;
+
+    std::array<Vec, kStates> stateToLow;
+    std::array<Vec, kStates> stateToHigh;
+    std::array<std::array<Vec, kStateVecs>, kStates> stateToState;
+    for (size_t i = 0; i < kStates; ++i) {
+        stateToLow[i] = Vec::fromRawArray(m.stateToLow[i].v);
+        stateToHigh[i] = Vec::fromRawArray(m.stateToHigh[i].v);
+        for (size_t v = 0; v < kStateVecs; ++v)
+            stateToState[i][v] = Vec::fromRawArray(m.stateToState[i][v].v);
+    }
+    std::array<Vec, kNumLanes> inputToLow;
+    std::array<Vec, kNumLanes> inputToHigh;
+    std::array<std::array<Vec, kStateVecs>, kNumLanes> inputToState;
+    for (size_t j = 0; j < kNumLanes; ++j) {
+        inputToLow[j] = Vec::fromRawArray(m.inputToLow[j].v);
+        inputToHigh[j] = Vec::fromRawArray(m.inputToHigh[j].v);
+        for (size_t v = 0; v < kStateVecs; ++v)
+            inputToState[j][v] = Vec::fromRawArray(m.inputToState[j][v].v);
+    }
+
+    std::array<SampleType, kSectionStates> z = {bank.s1.v[lane], bank.s2.v[lane],
+                                                bank.s3.v[lane], bank.s4.v[lane]};
+
+    const size_t vectorSamples = numSamples - numSamples % kNumLanes;
+    for (size_t n = 0; n < vectorSamples; n += kNumLanes) {
+        Vec lowOut = inputToLow[0] * in[n];
+        Vec highOut = IsSplit ? inputToHigh[0] * in[n] : Vec::expand(0);
+        std::array<Vec, kStateVecs> next;
+        for (size_t v = 0; v < kStateVecs; ++v) next[v] = inputToState[0][v] * in[n];
+
+        for (size_t j = 1; j < kNumLanes; ++j) {
+            lowOut += inputToLow[j] * in[n + j];
+            if constexpr (IsSplit) highOut += inputToHigh[j] * in[n + j];
+            for (size_t v = 0; v < kStateVecs; ++v) next[v] += inputToState[j][v] * in[n + j];
+        }
+        for (size_t i = 0; i < kStates; ++i) {
+            lowOut += stateToLow[i] * z[i];
+            if constexpr (IsSplit) highOut += stateToHigh[i] * z[i];
+            for (size_t v = 0; v < kStateVecs; ++v) next[v] += stateToState[i][v] * z[i];
+        }
+
+        lowOut.copyToRawArray(low + n);
+        if constexpr (IsSplit) highOut.copyToRawArray(high + n);
+        for (size_t i = 0; i < kStates; ++i) z[i] = next[i / kNumLanes].get(i % kNumLanes);
+    }
+
+    bank.s1.v[lane] = z[0];
+    bank.s2.v[lane] = z[1];
+    bank.s3.v[lane] = z[2];
+    bank.s4.v[lane] = z[3];
+
+    for (size_t n = vectorSamples; n < numSamples; ++n) {
+        if constexpr (IsSplit)
+            bank.processLane(lane, in[n], low[n], high[n]);
+        else
+            bank.processAllpassLane(lane, in[n], low[n]);
+    }
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::processBlock(const SampleType* const* input,
+                                                   const Bands& bands, int numChannels,
+                                                   int numSamples) {
+    for (int group = 0; group < getNumGroups(numChannels); ++group)
+        processGroup(group, input, bands, numChannels, numSamples);
+    endBlock(numSamples);
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::processBlockSummed(const SampleType* const* input,
+                                                         SampleType* const* output,
+                                                         int numChannels, int numSamples) {
+    for (int group = 0; group < getNumGroups(numChannels); ++group)
+        processGroupSummed(group, input, output, numChannels, numSamples);
+    endBlock(numSamples);
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::processGroup(int group, const SampleType* const* input,
+                                                   const Bands& bands, int numChannels,
+                                                   int numSamples) {
+    jassert(!allpassSum_);
+    runGroup(group, input, numChannels, numSamples,
+             [&bands](size_t band, size_t ch, size_t n, SampleType value) {
+                 bands[band][ch][n] = value;
+             });
+}
+
+template <typename SampleType, int NumBands>
+void Crossover<SampleType, NumBands>::processGroupSummed(int group,
+                                                         const SampleType* const* input,
+                                                         SampleType* const* output,
+                                                         int numChannels, int numSamples) {
+    if (allpassSum_) {
+        runGroup(group, input, numChannels, numSamples,
+                 [output](size_t, size_t ch, size_t n, SampleType sum) { output[ch][n] = sum; });
+        return;
+    }
+
+    // The bands of sample n can arrive over two steps, so their running sum waits here.
+    SampleType pendingSum[kMaxChannels] = {};
+    constexpr auto lastBand = static_cast<size_t>(NumBands - 1);
+
+    runGroup(group, input, numChannels, numSamples,
+             [&pendingSum, output](size_t band, size_t ch, size_t n, SampleType value) {
+                 pendingSum[ch] = band == 0 ? value : pendingSum[ch] + value;
+                 if (band == lastBand) output[ch][n] = pendingSum[ch];
+             });
+}
+
+template struct CrossoverCoefficients<2>;
+template struct CrossoverCoefficients<3>;
+template struct CrossoverCoefficients<4>;
+template struct CrossoverCoefficients<5>;
+template struct CrossoverCoefficients<6>;
+
+template class Crossover<float, 2>;
+template class Crossover<float, 3>;
+template class Crossover<float, 4>;
+template class Crossover<float, 5>;
+template class Crossover<float, 6>;
+template class Crossover<double, 2>;
+template class Crossover<double, 3>;
+template class Crossover<double, 4>;
+template class Crossover<double, 5>;
+template class Crossover<double, 6>;
+
 }  // namespace audio_plugin
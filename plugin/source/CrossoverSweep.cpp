@@ -0,0 +1,101 @@
+#include <Iso3D/CrossoverSweep.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_plugin {
+
+void CrossoverSweep::prepare(double sampleRate, int maxSamples) {
+    sampleRate_ = sampleRate;
+    table_ = CrossoverCoefficientTable::make(sampleRate);
+
+    constexpr std::array<float, kNumSplits> minHz = {kLowMidCrossoverMinHz,
+                                                     kMidHighCrossoverMinHz};
+    constexpr std::array<float, kNumSplits> maxHz = {kLowMidCrossoverMaxHz,
+                                                     kMidHighCrossoverMaxHz};
+    for (size_t split = 0; split < kNumSplits; ++split) {
+        minPositions_[split] = CrossoverCoefficientTable::positionOf(minHz[split]);
+        maxPositions_[split] = CrossoverCoefficientTable::positionOf(maxHz[split]);
+        positions_[split].assign(static_cast<size_t>(juce::jmax(1, maxSamples)), 0.0f);
+    }
+
+    rate_ = 0.0f;
+    reset();
+}
+
+void CrossoverSweep::reset() {
+    cos_ = 1.0;
+    sin_ = 0.0;
+    depth_ = 0.0f;
+}
+
+bool CrossoverSweep::advance(const Frequencies& frequenciesHz, float depthOctaves, float rateHz,
+                             int numSamples) {
+    constexpr auto kStepsPerOctave =
+        static_cast<float>(CrossoverCoefficientTable::kStepsPerOctave);
+    const float depth = juce::jlimit(0.0f, kMaxSweepOctaves, depthOctaves) * kStepsPerOctave;
+
+    std::array<float, kNumSplits> centres{};
+    for (size_t split = 0; split < kNumSplits; ++split)
+        centres[split] = CrossoverCoefficientTable::positionOf(frequenciesHz[split]);
+
+    const bool wasActive = depth_ > 0.0f;
+    if (!wasActive) {
+        centres_ = centres;
+        cos_ = 1.0;
+        sin_ = 0.0;
+        if (depth <= 0.0f) return false;
+    }
+
+    const float rate = juce::jlimit(kMinSweepRateHz, kMaxSweepRateHz, rateHz);
+    if (!juce::exactlyEqual(rate, rate_)) {
+        rate_ = rate;
+        const double step =
+            juce::MathConstants<double>::twoPi * static_cast<double>(rate) / sampleRate_;
+        rotationCos_ = std::cos(step);
+        rotationSin_ = std::sin(step);
+    }
+
+    // Depth and split points reach this call's values on its last sample
+    const auto samples = static_cast<size_t>(
+        juce::jlimit(0, static_cast<int>(positions_.front().size()), numSamples));
+    const float scale = samples > 0 ? 1.0f / static_cast<float>(samples) : 0.0f;
+    const float depthStep = (depth - depth_) * scale;
+    std::array<float, kNumSplits> centreSteps{};
+    for (size_t split = 0; split < kNumSplits; ++split)
+        centreSteps[split] = (centres[split] - centres_[split]) * scale;
+
+    double c = cos_;
+    double s = sin_;
+    for (size_t n = 0; n < samples; ++n) {
+        const auto ramp = static_cast<float>(n + 1);
+        const float offset = (depth_ + depthStep * ramp) * static_cast<float>(s);
+        for (size_t split = 0; split < kNumSplits; ++split) {
+            const float centre = centres_[split] + centreSteps[split] * ramp;
+            positions_[split][n] =
+                juce::jlimit(minPositions_[split], maxPositions_[split], centre + offset);
+        }
+
+        const double nextC = c * rotationCos_ - s * rotationSin_;
+        s = s * rotationCos_ + c * rotationSin_;
+        c = nextC;
+    }
+
+    // Rounding errors would otherwise build up in the phasor's magnitude
+    const double magnitude = std::sqrt(c * c + s * s);
+    cos_ = c / magnitude;
+    sin_ = s / magnitude;
+
+    depth_ = depth;
+    centres_ = centres;
+    return true;
+}
+
+CrossoverSweep::Positions CrossoverSweep::getPositions() const {
+    Positions positions{};
+    for (size_t split = 0; split < kNumSplits; ++split)
+        positions[split] = positions_[split].data();
+    return positions;
+}
+
+}  // namespace audio_plugin
@@ -0,0 +1,74 @@
+#include <Iso3D/CrossoverTuner.h>
+
+#include <algorithm>
+
+namespace audio_plugin {
+
+namespace {
+
+constexpr int kPollIntervalMs = 5;
+constexpr int kStopTimeoutMs = 1000;
+
+bool sameFrequencies(const CrossoverTuner::Frequencies& a, const CrossoverTuner::Frequencies& b) {
+    return std::equal(a.begin(), a.end(), b.begin(),
+                      [](float x, float y) { return juce::exactlyEqual(x, y); });
+}
+
+}  // namespace
+
+CrossoverTuner::CrossoverTuner(const std::atomic<float>& lowMidHz,
+                               const std::atomic<float>& midHighHz)
+    : juce::Thread("Iso3D crossover tuner"), lowMidHz_(lowMidHz), midHighHz_(midHighHz) {}
+
+CrossoverTuner::~CrossoverTuner() { stop(); }
+
+CrossoverTuner::Frequencies CrossoverTuner::start(double sampleRate, bool realtime) {
+    stop();
+
+    sampleRate_ = sampleRate;
+    publishedFrequencies_ = {lowMidHz_.load(), midHighHz_.load()};
+    publishedKernelFrequencies_ = publishedFrequencies_;
+    published_.clear();
+    publishedKernel_.clear();
+
+    setRealtime(realtime);
+    return publishedFrequencies_;
+}
+
+void CrossoverTuner::stop() { stopThread(kStopTimeoutMs); }
+
+void CrossoverTuner::setRealtime(bool realtime) {
+    if (!realtime)
+        stop();
+    else if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void CrossoverTuner::update() {
+    if (!isThreadRunning()) tune();
+}
+
+void CrossoverTuner::run() {
+    while (!threadShouldExit()) {
+        tune();
+        wait(kPollIntervalMs);
+    }
+}
+
+void CrossoverTuner::tune() {
+    const Frequencies frequencies = {lowMidHz_.load(), midHighHz_.load()};
+
+    // A refused push means the audio thread has not taken the last result yet; the
+    // frequencies still differ next time round, so it is retried then.
+    if (!sameFrequencies(frequencies, publishedFrequencies_)
+        && published_.push(CrossoverCoefficients<>::make(sampleRate_, frequencies)))
+        publishedFrequencies_ = frequencies;
+
+    // Kernels take a few FFTs to design, so none is built that would be refused
+    if (!sameFrequencies(frequencies, publishedKernelFrequencies_)
+        && publishedKernel_.canPush()
+        && publishedKernel_.push(LinearPhaseKernel<>::make(sampleRate_, frequencies)))
+        publishedKernelFrequencies_ = frequencies;
+}
+
+}  // namespace audio_plugin
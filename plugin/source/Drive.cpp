@@ -0,0 +1,150 @@
+#include <Iso3D/Drive.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_plugin {
+
+namespace {
+
+// Elliptic half-band allpass coefficients for a transition band of 0.04 (of the
+// oversampled rate), from the standard design by Jacobi's elliptic functions
+constexpr std::array<double, 8> kHalfBandCoefficients = {
+    0.04063346092419326, 0.1505051290226746, 0.30075705599187408, 0.46077450496145061,
+    0.6095243148961883,  0.73850384111885725, 0.84922381039206607, 0.9497427837050002};
+
+// Coefficients of one allpass path: even-indexed for the first, odd for the second
+template <typename SampleType, size_t First>
+constexpr auto kPathCoefficients = [] {
+    std::array<SampleType, HalfBandOversampler<SampleType>::kNumCoefficients / 2> path{};
+    for (size_t section = 0; section < path.size(); ++section)
+        path[section] = static_cast<SampleType>(kHalfBandCoefficients[2 * section + First]);
+    return path;
+}();
+
+// Drive 0 is linear; tanh(k x) / k meets it continuously as k goes to 0
+constexpr float kMinDrive = 1.0e-4f;
+
+template <typename SampleType>
+SampleType saturate(SampleType x, SampleType k) {
+    return k > static_cast<SampleType>(kMinDrive) ? std::tanh(k * x) / k : x;
+}
+
+template <typename SampleType>
+SampleType moveTowards(SampleType value, SampleType target, SampleType step) {
+    return value < target ? std::min(value + step, target) : std::max(value - step, target);
+}
+
+}  // namespace
+
+template <typename SampleType>
+SampleType HalfBandOversampler<SampleType>::AllpassPath::process(
+    SampleType input, const PathCoefficients& coefficients) {
+    for (size_t section = 0; section < kPathSections; ++section) {
+        const SampleType output =
+            coefficients[section] * (input - lastOutputs[section]) + lastInputs[section];
+        lastInputs[section] = input;
+        lastOutputs[section] = output;
+        input = output;
+    }
+    return input;
+}
+
+template <typename SampleType>
+std::array<SampleType, 2> HalfBandOversampler<SampleType>::upsample(SampleType input) {
+    return {upEven_.process(input, kPathCoefficients<SampleType, 0>),
+            upOdd_.process(input, kPathCoefficients<SampleType, 1>)};
+}
+
+template <typename SampleType>
+SampleType HalfBandOversampler<SampleType>::downsample(SampleType first, SampleType second) {
+    const SampleType even = downEven_.process(second, kPathCoefficients<SampleType, 0>);
+    const SampleType odd = downOdd_.process(first, kPathCoefficients<SampleType, 1>);
+    return SampleType{0.5} * (even + odd);
+}
+
+template <typename SampleType>
+void HalfBandOversampler<SampleType>::reset() {
+    upEven_ = {};
+    upOdd_ = {};
+    downEven_ = {};
+    downOdd_ = {};
+}
+
+template <typename SampleType>
+SampleType HalfBandOversampler<SampleType>::getMagnitude() const {
+    SampleType magnitude = 0;
+    for (const auto* path : {&upEven_, &upOdd_, &downEven_, &downOdd_})
+        for (size_t section = 0; section < kPathSections; ++section)
+            magnitude = std::max({magnitude, std::abs(path->lastInputs[section]),
+                                  std::abs(path->lastOutputs[section])});
+    return magnitude;
+}
+
+template <typename SampleType>
+void DriveStage<SampleType>::prepare(double sampleRate, int numChannels) {
+    oversamplers_.assign(static_cast<size_t>(std::max(numChannels, 0)), {});
+    const double fadeSamples = static_cast<double>(kDriveFadeTimeSec) * sampleRate;
+    step_ = static_cast<SampleType>(1.0 / std::max(1.0, fadeSamples));
+    mix_ = 0;
+    drive_ = 0;
+}
+
+template <typename SampleType>
+void DriveStage<SampleType>::reset() {
+    for (auto& oversampler : oversamplers_) oversampler.reset();
+    mix_ = 0;
+    drive_ = 0;
+}
+
+template <typename SampleType>
+void DriveStage<SampleType>::process(SampleType* const* channels, int numChannels,
+                                     int numSamples, SampleType amount) {
+    // Off and faded out: nothing to do
+    if (amount <= 0 && mix_ <= 0) return;
+
+    const SampleType mixTarget = amount > 0 ? SampleType{1} : SampleType{0};
+    const auto maxDrive = static_cast<SampleType>(kMaxDrive);
+    numChannels = std::min(numChannels, static_cast<int>(oversamplers_.size()));
+
+    // Every channel follows the same ramps, from where the last block left them
+    for (int ch = 0; ch < numChannels; ++ch) {
+        auto& oversampler = oversamplers_[static_cast<size_t>(ch)];
+        SampleType* data = channels[ch];
+        SampleType mix = mix_;
+        SampleType drive = drive_;
+
+        for (int i = 0; i < numSamples; ++i) {
+            mix = moveTowards(mix, mixTarget, step_);
+            drive = moveTowards(drive, amount, step_);
+            const SampleType k = drive * maxDrive;
+
+            const auto upsampled = oversampler.upsample(data[i]);
+            const SampleType driven =
+                oversampler.downsample(saturate(upsampled[0], k), saturate(upsampled[1], k));
+            data[i] += mix * (driven - data[i]);
+        }
+    }
+
+    const auto blockStep = step_ * static_cast<SampleType>(numSamples);
+    mix_ = moveTowards(mix_, mixTarget, blockStep);
+    drive_ = moveTowards(drive_, amount, blockStep);
+
+    // Faded out: the filters start from rest the next time drive comes up
+    if (mix_ <= 0) reset();
+}
+
+template <typename SampleType>
+bool DriveStage<SampleType>::isSilent(SampleType threshold) const {
+    return std::all_of(oversamplers_.begin(), oversamplers_.end(),
+                       [threshold](const auto& oversampler) {
+                           return oversampler.getMagnitude() < threshold;
+                       });
+}
+
+template class HalfBandOversampler<float>;
+template class HalfBandOversampler<double>;
+template class DriveStage<float>;
+template class DriveStage<double>;
+
+}  // namespace audio_plugin
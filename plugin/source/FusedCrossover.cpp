@@ -0,0 +1,606 @@
+#include <Iso3D/FusedCrossover.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_plugin {
+
+namespace {
+
+template <size_t N>
+using SquareMatrix = std::array<std::array<double, N>, N>;
+
+template <size_t N>
+SquareMatrix<N> identity() {
+    SquareMatrix<N> m{};
+    for (size_t i = 0; i < N; ++i) m[i][i] = 1.0;
+    return m;
+}
+
+template <size_t N>
+SquareMatrix<N> multiply(const SquareMatrix<N>& a, const SquareMatrix<N>& b) {
+    SquareMatrix<N> product{};
+    for (size_t i = 0; i < N; ++i)
+        for (size_t k = 0; k < N; ++k)
+            for (size_t j = 0; j < N; ++j) product[i][j] += a[i][k] * b[k][j];
+    return product;
+}
+
+template <size_t N>
+std::array<double, N> multiply(const SquareMatrix<N>& a, const std::array<double, N>& x) {
+    std::array<double, N> product{};
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < N; ++j) product[i] += a[i][j] * x[j];
+    return product;
+}
+
+// Solves a x = b by Gaussian elimination with partial pivoting
+template <size_t N>
+std::array<double, N> solve(SquareMatrix<N> a, std::array<double, N> b) {
+    for (size_t col = 0; col < N; ++col) {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < N; ++row)
+            if (std::abs(a[row][col]) > std::abs(a[pivot][col])) pivot = row;
+        std::swap(a[col], a[pivot]);
+        std::swap(b[col], b[pivot]);
+
+        for (size_t row = col + 1; row < N; ++row) {
+            const double factor = a[row][col] / a[col][col];
+            for (size_t j = col; j < N; ++j) a[row][j] -= factor * a[col][j];
+            b[row] -= factor * b[col];
+        }
+    }
+
+    std::array<double, N> x{};
+    for (size_t row = N; row-- > 0;) {
+        double sum = b[row];
+        for (size_t j = row + 1; j < N; ++j) sum -= a[row][j] * x[j];
+        x[row] = sum / a[row][row];
+    }
+    return x;
+}
+
+template <size_t N>
+SquareMatrix<N> inverse(const SquareMatrix<N>& a) {
+    SquareMatrix<N> result{};
+    for (size_t col = 0; col < N; ++col) {
+        std::array<double, N> unit{};
+        unit[col] = 1.0;
+        const auto x = solve(a, unit);
+        for (size_t row = 0; row < N; ++row) result[row][col] = x[row];
+    }
+    return result;
+}
+
+// X with A21 + A22 X - X A11 = 0, A11 being the Cols states from 0 of a block lower
+// triangular a and A22 the Rows states from offset. With states s = [I 0; X I] s~, the
+// latter's dependence on the former vanishes.
+template <size_t Rows, size_t Cols, size_t N>
+std::array<std::array<double, Cols>, Rows> decoupling(const SquareMatrix<N>& a, size_t offset) {
+    SquareMatrix<Rows * Cols> sylvester{};
+    std::array<double, Rows * Cols> coupling{};
+    for (size_t i = 0; i < Rows; ++i) {
+        for (size_t j = 0; j < Cols; ++j) {
+            const size_t row = i * Cols + j;
+            coupling[row] = -a[offset + i][j];
+            for (size_t k = 0; k < Rows; ++k)
+                sylvester[row][k * Cols + j] += a[offset + i][offset + k];
+            for (size_t k = 0; k < Cols; ++k) sylvester[row][i * Cols + k] -= a[k][j];
+        }
+    }
+    const auto flat = solve(sylvester, coupling);
+
+    std::array<std::array<double, Cols>, Rows> x{};
+    for (size_t i = 0; i < Rows; ++i)
+        for (size_t j = 0; j < Cols; ++j) x[i][j] = flat[i * Cols + j];
+    return x;
+}
+
+// Multiplication by the complex number re + i im as a 2x2 matrix, which commutes with
+// every rotation [s w; -w s]. Its first column is (re, im).
+SquareMatrix<2> complexMatrix(double re, double im) { return {{{re, -im}, {im, re}}}; }
+
+// [[topLeft, 0], [bottomLeft, bottomRight]] from 2x2 blocks
+SquareMatrix<4> blockLower(const SquareMatrix<2>& topLeft, const SquareMatrix<2>& bottomLeft,
+                           const SquareMatrix<2>& bottomRight) {
+    SquareMatrix<4> m{};
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 2; ++j) {
+            m[i][j] = topLeft[i][j];
+            m[i + 2][j] = bottomLeft[i][j];
+            m[i + 2][j + 2] = bottomRight[i][j];
+        }
+    }
+    return m;
+}
+
+}  // namespace
+
+template <typename SampleType>
+typename FusedCrossover<SampleType>::Design FusedCrossover<SampleType>::Design::make(
+    const Coefficients& coefficients) {
+    constexpr size_t kInput = kNumStates;  // index of the input in a probe
+
+    // One step of the TPT network, exactly as Crossover runs it: states 0-3 are the
+    // low/mid LR4's integrators, 4-7 the mid/high one's, 8-9 the low band's mid/high
+    // allpass, and probe[kInput] the input
+    auto step = [&coefficients](std::array<double, kNumStates + 1> probe,
+                                std::array<double, kNumBands>& bands) {
+        using Tpt = Crossover<double, kNumBands>;
+        const double r2 = std::sqrt(2.0);
+        const auto& lowMid = coefficients.splits[0];
+        const auto& midHigh = coefficients.splits[1];
+
+        double lowMidLow = 0.0;
+        double lowMidHigh = 0.0;
+        Tpt::processSection(probe[kInput], probe[0], probe[1], probe[2], probe[3], lowMid.g,
+                            r2, lowMid.k, lowMid.h, lowMidLow, lowMidHigh);
+        Tpt::processSection(lowMidHigh, probe[4], probe[5], probe[6], probe[7], midHigh.g, r2,
+                            midHigh.k, midHigh.h, bands[1], bands[2]);
+        Tpt::processAllpassSection(lowMidLow, probe[8], probe[9], midHigh.g, r2, midHigh.k,
+                                   midHigh.h, bands[0]);
+        return probe;
+    };
+
+    // The step is linear, so unit probes give A and B column by column, and the bands'
+    // rows weight by weight
+    Matrix a{};
+    std::array<double, kNumStates> b{};
+    std::array<std::array<double, kNumStates + 1>, kNumBands> tptRows{};
+    for (size_t j = 0; j <= kNumStates; ++j) {
+        std::array<double, kNumStates + 1> probe{};
+        probe[j] = 1.0;
+        std::array<double, kNumBands> bands{};
+        const auto next = step(probe, bands);
+
+        for (size_t i = 0; i < kNumStates; ++i) (j < kInput ? a[i][j] : b[i]) = next[i];
+        for (size_t band = 0; band < kNumBands; ++band) tptRows[band][j] = bands[band];
+    }
+
+    // Decouple the mid/high section and the allpass from the low/mid section, which
+    // drives them both. Neither depends on the other, so each takes its own solve.
+    constexpr size_t kS = kSectionStates;
+    constexpr size_t kAllpass = kNumSections * kS;  // offset of the allpass states
+    Matrix decouple = identity<kNumStates>();
+    std::array<double, kNumStates> decoupledB = b;
+    auto applyDecoupling = [&](const auto& x, size_t offset) {
+        for (size_t i = 0; i < x.size(); ++i) {
+            for (size_t j = 0; j < kS; ++j) {
+                decouple[offset + i][j] = x[i][j];
+                decoupledB[offset + i] -= x[i][j] * b[j];
+            }
+        }
+    };
+    applyDecoupling(decoupling<kS, kS>(a, kS), kS);
+    applyDecoupling(decoupling<kAllpassStates, kS>(a, kAllpass), kAllpass);
+
+    Design design;
+    Matrix jordan{};
+    for (size_t index = 0; index < kNumSlots; ++index) {
+        const size_t offset = index * kS;
+        const SquareMatrix<2> m = {{{a[offset][offset], a[offset][offset + 1]},
+                                    {a[offset + 1][offset], a[offset + 1][offset + 1]}}};
+
+        // M's poles s +- i w. The real and imaginary parts of the eigenvector of s + i w
+        // turn M into the rotation [s w; -w s].
+        const double sigma = 0.5 * (m[0][0] + m[1][1]);
+        const double omega = std::sqrt(m[0][0] * m[1][1] - m[0][1] * m[1][0] - sigma * sigma);
+        const SquareMatrix<2> v = {{{m[0][1], 0.0}, {sigma - m[0][0], omega}}};
+        design.sigma[index] = sigma;
+        design.omega[index] = omega;
+
+        // The allpass is M alone: the rotation, and a complex P moving the input onto
+        // the first state
+        if (index == kNumSections) {
+            const std::array<double, 2> allpassB = {decoupledB[offset], decoupledB[offset + 1]};
+            const auto inputs = multiply(inverse(v), allpassB);
+            const auto transform = multiply(v, complexMatrix(inputs[0], inputs[1]));
+            for (size_t i = 0; i < kAllpassStates; ++i)
+                for (size_t j = 0; j < kAllpassStates; ++j)
+                    jordan[offset + i][offset + j] = transform[i][j];
+            continue;
+        }
+
+        // Each section is [M 0; N M]: two identical SVFs, the second fed by the first
+        const SquareMatrix<2> n = {{{a[offset + 2][offset], a[offset + 2][offset + 1]},
+                                    {a[offset + 3][offset], a[offset + 3][offset + 1]}}};
+
+        // In that basis the coupling V^-1 N V is a complex number plus a part that
+        // anticommutes with the rotation; [I 0; Y I] removes the latter, and scaling the
+        // second SVF by the former leaves the identity
+        const auto coupled = multiply(inverse(v), multiply(n, v));
+        const double re = 0.5 * (coupled[0][0] + coupled[1][1]);
+        const double im = 0.5 * (coupled[1][0] - coupled[0][1]);
+        const double p = 0.5 * (coupled[0][0] - coupled[1][1]);
+        const double q = 0.5 * (coupled[0][1] + coupled[1][0]);
+        const SquareMatrix<2> y = {{{q / (2.0 * omega), -p / (2.0 * omega)},
+                                    {-p / (2.0 * omega), -q / (2.0 * omega)}}};
+        const SquareMatrix<2> zero{};
+        auto transform = multiply(blockLower(v, zero, v),
+                                  multiply(blockLower(identity<2>(), y, identity<2>()),
+                                           blockLower(identity<2>(), zero,
+                                                      complexMatrix(re, im))));
+
+        // Last, the input: [P 0; Q P] with complex P and Q keeps the Jordan block and
+        // moves the input onto the first state alone
+        std::array<double, kS> sectionB{};
+        for (size_t i = 0; i < kS; ++i) sectionB[i] = decoupledB[offset + i];
+        const auto inputs = multiply(inverse(transform), sectionB);
+        const auto scale = complexMatrix(inputs[0], inputs[1]);
+        transform = multiply(transform,
+                             blockLower(scale, complexMatrix(inputs[2], inputs[3]), scale));
+
+        for (size_t i = 0; i < kS; ++i)
+            for (size_t j = 0; j < kS; ++j) jordan[offset + i][offset + j] = transform[i][j];
+    }
+
+    design.toTpt = multiply(decouple, jordan);
+    design.fromTpt = inverse(design.toTpt);
+
+    for (size_t band = 0; band < kNumBands; ++band) {
+        for (size_t j = 0; j < kNumStates; ++j)
+            for (size_t i = 0; i < kNumStates; ++i)
+                design.rows[band][j] += tptRows[band][i] * design.toTpt[i][j];
+        design.rows[band][kInput] = tptRows[band][kInput];
+    }
+    return design;
+}
+
+template <typename SampleType>
+class FusedCrossover<SampleType>::BankRun {
+public:
+    BankRun(SlotBank& bank, const ChannelGains* gains, size_t numChannels)
+        : bank_(bank), gains_(gains), numChannels_(numChannels) {
+        sigma_ = Vec::fromRawArray(bank.sigma.v);
+        omega_ = Vec::fromRawArray(bank.omega.v);
+        for (size_t k = 0; k < kRowSize; ++k) row_[k] = Vec::fromRawArray(bank.row[k].v);
+        u1_ = Vec::fromRawArray(bank.u1.v);
+        u2_ = Vec::fromRawArray(bank.u2.v);
+        w1_ = Vec::fromRawArray(bank.w1.v);
+        w2_ = Vec::fromRawArray(bank.w2.v);
+
+        for (const int channel : bank.channels)
+            if (isActive(channel) && gains[channel].ramps[0] != nullptr) ramping_ = true;
+
+        // Steady gains: the row only changes if they have
+        if (!ramping_ && updateGains(0)) buildRow();
+    }
+
+    ~BankRun() {
+        for (size_t k = 0; k < kRowSize; ++k) row_[k].copyToRawArray(bank_.row[k].v);
+        u1_.copyToRawArray(bank_.u1.v);
+        u2_.copyToRawArray(bank_.u2.v);
+        w1_.copyToRawArray(bank_.w1.v);
+        w2_.copyToRawArray(bank_.w2.v);
+    }
+
+    // Output of sample n for input x, from the state before it, then the state update
+    Vec step(Vec x, size_t n) {
+        if (ramping_) {
+            updateGains(n);
+            buildRow();
+        }
+
+        const Vec y = row_[0] * u1_ + row_[1] * u2_ + row_[2] * w1_ + row_[3] * w2_ + row_[4] * x;
+
+        const Vec u1 = sigma_ * u1_ + omega_ * u2_ + x;
+        const Vec u2 = sigma_ * u2_ - omega_ * u1_;
+        const Vec w1 = sigma_ * w1_ + omega_ * w2_ + u1_;
+        w2_ = sigma_ * w2_ - omega_ * w1_ + u2_;
+        w1_ = w1;
+        u1_ = u1;
+        u2_ = u2;
+        return y;
+    }
+
+    // As step(), for a bank of allpass slots alone: no w, and no input weight
+    Vec stepAllpass(Vec x, size_t n) {
+        if (ramping_) {
+            updateGains(n);
+            buildRow();
+        }
+
+        const Vec y = row_[0] * u1_ + row_[1] * u2_;
+
+        const Vec u1 = sigma_ * u1_ + omega_ * u2_ + x;
+        u2_ = sigma_ * u2_ - omega_ * u1_;
+        u1_ = u1;
+        return y;
+    }
+
+private:
+    bool isActive(int channel) const {
+        return channel >= 0 && static_cast<size_t>(channel) < numChannels_;
+    }
+
+    // Takes every active lane's gains at sample n into bank_.rowGains; true if any moved
+    bool updateGains(size_t n) {
+        bool changed = false;
+        for (size_t lane = 0; lane < kNumLanes; ++lane) {
+            const int channel = bank_.channels[lane];
+            if (!isActive(channel)) continue;
+
+            const auto& gains = gains_[channel];
+            for (size_t band = 0; band < kNumBands; ++band) {
+                const SampleType gain =
+                    gains.ramps[band] != nullptr ? gains.ramps[band][n] : gains.current[band];
+                auto& stored = bank_.rowGains[band].v[lane];
+                changed = changed || !juce::exactlyEqual(stored, gain);
+                stored = gain;
+            }
+        }
+        return changed;
+    }
+
+    void buildRow() {
+        std::array<Vec, kNumBands> gains;
+        for (size_t band = 0; band < kNumBands; ++band)
+            gains[band] = Vec::fromRawArray(bank_.rowGains[band].v);
+
+        for (size_t k = 0; k < kRowSize; ++k) {
+            row_[k] = gains[0] * Vec::fromRawArray(bank_.bandRows[0][k].v)
+                    + gains[1] * Vec::fromRawArray(bank_.bandRows[1][k].v)
+                    + gains[2] * Vec::fromRawArray(bank_.bandRows[2][k].v);
+        }
+    }
+
+    SlotBank& bank_;
+    const ChannelGains* gains_;
+    size_t numChannels_;
+    bool ramping_ = false;
+
+    Vec sigma_;
+    Vec omega_;
+    std::array<Vec, kRowSize> row_;
+    Vec u1_;
+    Vec u2_;
+    Vec w1_;
+    Vec w2_;
+};
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::prepare(double sampleRate, int numChannels) {
+    jassert(numChannels >= 1 && numChannels <= kMaxChannels);
+    numChannels_ = juce::jlimit(1, kMaxChannels, numChannels);
+
+    const auto channels = static_cast<size_t>(numChannels_);
+    const size_t numGroups = (channels + kNumLanes - 1) / kNumLanes;
+    banks_.assign(isFolded() ? 1 : kNumSlots * numGroups, SlotBank{});
+
+    for (auto& bank : banks_) {
+        bank.channels.fill(-1);
+        for (auto& gains : bank.rowGains)
+            std::fill(std::begin(gains.v), std::end(gains.v), SampleType{1});
+    }
+    for (size_t ch = 0; ch < channels; ++ch) {
+        for (size_t index = 0; index < kNumSlots; ++index) {
+            const auto ref = slot(ch, index);
+            banks_[ref.bank].channels[ref.lane] = static_cast<int>(ch);
+        }
+    }
+
+    setCoefficients(Coefficients::make(sampleRate, Coefficients::defaultFrequencies()));
+    reset();
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::reset() {
+    for (auto& bank : banks_) {
+        bank.u1 = {};
+        bank.u2 = {};
+        bank.w1 = {};
+        bank.w2 = {};
+    }
+}
+
+template <typename SampleType>
+typename FusedCrossover<SampleType>::SlotRef FusedCrossover<SampleType>::slot(
+    size_t channel, size_t index) const {
+    if (isFolded()) return {0, index * static_cast<size_t>(numChannels_) + channel};
+    return {(channel / kNumLanes) * kNumSlots + index, channel % kNumLanes};
+}
+
+template <typename SampleType>
+std::array<double, FusedCrossover<SampleType>::kNumStates> FusedCrossover<SampleType>::tptState(
+    size_t channel) const {
+    std::array<double, kNumStates> z{};
+    for (size_t index = 0; index < kNumSlots; ++index) {
+        const auto ref = slot(channel, index);
+        const auto& bank = banks_[ref.bank];
+        const std::array<const LaneArray*, kSectionStates> states = {&bank.u1, &bank.u2,
+                                                                     &bank.w1, &bank.w2};
+        for (size_t k = 0; k < statesOf(index); ++k)
+            z[index * kSectionStates + k] = static_cast<double>(states[k]->v[ref.lane]);
+    }
+    return multiply(design_.toTpt, z);
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::setTptState(size_t channel,
+                                             const std::array<double, kNumStates>& state) {
+    const auto z = multiply(design_.fromTpt, state);
+
+    // The allpass slot's w stays at 0
+    for (size_t index = 0; index < kNumSlots; ++index) {
+        const auto ref = slot(channel, index);
+        auto& bank = banks_[ref.bank];
+        const std::array<LaneArray*, kSectionStates> states = {&bank.u1, &bank.u2, &bank.w1,
+                                                               &bank.w2};
+        for (size_t k = 0; k < kSectionStates; ++k) {
+            states[k]->v[ref.lane] =
+                k < statesOf(index) ? static_cast<SampleType>(z[index * kSectionStates + k]) : 0;
+        }
+    }
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::setCoefficients(const Coefficients& coefficients) {
+    const Design next = Design::make(coefficients);
+
+    // The TPT integrators hold the same values either side of the change
+    std::array<std::array<double, kNumStates>, kMaxChannels> states;
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) states[ch] = tptState(ch);
+    design_ = next;
+
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) {
+        setTptState(ch, states[ch]);
+        for (size_t index = 0; index < kNumSlots; ++index) {
+            const auto ref = slot(ch, index);
+            auto& bank = banks_[ref.bank];
+            const size_t lane = ref.lane;
+            const size_t offset = index * kSectionStates;
+            const size_t numStates = statesOf(index);
+
+            // The weights on the allpass slot's w stay at 0
+            bank.sigma.v[lane] = static_cast<SampleType>(next.sigma[index]);
+            bank.omega.v[lane] = static_cast<SampleType>(next.omega[index]);
+            for (size_t band = 0; band < kNumBands; ++band) {
+                auto& rows = bank.bandRows[band];
+                for (size_t k = 0; k < kSectionStates; ++k)
+                    rows[k].v[lane] =
+                        k < numStates ? static_cast<SampleType>(next.rows[band][offset + k]) : 0;
+                rows[kSectionStates].v[lane] =
+                    index == 0 ? static_cast<SampleType>(next.rows[band][kNumStates]) : 0;
+            }
+
+            // Rebuilt for the gains it was last built for
+            for (size_t k = 0; k < kRowSize; ++k) {
+                SampleType weight = 0;
+                for (size_t band = 0; band < kNumBands; ++band)
+                    weight += bank.rowGains[band].v[lane] * bank.bandRows[band][k].v[lane];
+                bank.row[k].v[lane] = weight;
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+bool FusedCrossover<SampleType>::isSilent(SampleType threshold) const {
+    for (int group = 0; group < getNumGroups(numChannels_); ++group)
+        if (!isGroupSilent(group, threshold)) return false;
+    return true;
+}
+
+template <typename SampleType>
+bool FusedCrossover<SampleType>::isGroupSilent(int group, SampleType threshold) const {
+    const auto first = static_cast<size_t>(group * getGroupSize());
+    const auto end = std::min(first + static_cast<size_t>(getGroupSize()),
+                              static_cast<size_t>(numChannels_));
+    for (size_t ch = first; ch < end; ++ch)
+        for (const double value : tptState(ch))
+            if (std::abs(value) >= static_cast<double>(threshold)) return false;
+    return true;
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::resetGroup(int group) {
+    const auto first = static_cast<size_t>(group * getGroupSize());
+    const auto end = std::min(first + static_cast<size_t>(getGroupSize()),
+                              static_cast<size_t>(numChannels_));
+    for (size_t ch = first; ch < end; ++ch) setTptState(ch, {});
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::takeState(const Crossover<SampleType>& crossover) {
+    jassert(crossover.getNumChannels() == numChannels_ && !crossover.isAllpassSum());
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) {
+        // Node order matches Design's: the two sections, then the allpass
+        const auto nodes = crossover.getChannelState(static_cast<int>(ch));
+        std::array<double, kNumStates> state{};
+        for (size_t index = 0; index < kNumSlots; ++index)
+            for (size_t k = 0; k < statesOf(index); ++k)
+                state[index * kSectionStates + k] = static_cast<double>(nodes[index][k]);
+        setTptState(ch, state);
+    }
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::handState(Crossover<SampleType>& crossover) const {
+    jassert(crossover.getNumChannels() == numChannels_ && !crossover.isAllpassSum());
+    for (size_t ch = 0; ch < static_cast<size_t>(numChannels_); ++ch) {
+        const auto state = tptState(ch);
+        typename Crossover<SampleType>::ChannelState nodes{};
+        for (size_t index = 0; index < kNumSlots; ++index)
+            for (size_t k = 0; k < statesOf(index); ++k)
+                nodes[index][k] = static_cast<SampleType>(state[index * kSectionStates + k]);
+        crossover.setChannelState(static_cast<int>(ch), nodes);
+    }
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::processBlock(const SampleType* const* input,
+                                              SampleType* const* output,
+                                              const ChannelGains* gains, int numChannels,
+                                              int numSamples) {
+    for (int group = 0; group < getNumGroups(numChannels); ++group)
+        processGroup(group, input, output, gains, numChannels, numSamples);
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::processGroup(int group, const SampleType* const* input,
+                                              SampleType* const* output,
+                                              const ChannelGains* gains, int numChannels,
+                                              int numSamples) {
+    jassert(numChannels >= 1 && numChannels <= numChannels_);
+    jassert(group >= 0 && group < getNumGroups(numChannels));
+    if (numSamples <= 0 || numChannels <= 0) return;
+
+    const auto channels = static_cast<size_t>(std::min(numChannels, numChannels_));
+    const auto samples = static_cast<size_t>(numSamples);
+    if (isFolded())
+        processFolded(input, output, gains, channels, samples);
+    else
+        processGrouped(static_cast<size_t>(group) * kNumLanes, input, output, gains, channels,
+                       samples);
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::processFolded(const SampleType* const* input,
+                                               SampleType* const* output,
+                                               const ChannelGains* gains, size_t numChannels,
+                                               size_t numSamples) {
+    // Lane ch + i * stride runs slot i of channel ch. The allpass lanes take the full
+    // step, their w running along unweighted.
+    const auto stride = static_cast<size_t>(numChannels_);
+    BankRun run(banks_[0], gains, numChannels);
+
+    auto x = Vec::expand(0);
+    for (size_t n = 0; n < numSamples; ++n) {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            for (size_t index = 0; index < kNumSlots; ++index)
+                x.set(ch + index * stride, input[ch][n]);
+
+        const Vec y = run.step(x, n);
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            SampleType sum = 0;
+            for (size_t index = 0; index < kNumSlots; ++index) sum += y.get(ch + index * stride);
+            output[ch][n] = sum;
+        }
+    }
+}
+
+template <typename SampleType>
+void FusedCrossover<SampleType>::processGrouped(size_t first, const SampleType* const* input,
+                                                SampleType* const* output,
+                                                const ChannelGains* gains, size_t numChannels,
+                                                size_t numSamples) {
+    const size_t groupChannels = std::min(kNumLanes, numChannels - first);
+    const size_t firstBank = (first / kNumLanes) * kNumSlots;
+    BankRun lowMid(banks_[firstBank], gains, numChannels);
+    BankRun midHigh(banks_[firstBank + 1], gains, numChannels);
+    BankRun allpass(banks_[firstBank + 2], gains, numChannels);
+
+    // Lanes beyond groupChannels stay at zero input, so their state stays silent.
+    auto x = Vec::expand(0);
+    for (size_t n = 0; n < numSamples; ++n) {
+        for (size_t lane = 0; lane < groupChannels; ++lane) x.set(lane, input[first + lane][n]);
+
+        const Vec y = lowMid.step(x, n) + midHigh.step(x, n) + allpass.stepAllpass(x, n);
+        for (size_t lane = 0; lane < groupChannels; ++lane) output[first + lane][n] = y.get(lane);
+    }
+}
+
+template class FusedCrossover<float>;
+template class FusedCrossover<double>;
+
+}  // namespace audio_plugin
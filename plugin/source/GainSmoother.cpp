@@ -0,0 +1,60 @@
+#include <Iso3D/GainSmoother.h>
+
+#include <cmath>
+
+namespace audio_plugin {
+
+template <typename SampleType>
+void GainSmoother<SampleType>::prepare(double sampleRate, int maxBlockSize) {
+    const double alpha =
+        1.0 - std::exp(-1.0 / (static_cast<double>(kGainSmoothTimeSec) * sampleRate));
+    const double r = 1.0 - alpha;
+
+    decay_.resize(static_cast<size_t>(juce::jmax(1, maxBlockSize)));
+    double decay = r;
+    for (auto& d : decay_) {
+        d = static_cast<SampleType>(decay);
+        decay *= r;
+    }
+
+    ramps_.setSize(kNumBands, static_cast<int>(decay_.size()));
+    reset(SampleType{1});
+}
+
+template <typename SampleType>
+void GainSmoother<SampleType>::reset(SampleType gain) {
+    current_.fill(gain);
+}
+
+template <typename SampleType>
+bool GainSmoother<SampleType>::advance(const Gains& targets, int numSamples) {
+    jassert(numSamples > 0 && numSamples <= static_cast<int>(decay_.size()));
+
+    const auto epsilon = static_cast<SampleType>(kGainSmoothEpsilon);
+    bool steady = true;
+    for (size_t band = 0; band < current_.size(); ++band) {
+        if (std::abs(current_[band] - targets[band]) <= epsilon)
+            current_[band] = targets[band];
+        else
+            steady = false;
+    }
+    if (steady) return true;
+
+    for (size_t band = 0; band < current_.size(); ++band) {
+        const SampleType target = targets[band];
+        const SampleType diff = current_[band] - target;
+        auto* ramp = ramps_.getWritePointer(static_cast<int>(band));
+
+        for (int n = 0; n < numSamples; ++n)
+            ramp[n] = target + diff * decay_[static_cast<size_t>(n)];
+
+        current_[band] = ramp[numSamples - 1];
+    }
+
+    return false;
+}
+
+template class GainSmoother<float>;
+template class GainSmoother<double>;
+
+}  // namespace audio_plugin
@@ -0,0 +1,89 @@
+#include <Iso3D/LoadProfiler.h>
+
+#include <algorithm>
+
+namespace audio_plugin {
+
+void LoadStats::writeTo(juce::OutputStream& stream) const {
+    stream.writeInt64(numBlocks);
+    stream.writeInt64(numOverruns);
+    stream.writeDouble(averageLoad);
+    stream.writeDouble(worstLoad);
+    stream.writeDouble(worstBlockMs);
+    stream.writeInt(worstBlockSize);
+    stream.writeByte(static_cast<char>(kNumBins));
+    for (const auto count : histogram) stream.writeInt64(count);
+}
+
+std::optional<LoadStats> LoadStats::readFrom(juce::InputStream& stream) {
+    constexpr juce::int64 kFixedSize = 2 * 8 + 3 * 8 + 4 + 1;
+    if (stream.getNumBytesRemaining() < kFixedSize) return std::nullopt;
+
+    LoadStats stats;
+    stats.numBlocks = stream.readInt64();
+    stats.numOverruns = stream.readInt64();
+    stats.averageLoad = stream.readDouble();
+    stats.worstLoad = stream.readDouble();
+    stats.worstBlockMs = stream.readDouble();
+    stats.worstBlockSize = stream.readInt();
+
+    const int numBins = static_cast<uint8_t>(stream.readByte());
+    if (numBins != kNumBins || stream.getNumBytesRemaining() < numBins * 8) return std::nullopt;
+    for (auto& count : stats.histogram) count = stream.readInt64();
+    return stats;
+}
+
+void LoadProfiler::prepare(double sampleRate, int samplesPerBlock) {
+    sampleRate_ = sampleRate;
+    samplesPerBlock_ = samplesPerBlock;
+    resetRequested_.store(false);
+    clear();
+}
+
+void LoadProfiler::clear() {
+    measurer_.reset(sampleRate_, samplesPerBlock_);
+    for (auto& count : histogram_) count.store(0, std::memory_order_relaxed);
+    numBlocks_.store(0, std::memory_order_relaxed);
+    worstLoad_.store(0.0, std::memory_order_relaxed);
+    worstBlockMs_.store(0.0, std::memory_order_relaxed);
+    worstBlockSize_.store(0, std::memory_order_relaxed);
+}
+
+void LoadProfiler::addBlock(double milliseconds, int numSamples) {
+    if (numSamples <= 0 || sampleRate_ <= 0.0) return;
+    if (resetRequested_.exchange(false, std::memory_order_acquire)) clear();
+
+    measurer_.registerRenderTime(milliseconds, numSamples);
+
+    const double budgetMs = 1000.0 * static_cast<double>(numSamples) / sampleRate_;
+    const double load = milliseconds / budgetMs;
+    const int bin = load > 1.0 ? LoadStats::kNumBins - 1
+                               : std::min(static_cast<int>(load / LoadStats::kBinWidth),
+                                          LoadStats::kNumBins - 2);
+
+    // Single writer, so counts are bumped without read-modify-write instructions
+    auto& count = histogram_[static_cast<size_t>(bin)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (load > worstLoad_.load(std::memory_order_relaxed)) {
+        worstLoad_.store(load, std::memory_order_relaxed);
+        worstBlockMs_.store(milliseconds, std::memory_order_relaxed);
+        worstBlockSize_.store(numSamples, std::memory_order_relaxed);
+    }
+    numBlocks_.store(numBlocks_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+LoadStats LoadProfiler::getStats() const {
+    LoadStats stats;
+    stats.numBlocks = numBlocks_.load(std::memory_order_acquire);
+    for (size_t bin = 0; bin < histogram_.size(); ++bin)
+        stats.histogram[bin] = histogram_[bin].load(std::memory_order_relaxed);
+    stats.numOverruns = stats.histogram.back();
+    stats.averageLoad = measurer_.getLoadAsProportion();
+    stats.worstLoad = worstLoad_.load(std::memory_order_relaxed);
+    stats.worstBlockMs = worstBlockMs_.load(std::memory_order_relaxed);
+    stats.worstBlockSize = worstBlockSize_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace audio_plugin
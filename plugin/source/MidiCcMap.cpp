@@ -0,0 +1,206 @@
+#include <Iso3D/MidiCcMap.h>
+
+#include <algorithm>
+
+namespace audio_plugin {
+
+namespace {
+
+constexpr uint32_t kLearnedFlag = 1u << 16;
+constexpr uint32_t kLearnedHighResolutionFlag = 1u << 15;
+
+constexpr float kMaxSevenBit = 127.0f;
+constexpr float kMaxFourteenBit = 16383.0f;
+
+const char* const kAssignmentTag = "Assignment";
+
+uint32_t packLearned(int channel, int controller) {
+    return kLearnedFlag | static_cast<uint32_t>(channel) << 8 | static_cast<uint32_t>(controller);
+}
+
+}  // namespace
+
+void MidiCcMap::assign(int target, const Assignment& assignment) {
+    jassert(target >= 0 && target < kNumTargets);
+    jassert(assignment.channel >= 1 && assignment.channel <= kNumChannels);
+    jassert(assignment.controller >= 0 && assignment.controller < kNumControllers);
+
+    clear(target);
+
+    // Only controllers 0-31 have an LSB partner
+    Assignment taken = assignment;
+    taken.highResolution =
+        assignment.highResolution && assignment.controller < kNumHighResolutionPairs;
+
+    removeSlot(taken.channel, taken.controller);
+    if (taken.highResolution) removeSlot(taken.channel, taken.controller + 32);
+
+    // A 7-bit LSB controller would also be read as the low half of a 14-bit pair
+    const int partner = taken.controller - 32;
+    if (partner >= 0 && partner < kNumHighResolutionPairs
+        && (table_[slot(taken.channel, partner)].load() & kHighResolutionFlag) != 0)
+        removeSlot(taken.channel, partner);
+
+    assignments_[index(target)] = taken;
+    const int flag = taken.highResolution ? kHighResolutionFlag : 0;
+    table_[slot(taken.channel, taken.controller)].store(static_cast<uint8_t>((target + 1) | flag));
+}
+
+void MidiCcMap::clear(int target) {
+    auto& assignment = assignments_[index(target)];
+    if (!assignment) return;
+
+    table_[slot(assignment->channel, assignment->controller)].store(0);
+    assignment.reset();
+}
+
+void MidiCcMap::clearAll() {
+    for (int target = 0; target < kNumTargets; ++target) clear(target);
+}
+
+void MidiCcMap::removeSlot(int channel, int controller) {
+    const auto entry = table_[slot(channel, controller)].load();
+    if (entry != 0) clear((entry & ~kHighResolutionFlag) - 1);
+}
+
+void MidiCcMap::startLearning(int target) {
+    jassert(target >= 0 && target < kNumTargets);
+    learned_.store(0);
+    learningTarget_.store(target);
+}
+
+void MidiCcMap::stopLearning() {
+    learningTarget_.store(-1);
+    learned_.store(0);
+}
+
+bool MidiCcMap::commitLearned() {
+    const int target = learningTarget_.load();
+    const uint32_t learned = learned_.load();
+    if (target < 0 || learned == 0) return false;
+
+    stopLearning();
+    assign(target, {static_cast<int>((learned >> 8) & 0x1f), static_cast<int>(learned & 0x7f),
+                    (learned & kLearnedHighResolutionFlag) != 0});
+    return true;
+}
+
+void MidiCcMap::learn(int channel, int controller) {
+    const uint32_t learned = learned_.load(std::memory_order_relaxed);
+    if (learned == 0) {
+        learned_.store(packLearned(channel, controller));
+        return;
+    }
+
+    // The LSB partner of the learned controller makes it a 14-bit pair
+    const int partner = controller - 32;
+    if (partner >= 0 && partner < kNumHighResolutionPairs
+        && learned == packLearned(channel, partner))
+        learned_.store(learned | kLearnedHighResolutionFlag);
+}
+
+std::optional<MidiCcMap::Change> MidiCcMap::handleController(int channel, int controller,
+                                                             int value) {
+    if (channel < 1 || channel > kNumChannels || controller < 0 || controller >= kNumControllers)
+        return std::nullopt;
+
+    if (learningTarget_.load(std::memory_order_relaxed) >= 0) {
+        learn(channel, controller);
+        return std::nullopt;
+    }
+
+    const auto entry = table_[slot(channel, controller)].load(std::memory_order_relaxed);
+    if (entry != 0) {
+        const int target = (entry & ~kHighResolutionFlag) - 1;
+        if ((entry & kHighResolutionFlag) == 0)
+            return Change{target, static_cast<float>(value) / kMaxSevenBit};
+
+        // MSB: the LSB restarts from zero until its own message arrives
+        msb_[msbSlot(channel, controller)] = static_cast<uint8_t>(value);
+        return Change{target, static_cast<float>(value << 7) / kMaxFourteenBit};
+    }
+
+    // LSB of a 14-bit pair, completing the value its MSB started
+    const int partner = controller - 32;
+    if (partner < 0 || partner >= kNumHighResolutionPairs) return std::nullopt;
+
+    const auto pairEntry = table_[slot(channel, partner)].load(std::memory_order_relaxed);
+    if ((pairEntry & kHighResolutionFlag) == 0) return std::nullopt;
+
+    return Change{(pairEntry & ~kHighResolutionFlag) - 1,
+                  static_cast<float>(msb_[msbSlot(channel, partner)] << 7 | value)
+                      / kMaxFourteenBit};
+}
+
+void MidiCcMap::saveTo(juce::XmlElement& state) const {
+    auto* midiCc = state.createNewChildElement(kStateTag);
+    for (int target = 0; target < kNumTargets; ++target) {
+        const auto& assignment = assignments_[index(target)];
+        if (!assignment) continue;
+
+        auto* element = midiCc->createNewChildElement(kAssignmentTag);
+        element->setAttribute("param", kMidiTargets[index(target)]);
+        element->setAttribute("channel", assignment->channel);
+        element->setAttribute("controller", assignment->controller);
+        element->setAttribute("highResolution", assignment->highResolution ? 1 : 0);
+    }
+}
+
+void MidiCcMap::loadFrom(const juce::XmlElement& state) {
+    clearAll();
+
+    const auto* midiCc = state.getChildByName(kStateTag);
+    if (midiCc == nullptr) return;
+
+    for (const auto* element : midiCc->getChildWithTagNameIterator(kAssignmentTag)) {
+        const auto param = element->getStringAttribute("param");
+        const Assignment assignment{element->getIntAttribute("channel", 0),
+                                    element->getIntAttribute("controller", -1),
+                                    element->getBoolAttribute("highResolution")};
+        if (assignment.channel < 1 || assignment.channel > kNumChannels
+            || assignment.controller < 0 || assignment.controller >= kNumControllers)
+            continue;
+
+        for (int target = 0; target < kNumTargets; ++target)
+            if (param == kMidiTargets[index(target)]) assign(target, assignment);
+    }
+}
+
+void MidiCcMap::writeTo(juce::OutputStream& stream) const {
+    const auto count = std::count_if(assignments_.begin(), assignments_.end(),
+                                     [](const auto& assignment) { return assignment.has_value(); });
+    stream.writeByte(static_cast<char>(count));
+
+    for (int target = 0; target < kNumTargets; ++target) {
+        const auto& assignment = assignments_[index(target)];
+        if (!assignment) continue;
+
+        BinaryState::writeId(stream, kMidiTargets[index(target)]);
+        stream.writeByte(static_cast<char>(assignment->channel));
+        stream.writeByte(static_cast<char>(assignment->controller));
+        stream.writeBool(assignment->highResolution);
+    }
+}
+
+void MidiCcMap::readFrom(juce::InputStream& stream) {
+    clearAll();
+
+    BinaryState::IdBuffer idBuffer;
+    const int count = stream.getNumBytesRemaining() > 0 ? static_cast<uint8_t>(stream.readByte())
+                                                        : 0;
+    for (int entry = 0; entry < count; ++entry) {
+        const auto param = BinaryState::readId(stream, idBuffer);
+        if (!param || stream.getNumBytesRemaining() < 3) return;
+
+        const Assignment assignment{static_cast<uint8_t>(stream.readByte()),
+                                    static_cast<uint8_t>(stream.readByte()), stream.readBool()};
+        const int target = targetFor(*param);
+        if (target == kNumTargets || assignment.channel < 1 || assignment.channel > kNumChannels
+            || assignment.controller >= kNumControllers)
+            continue;
+
+        assign(target, assignment);
+    }
+}
+
+}  // namespace audio_plugin
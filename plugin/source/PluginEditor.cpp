@@ -2,12 +2,15 @@
 
 #include <Iso3D/Constants.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace audio_plugin {
 
 namespace {
 
-constexpr int kEditorWidth = 720;
-constexpr int kEditorHeight = 260;
+constexpr int kEditorWidth = 774;
+constexpr int kEditorHeight = 396;
 constexpr int kEditorMargin = 12;
 constexpr int kBoostColumnWidth = 84;
 constexpr int kKnobAreaVerticalInset = 4;
@@ -19,12 +22,37 @@ constexpr int kBoostWidthInset = 8;
 constexpr int kBoostHeightMin = 106;
 constexpr int kBoostHeightMax = 122;
 constexpr int kBoostHeightFromKnobOffset = 26;
+constexpr int kMeterWidth = 10;
+constexpr int kMeterGap = 8;  // between a knob and its meter
+constexpr int kLoadLabelHeight = 14;
+constexpr int kDeckButtonHeight = 22;
+constexpr int kDeckButtonWidth = 72;
+constexpr int kDeckRadioGroup = 1;
+constexpr int kSpectrumHeight = 128;
+constexpr int kSpectrumGap = 8;  // between the spectrum and the knobs
+constexpr float kLoadLabelFontSize = 11.0f;
+
+// Meter ballistics: RMS smoothed over about 300 ms, held peaks falling at 20 dB/s
+constexpr int kMeterFrameRateHz = 30;
+constexpr float kMeterRmsTimeSec = 0.3f;
+constexpr float kMeterPeakFallDbPerSec = 20.0f;
+
+float gainToMeterDb(float gain) {
+    return juce::Decibels::gainToDecibels(gain, BandLevelMeter::kMinDb);
+}
+
+juce::String describe(const MidiCcMap::Assignment& assignment) {
+    juce::String controller = "CC " + juce::String(assignment.controller);
+    if (assignment.highResolution)
+        controller << "/" << juce::String(assignment.controller + 32) << " (14-bit)";
+    return controller + ", channel " + juce::String(assignment.channel);
+}
 
 }  // namespace
 
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(
     AudioPluginAudioProcessor& p)
-    : AudioProcessorEditor(&p), processorRef_(p) {
+    : AudioProcessorEditor(&p), processorRef_(p), analyzer_(p.getSpectrumRing()) {
     setSize(kEditorWidth, kEditorHeight);
     setLookAndFeel(&moogLookAndFeel_);
 
@@ -38,35 +66,262 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(
     setupKnob(midSlider_);
     setupKnob(highSlider_);
     addAndMakeVisible(boostSlider_);
+    for (auto& meter : meters_) addAndMakeVisible(meter);
+    addAndMakeVisible(spectrumView_);
 
-    // APVTS attachments
-    auto& apvts = processorRef_.getAPVTS();
-    lowAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        apvts, ParamID::kLow, lowSlider_);
-    midAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        apvts, ParamID::kMid, midSlider_);
-    highAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        apvts, ParamID::kHigh, highSlider_);
+    // One set of band knobs, switched between decks
+    if (processorRef_.getNumDecks() > 1) {
+        for (int deck = 0; deck < processorRef_.getNumDecks(); ++deck) {
+            auto& button = deckButtons_[static_cast<size_t>(deck)];
+            button.setButtonText("Deck " + juce::String(deck + 1));
+            button.setClickingTogglesState(true);
+            button.setRadioGroupId(kDeckRadioGroup);
+            button.onClick = [this, deck] { selectDeck(deck); };
+            addAndMakeVisible(button);
+        }
+    }
+
+    loadLabel_.setFont(juce::FontOptions(kLoadLabelFontSize));
+    loadLabel_.setColour(juce::Label::textColourId, juce::Colour(0xff1d1f22));
+    loadLabel_.setJustificationType(juce::Justification::centredLeft);
+    loadLabel_.setInterceptsMouseClicks(false, false);
+    addAndMakeVisible(loadLabel_);
+    updateLoadLabel();
+
+    // APVTS attachments; the band knobs' come with the deck
+    selectDeck(0);
     boostAttachment_ = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        apvts, ParamID::kBoost, boostSlider_);
+        processorRef_.getAPVTS(), ParamID::kBoost, boostSlider_);
+
+    // Right-click any control to assign it a MIDI controller, a band knob's for the deck
+    // it shows
+    auto addBandMidiMenu = [this](ContextMenuSlider& slider, size_t band) {
+        slider.onContextMenu = [this, &slider, band] {
+            const auto& ids = kDeckBandIds[static_cast<size_t>(deck_)];
+            showMidiMenu(slider, MidiCcMap::targetFor(ids[band]));
+        };
+    };
+    addBandMidiMenu(lowSlider_, 0);
+    addBandMidiMenu(midSlider_, 1);
+    addBandMidiMenu(highSlider_, 2);
+    boostSlider_.onContextMenu = [this] {
+        showMidiMenu(boostSlider_, MidiCcMap::targetFor(ParamID::kBoost));
+    };
+
+    processorRef_.setMeteringEnabled(true);
+    processorRef_.setAnalyzerEnabled(true);
+    analyzer_.start();
+    startTimerHz(kMeterFrameRateHz);
 }
 
 AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor() {
+    stopTimer();
+    processorRef_.setMeteringEnabled(false);
+    processorRef_.setAnalyzerEnabled(false);
+    analyzer_.stop();
+    processorRef_.getMidiCcMap().stopLearning();
     setLookAndFeel(nullptr);
 }
 
+void AudioPluginAudioProcessorEditor::timerCallback() {
+    // Combine every window queued since the last frame: RMS by mean square, peaks by
+    // maximum, both after the band gain for the output side
+    std::array<double, kNumBands> bandSquares{};
+    std::array<double, kNumBands> outputSquares{};
+    std::array<float, kNumBands> outputPeak{};
+    int numWindows = 0;
+
+    BandLevels levels;
+    while (processorRef_.popBandLevels(levels)) {
+        for (size_t band = 0; band < meters_.size(); ++band) {
+            const auto rms = static_cast<double>(levels.rms[band]);
+            const auto gain = static_cast<double>(levels.gain[band]);
+            bandSquares[band] += rms * rms;
+            outputSquares[band] += rms * rms * gain * gain;
+            outputPeak[band] = std::max(outputPeak[band], levels.peak[band] * levels.gain[band]);
+        }
+        ++numWindows;
+    }
+
+    // With nothing queued (transport stopped) the meters fall back to silence
+    const auto frameRate = static_cast<float>(kMeterFrameRateHz);
+    const float rmsCoefficient = 1.0f - std::exp(-1.0f / (kMeterRmsTimeSec * frameRate));
+    const double windows = static_cast<double>(std::max(1, numWindows));
+
+    for (size_t band = 0; band < meters_.size(); ++band) {
+        const auto bandRms = static_cast<float>(std::sqrt(bandSquares[band] / windows));
+        const auto outputRms = static_cast<float>(std::sqrt(outputSquares[band] / windows));
+        bandRms_[band] += rmsCoefficient * (bandRms - bandRms_[band]);
+        outputRms_[band] += rmsCoefficient * (outputRms - outputRms_[band]);
+        outputPeakDb_[band] = std::max(gainToMeterDb(outputPeak[band]),
+                                       outputPeakDb_[band] - kMeterPeakFallDbPerSec / frameRate);
+
+        meters_[band].setLevels(gainToMeterDb(bandRms_[band]), gainToMeterDb(outputRms_[band]),
+                                outputPeakDb_[band]);
+    }
+
+    spectrumView_.update(analyzer_);
+
+    if (++framesSincePublish_ == kMeterFrameRateHz) {
+        framesSincePublish_ = 0;
+        publishPaintStats();
+        updateLoadLabel();
+    }
+}
+
+void AudioPluginAudioProcessorEditor::selectDeck(int deck) {
+    deck_ = deck;
+    if (processorRef_.getNumDecks() > 1)
+        deckButtons_[static_cast<size_t>(deck)].setToggleState(true, juce::dontSendNotification);
+
+    // The old attachments go first, so they don't write the new deck's values back
+    using Attachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    lowAttachment_.reset();
+    midAttachment_.reset();
+    highAttachment_.reset();
+    auto& apvts = processorRef_.getAPVTS();
+    const auto& ids = kDeckBandIds[static_cast<size_t>(deck)];
+    lowAttachment_ = std::make_unique<Attachment>(apvts, ids[0], lowSlider_);
+    midAttachment_ = std::make_unique<Attachment>(apvts, ids[1], midSlider_);
+    highAttachment_ = std::make_unique<Attachment>(apvts, ids[2], highSlider_);
+
+    // The meters start over on the new deck
+    processorRef_.setMeteredDeck(deck);
+    bandRms_.fill(0.0f);
+    outputRms_.fill(0.0f);
+    outputPeakDb_.fill(BandLevelMeter::kMinDb);
+}
+
+void AudioPluginAudioProcessorEditor::updateLoadLabel() {
+    const auto stats = processorRef_.getLoadStats();
+    const auto text = juce::String::formatted("DSP %.1f%%, worst %.1f%% (%.2f ms / %d samples), ",
+                                              100.0 * stats.averageLoad, 100.0 * stats.worstLoad,
+                                              stats.worstBlockMs, stats.worstBlockSize);
+    const juce::String idle = processorRef_.isIdle() ? ", idle on silence" : "";
+    const int numWorkers = processorRef_.getNumWorkerThreads();
+    juce::String workers;
+    if (numWorkers > 0 && processorRef_.getNumRunningWorkerThreads() == 0)
+        workers = ", workers off (no real-time priority)";
+    else if (numWorkers > 0)
+        workers = ", " + juce::String(numWorkers) + " workers";
+    loadLabel_.setText(text + juce::String(stats.numOverruns) + " overruns" + workers + idle,
+                       juce::dontSendNotification);
+}
+
+void AudioPluginAudioProcessorEditor::mouseDown(const juce::MouseEvent& e) {
+    if (!loadLabel_.getBounds().contains(e.getPosition())) return;
+
+    if (e.mods.isPopupMenu()) {
+        showWorkerMenu();
+    } else {
+        processorRef_.resetLoadStats();
+        loadLabel_.setText("DSP load reset", juce::dontSendNotification);
+    }
+}
+
+void AudioPluginAudioProcessorEditor::showWorkerMenu() {
+    // Item IDs are the worker count plus one
+    const int current = processorRef_.getNumWorkerThreads();
+    const int maxWorkers = AudioPluginAudioProcessor::getMaxWorkerThreads();
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Worker threads");
+    menu.addItem(1, "Off", true, current == 0);
+    for (int numWorkers = 1; numWorkers <= maxWorkers; ++numWorkers)
+        menu.addItem(numWorkers + 1, juce::String(numWorkers), true, current == numWorkers);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&loadLabel_),
+                       [safeThis = juce::Component::SafePointer(this)](int result) {
+                           if (safeThis == nullptr || result == 0) return;
+                           safeThis->processorRef_.setNumWorkerThreads(result - 1);
+                           safeThis->updateLoadLabel();
+                       });
+}
+
+void AudioPluginAudioProcessorEditor::showMidiMenu(juce::Component& control, int target) {
+    enum MenuItem { learnItem = 1, forgetItem };
+
+    auto& midiMap = processorRef_.getMidiCcMap();
+    const bool learning = midiMap.getLearningTarget() == target;
+    const auto assignment = midiMap.getAssignment(target);
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader(assignment ? describe(*assignment) : juce::String("No MIDI controller"));
+    menu.addItem(learnItem, learning ? "Cancel MIDI Learn" : "MIDI Learn");
+    menu.addItem(forgetItem, "Forget MIDI Controller", assignment.has_value());
+
+    menu.showMenuAsync(
+        juce::PopupMenu::Options().withTargetComponent(&control),
+        [safeThis = juce::Component::SafePointer(this), target, learning](int result) {
+            if (safeThis == nullptr) return;
+
+            auto& map = safeThis->processorRef_.getMidiCcMap();
+            if (result == learnItem) {
+                if (learning)
+                    map.stopLearning();
+                else
+                    map.startLearning(target);  // the next controller moved takes it
+            } else if (result == forgetItem) {
+                map.clear(target);
+            }
+        });
+}
+
 void AudioPluginAudioProcessorEditor::paint(juce::Graphics& g) {
+    paintStartTicks_ = juce::Time::getHighResolutionTicks();
     g.fillAll(juce::Colour(0xff808080));
 }
 
+void AudioPluginAudioProcessorEditor::paintOverChildren(juce::Graphics&) {
+    const double ms = 1000.0 * juce::Time::highResolutionTicksToSeconds(
+                                   juce::Time::getHighResolutionTicks() - paintStartTicks_);
+    ++paintCount_;
+    paintTotalMs_ += ms;
+    paintMaxMs_ = std::max(paintMaxMs_, ms);
+}
+
+void AudioPluginAudioProcessorEditor::publishPaintStats() {
+    paintStats_.numPaints = paintCount_;
+    paintStats_.meanMs = paintCount_ > 0 ? paintTotalMs_ / static_cast<double>(paintCount_) : 0.0;
+    paintStats_.maxMs = paintMaxMs_;
+    paintCount_ = 0;
+    paintTotalMs_ = 0.0;
+    paintMaxMs_ = 0.0;
+
+#if ISO3D_PAINT_TIMING
+    if (paintStats_.numPaints > 0) {
+        juce::Logger::writeToLog(juce::String::formatted(
+            "Iso3D editor: %d paints, mean %.3f ms, max %.3f ms", paintStats_.numPaints,
+            paintStats_.meanMs, paintStats_.maxMs));
+    }
+    const auto frameStats = analyzer_.getFrameStats();
+    if (frameStats.numFrames > 0) {
+        juce::Logger::writeToLog(juce::String::formatted(
+            "Iso3D spectrum: %d frames, mean %.3f ms, max %.3f ms", frameStats.numFrames,
+            frameStats.meanMs, frameStats.maxMs));
+    }
+#endif
+}
+
 void AudioPluginAudioProcessorEditor::resized() {
     auto content = getLocalBounds().reduced(kEditorMargin);
+    loadLabel_.setBounds(content.removeFromBottom(kLoadLabelHeight));
+    if (processorRef_.getNumDecks() > 1) {
+        auto deckRow = content.removeFromTop(kDeckButtonHeight);
+        for (int deck = 0; deck < processorRef_.getNumDecks(); ++deck)
+            deckButtons_[static_cast<size_t>(deck)].setBounds(
+                deckRow.removeFromLeft(kDeckButtonWidth));
+    }
+    spectrumView_.setBounds(content.removeFromTop(kSpectrumHeight));
+    content.removeFromTop(kSpectrumGap);
     auto boostColumn = content.removeFromRight(kBoostColumnWidth);
     auto knobArea = content.reduced(0, kKnobAreaVerticalInset);
 
-    const int knobDiameter = juce::jmax(kMinKnobDiameter,
-                                        juce::jmin(knobArea.getHeight() - kKnobSlotPadding,
-                                                   (knobArea.getWidth() / 3) - kKnobSlotPadding));
+    const int knobDiameter =
+        juce::jmax(kMinKnobDiameter,
+                   juce::jmin(knobArea.getHeight() - kKnobSlotPadding,
+                              (knobArea.getWidth() / 3) - kKnobSlotPadding - kMeterWidth
+                                  - kMeterGap));
     auto knobRow = knobArea.withHeight(knobDiameter);
     knobRow.setY(knobArea.getCentreY() - (knobDiameter / 2));
 
@@ -75,9 +330,15 @@ void AudioPluginAudioProcessorEditor::resized() {
     auto midSlot = knobRow.removeFromLeft(knobSlotWidth);
     auto highSlot = knobRow;
 
-    lowSlider_.setBounds(lowSlot.withSizeKeepingCentre(knobDiameter, knobDiameter));
-    midSlider_.setBounds(midSlot.withSizeKeepingCentre(knobDiameter, knobDiameter));
-    highSlider_.setBounds(highSlot.withSizeKeepingCentre(knobDiameter, knobDiameter));
+    // Each knob with its band's meter on the right, the pair centred in the slot
+    const std::array<juce::Rectangle<int>*, kNumBands> slots = {&lowSlot, &midSlot, &highSlot};
+    const std::array<juce::Slider*, kNumBands> knobs = {&lowSlider_, &midSlider_, &highSlider_};
+    for (size_t band = 0; band < meters_.size(); ++band) {
+        auto pair = slots[band]->withSizeKeepingCentre(knobDiameter + kMeterGap + kMeterWidth,
+                                                       knobDiameter);
+        knobs[band]->setBounds(pair.removeFromLeft(knobDiameter));
+        meters_[band].setBounds(pair.removeFromRight(kMeterWidth));
+    }
 
     const int boostWidth =
         juce::jlimit(kBoostWidthMin, kBoostWidthMax, boostColumn.getWidth() - kBoostWidthInset);
@@ -2,7 +2,9 @@
 
 #include <Iso3D/PluginEditor.h>
 
+#include <algorithm>
 #include <cmath>
+#include <type_traits>
 
 namespace audio_plugin {
 
@@ -14,55 +16,205 @@ float dbToLinear(float dB) {
     return std::pow(10.0f, dB / 20.0f);
 }
 
+// Host and editor catch up with audio-thread changes at this rate
+constexpr int kMessageThreadSyncHz = 50;
+
+// Sample rate the tail length is estimated at until prepareToPlay() gives the real one
+constexpr double kNominalSampleRate = 48000.0;
+
+// Binary state chunk holding the parameters: a count byte, then per parameter its ID and
+// its value in the parameter's own units (float)
+constexpr uint32_t kParametersChunk = chunkTag("PARM");
+
+// Binary state chunk holding the number of worker threads (one byte)
+constexpr uint32_t kWorkersChunk = chunkTag("WRKR");
+
+// Every parameter ID a build can have: kParameterIds, then the band gains of decks 2 and up
+constexpr auto kAllParameterIds = [] {
+    std::array<const char*, kParameterIds.size() + (kMaxDecks - 1) * kNumBands> ids{};
+    auto next = std::copy(kParameterIds.begin(), kParameterIds.end(), ids.begin());
+    for (size_t deck = 1; deck < kDeckBandIds.size(); ++deck)
+        next = std::copy(kDeckBandIds[deck].begin(), kDeckBandIds[deck].end(), next);
+    return ids;
+}();
+
+// MIDI targets of each deck's band gains
+constexpr auto kBandTargets = [] {
+    std::array<std::array<int, kNumBands>, kMaxDecks> targets{};
+    for (size_t deck = 0; deck < targets.size(); ++deck)
+        for (size_t band = 0; band < kNumBands; ++band)
+            targets[deck][band] = MidiCcMap::targetFor(kDeckBandIds[deck][band]);
+    return targets;
+}();
+
+constexpr int kBoostTarget = MidiCcMap::targetFor(ParamID::kBoost);
+constexpr int kLinearPhaseTarget = MidiCcMap::targetFor(ParamID::kLinearPhase);
+constexpr int kDriveTarget = MidiCcMap::targetFor(ParamID::kDrive);
+constexpr int kSweepDepthTarget = MidiCcMap::targetFor(ParamID::kSweepDepth);
+constexpr int kSweepRateTarget = MidiCcMap::targetFor(ParamID::kSweepRate);
+
+// Longest the output can go on once the input stops: the LR4 ringing at the lowest split
+// points the parameters allow, or the linear-phase FIR's span of past input (what
+// LinearPhaseCrossover::getWarmupSamples() covers), whichever is longer.
+double tailLengthSeconds(double sampleRate) {
+    const auto coefficients = CrossoverCoefficients<>::make(
+        sampleRate, {kLowMidCrossoverMinHz, kMidHighCrossoverMinHz});
+    const double ringing =
+        Crossover<double>::decayTimeSeconds(sampleRate, coefficients, kSilenceThreshold);
+
+    const auto firSpan = LinearPhaseKernel<>::partitionSizeFor(sampleRate)
+        * static_cast<size_t>(kLinearPhaseNumPartitions + 1);
+    return std::max(ringing, static_cast<double>(firSpan) / sampleRate);
+}
+
+// Largest magnitude among numSamples (> 0) samples
+template <typename SampleType>
+SampleType peakOf(const SampleType* data, int numSamples) {
+    const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+    return std::max(range.getEnd(), -range.getStart());
+}
+
+// Linear gain targets for the bands, each capped at the boost ceiling
+template <typename SampleType>
+typename GainSmoother<SampleType>::Gains gainTargetsFor(const SceneMorph::Values& values) {
+    auto gain = [&values](size_t band) {
+        return static_cast<SampleType>(
+            dbToLinear(std::min(values.gainsDb[band], values.boostMaxDb)));
+    };
+    return {gain(0), gain(1), gain(2)};
+}
+
+template <typename Gains>
+bool isUnity(const Gains& gains) {
+    return std::all_of(gains.begin(), gains.end(), [](auto gain) {
+        return std::abs(gain - 1) <= static_cast<decltype(gain)>(kGainSmoothEpsilon);
+    });
+}
+
 }  // namespace
 
-AudioPluginAudioProcessor::AudioPluginAudioProcessor()
-    : AudioProcessor(createBusesProperties()),
-      apvts_(*this, nullptr, "Parameters", createParameterLayout()) {
-    lowParam_ = apvts_.getRawParameterValue(ParamID::kLow);
-    midParam_ = apvts_.getRawParameterValue(ParamID::kMid);
-    highParam_ = apvts_.getRawParameterValue(ParamID::kHigh);
+AudioPluginAudioProcessor::AudioPluginAudioProcessor(int numDecks)
+    : AudioProcessor(createBusesProperties(numDecks)),
+      numDecks_(numDecks),
+      apvts_(*this, nullptr, "Parameters", createParameterLayout(numDecks)),
+      crossoverTuner_(*apvts_.getRawParameterValue(ParamID::kLowMidFreq),
+                      *apvts_.getRawParameterValue(ParamID::kMidHighFreq)) {
+    jassert(numDecks >= 1 && numDecks <= kMaxDecks);
+
+    for (size_t deck = 0; deck < static_cast<size_t>(numDecks_); ++deck)
+        for (size_t band = 0; band < kNumBands; ++band)
+            bandParams_[deck][band] = apvts_.getRawParameterValue(kDeckBandIds[deck][band]);
     boostParam_ = apvts_.getRawParameterValue(ParamID::kBoost);
+    linearPhaseParam_ = apvts_.getRawParameterValue(ParamID::kLinearPhase);
+    driveParam_ = apvts_.getRawParameterValue(ParamID::kDrive);
+    sweepDepthParam_ = apvts_.getRawParameterValue(ParamID::kSweepDepth);
+    sweepRateParam_ = apvts_.getRawParameterValue(ParamID::kSweepRate);
+    lowMidFreqParam_ = apvts_.getRawParameterValue(ParamID::kLowMidFreq);
+    midHighFreqParam_ = apvts_.getRawParameterValue(ParamID::kMidHighFreq);
+
+    for (size_t index = 0; index < parameters_.size(); ++index)
+        parameters_[index] = apvts_.getParameter(kAllParameterIds[index]);
+
+    for (size_t target = 0; target < midiTargets_.size(); ++target) {
+        midiTargets_[target] = apvts_.getParameter(kMidiTargets[target]);
+        midiValues_[target].store(kNoMidiValue);
+    }
+
+    tailLengthSeconds_.store(tailLengthSeconds(kNominalSampleRate));
+    startTimerHz(kMessageThreadSyncHz);
 }
 
-AudioPluginAudioProcessor::~AudioPluginAudioProcessor() = default;
+AudioPluginAudioProcessor::~AudioPluginAudioProcessor() { stopTimer(); }
 
 juce::AudioProcessorValueTreeState::ParameterLayout
-AudioPluginAudioProcessor::createParameterLayout() {
+AudioPluginAudioProcessor::createParameterLayout(int numDecks) {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
     // Skew so that midpoint (0.5 / MIDI CC 64) = 0 dB, matching analog isolators
-    auto bandRange = juce::NormalisableRange<float>(-100.0f, 12.0f, 0.1f);
+    auto bandRange = juce::NormalisableRange<float>(-100.0f, kMaxBandGainDb, 0.1f);
     bandRange.setSkewForCentre(0.0f);
 
+    // Multi-deck builds name the bands after their deck, "Deck 2 Low"
+    constexpr std::array<const char*, kNumBands> bandNames = {"Low", "Mid", "High"};
+    auto addBands = [&](size_t deck) {
+        const juce::String prefix =
+            numDecks > 1 ? "Deck " + juce::String(static_cast<int>(deck) + 1) + " " : "";
+        for (size_t band = 0; band < kNumBands; ++band)
+            layout.add(std::make_unique<juce::AudioParameterFloat>(
+                juce::ParameterID{kDeckBandIds[deck][band], 1}, prefix + bandNames[band],
+                bandRange, 0.0f));
+    };
+
+    addBands(0);
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID{ParamID::kBoost, 1}, "Boost",
+        juce::StringArray{"0 dB", "+6 dB", "+12 dB"}, 0));
+
+    // Split points, skewed so the knob centre sits at the geometric middle of the range
+    auto frequencyRange = [](float minHz, float maxHz) {
+        auto range = juce::NormalisableRange<float>(minHz, maxHz, 1.0f);
+        range.setSkewForCentre(std::sqrt(minHz * maxHz));
+        return range;
+    };
 
     layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ParamID::kLow, 1}, "Low", bandRange, 0.0f));
+        juce::ParameterID{ParamID::kLowMidFreq, 1}, "Low/Mid Frequency",
+        frequencyRange(kLowMidCrossoverMinHz, kLowMidCrossoverMaxHz), kLowMidCrossoverHz));
 
     layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ParamID::kMid, 1}, "Mid", bandRange, 0.0f));
+        juce::ParameterID{ParamID::kMidHighFreq, 1}, "Mid/High Frequency",
+        frequencyRange(kMidHighCrossoverMinHz, kMidHighCrossoverMaxHz), kMidHighCrossoverHz));
+
+    // Linear-phase FIR crossover instead of LR4, at the cost of latency
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID{ParamID::kLinearPhase, 1}, "Linear Phase", false));
 
+    // Oversampled saturation after the band gains, off at 0
     layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ParamID::kHigh, 1}, "High", bandRange, 0.0f));
+        juce::ParameterID{ParamID::kDrive, 1}, "Drive",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f));
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID{ParamID::kBoost, 1}, "Boost",
-        juce::StringArray{"0 dB", "+6 dB", "+12 dB"}, 0));
+    // LFO sweep of both split points, in octaves either way, off at 0
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ParamID::kSweepDepth, 1}, "Sweep Depth",
+        juce::NormalisableRange<float>(0.0f, kMaxSweepOctaves, 0.01f), 0.0f));
+
+    auto sweepRateRange = juce::NormalisableRange<float>(kMinSweepRateHz, kMaxSweepRateHz, 0.01f);
+    sweepRateRange.setSkewForCentre(kDefaultSweepRateHz);
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ParamID::kSweepRate, 1}, "Sweep Rate", sweepRateRange,
+        kDefaultSweepRateHz));
+
+    // Later decks go last, so the parameters every build has keep their order
+    for (size_t deck = 1; deck < static_cast<size_t>(numDecks); ++deck) addBands(deck);
 
     return layout;
 }
 
-juce::AudioProcessor::BusesProperties AudioPluginAudioProcessor::createBusesProperties() {
-    return BusesProperties()
-        .withInput("Input", juce::AudioChannelSet::stereo(), true)
-        .withOutput("Output", juce::AudioChannelSet::stereo(), true);
+juce::AudioProcessor::BusesProperties
+AudioPluginAudioProcessor::createBusesProperties(int numDecks) {
+    if (numDecks == 1)
+        return BusesProperties()
+            .withInput("Input", juce::AudioChannelSet::stereo(), true)
+            .withOutput("Output", juce::AudioChannelSet::stereo(), true);
+
+    BusesProperties buses;
+    for (int deck = 1; deck <= numDecks; ++deck) {
+        const auto name = "Deck " + juce::String(deck);
+        buses = buses.withInput(name, juce::AudioChannelSet::stereo(), true)
+                    .withOutput(name, juce::AudioChannelSet::stereo(), true);
+    }
+    return buses;
 }
 
 const juce::String AudioPluginAudioProcessor::getName() const { return "Iso3D"; }
-bool AudioPluginAudioProcessor::acceptsMidi() const { return false; }
+bool AudioPluginAudioProcessor::acceptsMidi() const { return true; }
 bool AudioPluginAudioProcessor::producesMidi() const { return false; }
 bool AudioPluginAudioProcessor::isMidiEffect() const { return false; }
-double AudioPluginAudioProcessor::getTailLengthSeconds() const { return 0.0; }
+double AudioPluginAudioProcessor::getTailLengthSeconds() const {
+    return tailLengthSeconds_.load();
+}
 
 int AudioPluginAudioProcessor::getNumPrograms() { return 1; }
 int AudioPluginAudioProcessor::getCurrentProgram() { return 0; }
@@ -70,25 +222,471 @@ void AudioPluginAudioProcessor::setCurrentProgram(int /*index*/) {}
 const juce::String AudioPluginAudioProcessor::getProgramName(int /*index*/) { return {}; }
 void AudioPluginAudioProcessor::changeProgramName(int /*index*/, const juce::String& /*newName*/) {}
 
-void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int /*samplesPerBlock*/) {
-    crossover_.prepare(sampleRate);
+template <typename SampleType>
+void AudioPluginAudioProcessor::Dsp<SampleType>::prepare(
+    double sampleRate, int samplesPerBlock, int numChannels, int deckCount,
+    const CrossoverTuner::Frequencies& frequencies, bool useLinearPhase) {
+    crossover.prepare(sampleRate, numChannels);
+    staticCoefficients = CrossoverCoefficients<>::make(sampleRate, frequencies);
+    crossover.setCoefficients(staticCoefficients);
+    fused.prepare(sampleRate, numChannels);
+    fused.setCoefficients(staticCoefficients);
+    fusedActive = false;
+    fusedCoefficientsStale = false;
+    linearPhase.prepare(sampleRate, numChannels);
+    linearPhase.setKernel(LinearPhaseKernel<>::make(sampleRate, frequencies));
+
+    bandBuffer.setSize(kNumBands * numChannels, juce::jmax(1, samplesPerBlock));
+    fadeBuffer.setSize(numChannels, bandBuffer.getNumSamples());
+    sweep.prepare(sampleRate, bandBuffer.getNumSamples());
+    sweeping = false;
+    bandMeter.prepare(sampleRate);
+
+    // A stereo pair per deck, or every channel for a single deck
+    numDecks = deckCount;
+    for (int index = 0; index < numDecks; ++index) {
+        auto& deck = decks[static_cast<size_t>(index)];
+        deck.firstChannel = numDecks > 1 ? std::min(2 * index, numChannels) : 0;
+        deck.numChannels = numDecks > 1 ? std::min(2, numChannels - deck.firstChannel)
+                                        : numChannels;
+        deck.gainSmoother.prepare(sampleRate, bandBuffer.getNumSamples());
+        deck.gainsSteady = true;
+        deck.sceneMorph.prepare(sampleRate);
+    }
+    drive.prepare(sampleRate, numChannels);
+
+    linearPhaseMode = useLinearPhase;
+    modeSwitchPosition = -1;
+    modeWarmupSamples = linearPhase.getWarmupSamples();
+    silentSamples = 0;
+    idle = false;
+    idleGroups = {};
+    const double crossfadeSamples = static_cast<double>(kModeCrossfadeTimeSec) * sampleRate;
+    modeCrossfadeSamples = juce::jmax(1, juce::roundToInt(crossfadeSamples));
+}
+
+template <typename SampleType>
+typename Crossover<SampleType>::Bands AudioPluginAudioProcessor::Dsp<SampleType>::getBands() {
+    const int stride = bandBuffer.getNumChannels() / kNumBands;
+    SampleType* const* bandData = bandBuffer.getArrayOfWritePointers();
+    return {bandData, bandData + stride, bandData + 2 * stride};
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::Dsp<SampleType>::advanceSweep(
+    const CrossoverSweep::Frequencies& frequencies, float depthOctaves, float rateHz,
+    int numSamples) {
+    const bool wasSweeping = sweeping;
+    sweeping = sweep.advance(frequencies, depthOctaves, rateHz, numSamples);
+    if (sweeping)
+        crossover.modulate(sweep.getTable(), sweep.getPositions());
+    else if (wasSweeping)
+        crossover.glideTo(staticCoefficients);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::Dsp<SampleType>::beginModeSwitch(bool useLinearPhase) {
+    if (useLinearPhase)
+        linearPhase.reset();
+    else
+        crossover.reset();
+
+    linearPhaseMode = useLinearPhase;
+    modeSwitchPosition = 0;
+}
+
+template <typename SampleType>
+bool AudioPluginAudioProcessor::Dsp<SampleType>::updateIdle(
+    const juce::AudioBuffer<SampleType>& buffer, int numChannels, bool modeChangeRequested) {
+    const int numSamples = buffer.getNumSamples();
+    const auto threshold = static_cast<SampleType>(kSilenceThreshold);
+
+    bool inputSilent = true;
+    for (int ch = 0; ch < numChannels && inputSilent; ++ch)
+        inputSilent = buffer.getMagnitude(ch, 0, numSamples) < threshold;
+
+    const bool engineSilent = linearPhaseMode ? silentSamples >= linearPhase.getWarmupSamples()
+                              : fusedActive   ? fused.isSilent(threshold)
+                                              : crossover.isSilent(threshold);
+    const bool memorySilent = engineSilent && drive.isSilent(threshold);
+    const bool wasIdle = idle;
+    idle = inputSilent && memorySilent && !isSwitchingMode() && !modeChangeRequested;
 
-    smoothAlpha_ = 1.0f - std::exp(-1.0f / (kGainSmoothTimeSec * static_cast<float>(sampleRate)));
-    smoothedLowGain_ = 1.0f;
-    smoothedMidGain_ = 1.0f;
-    smoothedHighGain_ = 1.0f;
+    silentSamples =
+        inputSilent ? std::min(silentSamples + numSamples, linearPhase.getWarmupSamples()) : 0;
+
+    // What is left is below the threshold; clearing it avoids denormals on resume
+    if (idle && !wasIdle) {
+        crossover.reset();
+        fused.reset();
+        linearPhase.reset();
+        drive.reset();
+    }
+    return idle;
 }
 
-void AudioPluginAudioProcessor::releaseResources() {}
+template <typename SampleType>
+int AudioPluginAudioProcessor::Dsp<SampleType>::getStepSamples(int maxSamples) const {
+    for (int index = 0; index < numDecks; ++index)
+        maxSamples = decks[static_cast<size_t>(index)].sceneMorph.getStepSamples(maxSamples);
+    return maxSamples;
+}
+
+template <typename SampleType>
+bool AudioPluginAudioProcessor::Dsp<SampleType>::advanceGains(
+    const std::array<SceneMorph::Values, kMaxDecks>& parameters, int numSamples) {
+    bool unity = true;
+    for (size_t index = 0; index < static_cast<size_t>(numDecks); ++index) {
+        auto& deck = decks[index];
+        const auto targets = gainTargetsFor<SampleType>(deck.sceneMorph.apply(parameters[index]));
+        deck.sceneMorph.advance(numSamples);
+        deck.gainsSteady = deck.gainSmoother.advance(targets, numSamples);
+        unity = unity && deck.gainsSteady && isUnity(targets);
+    }
+    return unity;
+}
+
+void AudioPluginAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
+    const int numChannels = juce::jlimit(1, kMaxChannels, getTotalNumInputChannels());
+    const auto frequencies = crossoverTuner_.start(sampleRate, !isNonRealtime());
+    const bool useLinearPhase = readParameter(kLinearPhaseTarget, *linearPhaseParam_) >= 0.5f;
+
+    int newLatency = 0;
+    if (isUsingDoublePrecision()) {
+        doubleDsp_.prepare(sampleRate, samplesPerBlock, numChannels, numDecks_, frequencies,
+                           useLinearPhase);
+        newLatency = doubleDsp_.getLatencySamples();
+        floatDsp_ = {};
+    } else {
+        floatDsp_.prepare(sampleRate, samplesPerBlock, numChannels, numDecks_, frequencies,
+                          useLinearPhase);
+        newLatency = floatDsp_.getLatencySamples();
+        doubleDsp_ = {};
+    }
+
+    latencySamples_.store(newLatency);
+    setLatencySamples(newLatency);
+    tailLengthSeconds_.store(tailLengthSeconds(sampleRate));
+    loadProfiler_.prepare(sampleRate, samplesPerBlock);
+    spectrumRing_.setSampleRate(sampleRate);
+    {
+        const std::lock_guard lock(workerPoolMutex_);
+        startedWorkerThreads_ = numWorkerThreads_.load();
+        workerPool_.start(startedWorkerThreads_, sampleRate, samplesPerBlock);
+        prepared_ = true;
+    }
+
+    // The audio thread is stopped, so its copy of the scenes is brought up to date here
+    audioScenes_ = scenes_;
+    sceneBankBuffer_.clear();
+    scenesPending_ = false;
+}
+
+void AudioPluginAudioProcessor::timerCallback() {
+    setLatencySamples(latencySamples_.load());
+
+    for (size_t target = 0; target < midiValues_.size(); ++target) {
+        float value = midiValues_[target].load();
+        if (value < 0.0f) continue;
+
+        // Cleared only if no newer value has arrived meanwhile; that one is picked up on
+        // the next tick
+        midiTargets_[target]->setValueNotifyingHost(value);
+        midiValues_[target].compare_exchange_strong(value, kNoMidiValue);
+    }
+
+    midiCcMap_.commitLearned();
+    if (scenesPending_) publishScenes();
+    applyNumWorkerThreads();
+}
+
+float AudioPluginAudioProcessor::readParameter(int target, const std::atomic<float>& value) const {
+    const auto index = static_cast<size_t>(target);
+    const float midiValue = midiValues_[index].load(std::memory_order_relaxed);
+    if (midiValue < 0.0f) return value.load(std::memory_order_relaxed);
+    return midiTargets_[index]->convertFrom0to1(midiValue);
+}
+
+SceneMorph::Values AudioPluginAudioProcessor::readGainParameters(int deck) const {
+    const auto& params = bandParams_[static_cast<size_t>(deck)];
+    const auto& targets = kBandTargets[static_cast<size_t>(deck)];
+    const auto boost = static_cast<size_t>(readParameter(kBoostTarget, *boostParam_));
+    return {{readParameter(targets[0], *params[0]), readParameter(targets[1], *params[1]),
+             readParameter(targets[2], *params[2])},
+            kBoostLevels[boost]};
+}
+
+void AudioPluginAudioProcessor::storeScene(int index, const Scene& scene) {
+    jassert(index >= 0 && index < SceneBank::kNumScenes);
+    scenes_[index] = scene;
+    publishScenes();
+}
+
+Scene AudioPluginAudioProcessor::captureScene(float morphTimeSec, int deck) const {
+    jassert(deck >= 0 && deck < numDecks_);
+    const auto parameters = readGainParameters(deck);
+    Scene scene;
+    scene.gainsDb = parameters.gainsDb;
+    scene.boost = static_cast<int>(readParameter(kBoostTarget, *boostParam_));
+    scene.morphTimeSec = morphTimeSec;
+    return scene;
+}
+
+bool AudioPluginAudioProcessor::recallScene(int index, float morphTimeSec, int deck) {
+    jassert(index >= 0 && index < SceneBank::kNumScenes);
+    jassert(deck >= 0 && deck < numDecks_);
+    return sceneRecalls_.push({scenes_[index], morphTimeSec, deck});
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::recall(Dsp<SampleType>& dsp, const Scene& scene,
+                                       float morphTimeSec, int deck) {
+    // From the values in effect, partway through an earlier morph included
+    auto& sceneMorph = dsp.decks[static_cast<size_t>(deck)].sceneMorph;
+    sceneMorph.start(sceneMorph.apply(readGainParameters(deck)), morphTimeSec);
+
+    const auto& bandTargets = kBandTargets[static_cast<size_t>(deck)];
+    for (size_t band = 0; band < bandTargets.size(); ++band) {
+        const auto target = static_cast<size_t>(bandTargets[band]);
+        midiValues_[target].store(midiTargets_[target]->convertTo0to1(scene.gainsDb[band]));
+    }
+    const auto boostTarget = static_cast<size_t>(kBoostTarget);
+    midiValues_[boostTarget].store(
+        midiTargets_[boostTarget]->convertTo0to1(static_cast<float>(scene.boost)));
+}
+
+void AudioPluginAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept {
+    juce::AudioProcessor::setNonRealtime(isNonRealtime);
+    if (prepared_) crossoverTuner_.setRealtime(!isNonRealtime);
+}
+
+void AudioPluginAudioProcessor::releaseResources() {
+    crossoverTuner_.stop();
+    const std::lock_guard lock(workerPoolMutex_);
+    workerPool_.stop();
+    prepared_ = false;
+}
+
+int AudioPluginAudioProcessor::getMaxWorkerThreads() {
+    return juce::jlimit(0, kMaxWorkerThreads, juce::SystemStats::getNumCpus() - 1);
+}
+
+void AudioPluginAudioProcessor::setNumWorkerThreads(int numWorkers) {
+    numWorkerThreads_.store(juce::jlimit(0, getMaxWorkerThreads(), numWorkers));
+    applyNumWorkerThreads();
+}
+
+void AudioPluginAudioProcessor::applyNumWorkerThreads() {
+    const std::lock_guard lock(workerPoolMutex_);
+    const int numWorkers = numWorkerThreads_.load();
+    if (!prepared_ || numWorkers == startedWorkerThreads_) return;
+
+    // The audio thread picks the new pool up with its next block
+    startedWorkerThreads_ = numWorkers;
+    workerPool_.start(numWorkers, getSampleRate(), getBlockSize());
+}
 
 bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
-    return layouts.getMainInputChannelSet() == juce::AudioChannelSet::stereo()
-        && layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo();
+    // A stereo pair per deck, input and output
+    if (numDecks_ > 1) {
+        auto isStereo = [](const juce::AudioChannelSet& set) {
+            return set == juce::AudioChannelSet::stereo();
+        };
+        return layouts.inputBuses.size() == numDecks_ && layouts.outputBuses.size() == numDecks_
+            && std::all_of(layouts.inputBuses.begin(), layouts.inputBuses.end(), isStereo)
+            && std::all_of(layouts.outputBuses.begin(), layouts.outputBuses.end(), isStereo);
+    }
+
+    // Any layout (mono, stereo, surround, immersive, discrete) as long as input and
+    // output match and fit the crossover's channel limit
+    const auto& input = layouts.getMainInputChannelSet();
+    return !input.isDisabled() && input.size() <= kMaxChannels
+        && layouts.getMainOutputChannelSet() == input;
 }
 
 void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
-                                              juce::MidiBuffer& /*midiMessages*/) {
+                                              juce::MidiBuffer& midiMessages) {
+    process(buffer, midiMessages);
+}
+
+void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages) {
+    process(buffer, midiMessages);
+}
+
+template <typename SampleType>
+AudioPluginAudioProcessor::Dsp<SampleType>& AudioPluginAudioProcessor::getDsp() {
+    if constexpr (std::is_same_v<SampleType, double>)
+        return doubleDsp_;
+    else
+        return floatDsp_;
+}
+
+template <typename SampleType>
+template <typename Engine>
+void AudioPluginAudioProcessor::Dsp<SampleType>::render(Engine& engine, SampleType* const* input,
+                                                        SampleType* const* output,
+                                                        int numChannels, int numSamples,
+                                                        bool unity) {
+    if (unity) {
+        // Converged unity: the band sum comes straight out of the engine with no band
+        // buffers or gain stage. Filter state is shared with processBlock, so entering
+        // and leaving this path is seamless, up to the IIR crossover's allpass sum
+        // handing its state back (see updateIirEngine()).
+        engine.processBlockSummed(input, output, numChannels, numSamples);
+        return;
+    }
+
+    engine.processBlock(input, getBands(), numChannels, numSamples);
+    applyGains(output, 0, numChannels, numSamples);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::Dsp<SampleType>::renderGroups(WorkerPool& pool,
+                                                              SampleType* const* channels,
+                                                              int numChannels, int numSamples,
+                                                              bool unity) {
+    // Each group's gains only read its own channels' bands, so they run in the same task
+    const auto bands = getBands();
+    const int groupSize = crossover.getGroupSize();
+    const auto threshold = static_cast<SampleType>(kSilenceThreshold);
+
+    // fused weights the bands itself, with its channels' deck gains
+    if (fusedActive) {
+        for (int index = 0; index < numDecks; ++index) {
+            const auto& deck = decks[static_cast<size_t>(index)];
+            for (int ch = deck.firstChannel; ch < deck.firstChannel + deck.numChannels; ++ch) {
+                auto& gains = fusedGains[static_cast<size_t>(ch)];
+                for (size_t band = 0; band < gains.current.size(); ++band) {
+                    const int bandIndex = static_cast<int>(band);
+                    gains.current[band] = deck.gainSmoother.getCurrent(bandIndex);
+                    gains.ramps[band] =
+                        deck.gainsSteady ? nullptr : deck.gainSmoother.getRamp(bandIndex);
+                }
+            }
+        }
+    }
+
+    auto renderGroup = [&](int group) {
+        const int firstChannel = group * groupSize;
+        const int endChannel = std::min(firstChannel + groupSize, numChannels);
+
+        bool silent = fusedActive ? fused.isGroupSilent(group, threshold)
+                                  : crossover.isGroupSilent(group, threshold);
+        for (int ch = firstChannel; ch < endChannel && silent; ++ch)
+            silent = peakOf(channels[ch], numSamples) < threshold;
+
+        auto& groupIdle = idleGroups[static_cast<size_t>(group)];
+        if (silent) {
+            // What is left is below the threshold; clearing it avoids denormals on resume
+            if (!groupIdle && fusedActive)
+                fused.resetGroup(group);
+            else if (!groupIdle)
+                crossover.resetGroup(group);
+            groupIdle = true;
+            if (!unity)
+                for (const auto band : bands)
+                    for (int ch = firstChannel; ch < endChannel; ++ch)
+                        juce::FloatVectorOperations::clear(band[ch], numSamples);
+            return;
+        }
+        groupIdle = false;
+
+        if (unity) {
+            crossover.processGroupSummed(group, channels, channels, numChannels, numSamples);
+            return;
+        }
+        if (fusedActive) {
+            fused.processGroup(group, channels, channels, fusedGains.data(), numChannels,
+                               numSamples);
+            return;
+        }
+        crossover.processGroup(group, channels, bands, numChannels, numSamples);
+        applyGains(channels, firstChannel, endChannel, numSamples);
+    };
+
+    const int numGroups = crossover.getNumGroups(numChannels);
+    if (numSamples >= kMinParallelSamples)
+        pool.run(numGroups, renderGroup);
+    else
+        for (int group = 0; group < numGroups; ++group) renderGroup(group);
+    crossover.endBlock(numSamples);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::Dsp<SampleType>::updateIirEngine(bool unity, bool bandsRead,
+                                                                 int numChannels,
+                                                                 int numSamples) {
+    const bool settled = !linearPhaseMode && !isSwitchingMode() && !crossover.isGliding()
+        && !crossover.isModulated();
+    // Off the unity path the crossover's cost is that of its full network
+    if (!unity && !fusedActive) crossover.setAllpassSum(false);
+    const bool useFused = settled && !unity && !bandsRead
+        && !(fused.isFolded() && crossover.isTimeParallel(0, numChannels, numSamples));
+
+    // The crossover gets its state back before anything else runs it
+    if (fusedActive && !useFused) fused.handState(crossover);
+    crossover.setAllpassSum(settled && unity);
+    if (useFused && !fusedActive) {
+        // Settled split points are the static ones
+        if (fusedCoefficientsStale) fused.setCoefficients(staticCoefficients);
+        fusedCoefficientsStale = false;
+        fused.takeState(crossover);
+    }
+    fusedActive = useFused;
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::Dsp<SampleType>::applyGains(SampleType* const* output,
+                                                            int firstChannel, int endChannel,
+                                                            int numSamples) {
+    using Vectors = juce::FloatVectorOperations;
+
+    const auto bands = getBands();
+    SampleType* const* lowData = bands[0];
+    SampleType* const* midData = bands[1];
+    SampleType* const* highData = bands[2];
+
+    for (int index = 0; index < numDecks; ++index) {
+        const auto& deck = decks[static_cast<size_t>(index)];
+        const auto& gainSmoother = deck.gainSmoother;
+        const int deckFirst = std::max(deck.firstChannel, firstChannel);
+        const int deckEnd = std::min(deck.firstChannel + deck.numChannels, endChannel);
+
+        if (deck.gainsSteady) {
+            // Steady state: all gains have converged, no per-sample smoothing work
+            const SampleType lowGain = gainSmoother.getCurrent(0);
+            const SampleType midGain = gainSmoother.getCurrent(1);
+            const SampleType highGain = gainSmoother.getCurrent(2);
+
+            for (int ch = deckFirst; ch < deckEnd; ++ch) {
+                SampleType* out = output[ch];
+                Vectors::multiply(out, lowData[ch], lowGain, numSamples);
+                Vectors::addWithMultiply(out, midData[ch], midGain, numSamples);
+                Vectors::addWithMultiply(out, highData[ch], highGain, numSamples);
+            }
+        } else {
+            const SampleType* lowRamp = gainSmoother.getRamp(0);
+            const SampleType* midRamp = gainSmoother.getRamp(1);
+            const SampleType* highRamp = gainSmoother.getRamp(2);
+
+            for (int ch = deckFirst; ch < deckEnd; ++ch) {
+                SampleType* out = output[ch];
+                Vectors::multiply(out, lowData[ch], lowRamp, numSamples);
+                Vectors::addWithMultiply(out, midData[ch], midRamp, numSamples);
+                Vectors::addWithMultiply(out, highData[ch], highRamp, numSamples);
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer,
+                                        const juce::MidiBuffer& midiMessages) {
     juce::ScopedNoDenormals noDenormals;
+    const LoadProfiler::ScopedBlock timing(loadProfiler_, buffer.getNumSamples());
+
+    auto& dsp = getDsp<SampleType>();
 
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -96,49 +694,333 @@ void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
+    // New split points glide in over the next few blocks, or once a sweep around them
+    // stops. Both engines follow them, so a mode switch always starts on the current
+    // split points. Offline they are worked out here, at the block they change in.
+    if (isNonRealtime()) crossoverTuner_.update();
+    if (crossoverTuner_.pull(dsp.staticCoefficients)) {
+        dsp.fusedCoefficientsStale = true;
+        if (!dsp.sweeping) dsp.crossover.glideTo(dsp.staticCoefficients);
+    }
+    dsp.linearPhase.updateKernel(
+        [this](LinearPhaseKernel<>& kernel) { return crossoverTuner_.pull(kernel); });
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = std::min(static_cast<int>(totalNumInputChannels),
+                                     dsp.crossover.getNumChannels());
+    SampleType* const* channelData = buffer.getArrayOfWritePointers();
+
+    // Digital silence with the filters rung down passes straight through. MIDI is still
+    // handled below, so controllers and learning keep working while idle.
+    const bool linearPhaseRequested =
+        readParameter(kLinearPhaseTarget, *linearPhaseParam_) >= 0.5f;
+    const bool idle =
+        dsp.updateIdle(buffer, numChannels, linearPhaseRequested != dsp.linearPhaseMode);
+    idle_.store(idle, std::memory_order_relaxed);
+
+    // Scene recalls from the message thread land at the start of the block
+    sceneBankBuffer_.pull(audioScenes_);
+    SceneRecall request;
+    while (sceneRecalls_.pop(request))
+        recall(dsp, request.scene, request.morphTimeSec, request.deck);
+
+    // Mapped MIDI controllers and scene recalls by program change take effect at the
+    // message's sample position: the block is rendered in segments between changes, each
+    // reading the parameters afresh. Scene morphs keep time while idle.
+    int segmentStart = 0;
+    auto renderTo = [&](int position) {
+        position = juce::jlimit(segmentStart, numSamples, position);
+        if (idle)
+            for (auto& deck : dsp.decks) deck.sceneMorph.advance(position - segmentStart);
+        else
+            processSegment(dsp, channelData, numChannels, segmentStart, position - segmentStart);
+        segmentStart = position;
+    };
+
+    for (const auto metadata : midiMessages) {
+        const auto message = metadata.getMessage();
+
+        if (message.isProgramChange()) {
+            // On any channel with a single deck, else on the deck's own channel
+            const int index = message.getProgramChangeNumber();
+            const int deck = numDecks_ > 1 ? message.getChannel() - 1 : 0;
+            if (index >= SceneBank::kNumScenes || deck >= numDecks_) continue;
+
+            renderTo(metadata.samplePosition);
+            recall(dsp, audioScenes_[index], audioScenes_[index].morphTimeSec, deck);
+            continue;
+        }
+        if (!message.isController()) continue;
+
+        // Assignments to decks this build doesn't have come from states saved by others
+        const auto change = midiCcMap_.handleController(
+            message.getChannel(), message.getControllerNumber(), message.getControllerValue());
+        if (!change || midiTargets_[static_cast<size_t>(change->target)] == nullptr) continue;
+
+        renderTo(metadata.samplePosition);
+        midiValues_[static_cast<size_t>(change->target)].store(change->value);
+    }
+    renderTo(numSamples);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::processSegment(Dsp<SampleType>& dsp,
+                                               SampleType* const* channelData, int numChannels,
+                                               int offset, int numSamples) {
+    // Hosts may exceed the block size announced in prepareToPlay, so split into
+    // chunks that fit the band scratch buffer.
+    const int maxChunk = dsp.bandBuffer.getNumSamples();
+    if (numSamples <= 0 || numChannels <= 0 || maxChunk <= 0) return;
+
     // Read parameters
-    float boostMaxDb = kBoostLevels[static_cast<int>(boostParam_->load())];
-    float lowDb = std::min(lowParam_->load(), boostMaxDb);
-    float midDb = std::min(midParam_->load(), boostMaxDb);
-    float highDb = std::min(highParam_->load(), boostMaxDb);
+    std::array<SceneMorph::Values, kMaxDecks> gainParameters;
+    for (int deck = 0; deck < numDecks_; ++deck)
+        gainParameters[static_cast<size_t>(deck)] = readGainParameters(deck);
+    const bool useLinearPhase = readParameter(kLinearPhaseTarget, *linearPhaseParam_) >= 0.5f;
+    const auto drive = static_cast<SampleType>(readParameter(kDriveTarget, *driveParam_) / 100.0f);
+    const bool metering = meteringEnabled_.load(std::memory_order_relaxed);
+    const bool analyzing = analyzerEnabled_.load(std::memory_order_relaxed);
+
+    // The sweep moves around the split points the crossover tuner is working from
+    const CrossoverSweep::Frequencies sweepFrequencies = {lowMidFreqParam_->load(),
+                                                          midHighFreqParam_->load()};
+    const float sweepDepth = readParameter(kSweepDepthTarget, *sweepDepthParam_);
+    const float sweepRate = readParameter(kSweepRateTarget, *sweepRateParam_);
+
+    // A mode change waits for any switch in progress to finish
+    if (useLinearPhase != dsp.linearPhaseMode && !dsp.isSwitchingMode()) {
+        dsp.beginModeSwitch(useLinearPhase);
+        latencySamples_.store(dsp.getLatencySamples());
+    }
+
+    SampleType* const* fadeData = dsp.fadeBuffer.getArrayOfWritePointers();
+
+    // While a scene morphs in, chunks are one morph step long
+    for (int start = 0, chunk = 0; start < numSamples; start += chunk) {
+        chunk = dsp.getStepSamples(std::min(maxChunk, numSamples - start));
+
+        SampleType* channels[kMaxChannels] = {};
+        for (int ch = 0; ch < numChannels; ++ch) channels[ch] = channelData[ch] + offset + start;
+
+        const bool unity = dsp.advanceGains(gainParameters, chunk) && !metering && !analyzing;
+
+        // The analyzer gets whole chunks or none
+        const bool capture = analyzing && spectrumRing_.hasRoom(chunk);
+        if (capture) captureInput(dsp, channels, numChannels, chunk);
 
-    float lowGainTarget = dbToLinear(lowDb);
-    float midGainTarget = dbToLinear(midDb);
-    float highGainTarget = dbToLinear(highDb);
+        // Only the IIR crossover sweeps; the sweep holds still while it isn't running
+        if (!dsp.linearPhaseMode || dsp.isSwitchingMode())
+            dsp.advanceSweep(sweepFrequencies, sweepDepth, sweepRate, chunk);
+        dsp.updateIirEngine(unity, metering || analyzing, numChannels, chunk);
 
-    int numSamples = buffer.getNumSamples();
-    int numChannels = std::min(static_cast<int>(totalNumInputChannels), kNumChannels);
+        if (!dsp.isSwitchingMode()) {
+            if (dsp.linearPhaseMode)
+                dsp.render(dsp.linearPhase, channels, channels, numChannels, chunk, unity);
+            else
+                dsp.renderGroups(workerPool_, channels, numChannels, chunk, unity);
+            dsp.drive.process(channels, numChannels, chunk, drive);
+            meter(dsp, numChannels, chunk, metering);
+            if (capture) captureBands(dsp, numChannels, chunk);
+            continue;
+        }
 
-    for (int s = 0; s < numSamples; ++s) {
-        // Smooth gains (once per sample, shared across channels)
-        smoothedLowGain_ += smoothAlpha_ * (lowGainTarget - smoothedLowGain_);
-        smoothedMidGain_ += smoothAlpha_ * (midGainTarget - smoothedMidGain_);
-        smoothedHighGain_ += smoothAlpha_ * (highGainTarget - smoothedHighGain_);
+        // Mode switch: the outgoing engine renders aside, the incoming one in place
+        if (dsp.linearPhaseMode) {
+            dsp.render(dsp.crossover, channels, fadeData, numChannels, chunk, unity);
+            dsp.render(dsp.linearPhase, channels, channels, numChannels, chunk, unity);
+        } else {
+            dsp.render(dsp.linearPhase, channels, fadeData, numChannels, chunk, unity);
+            dsp.render(dsp.crossover, channels, channels, numChannels, chunk, unity);
+        }
 
+        const auto crossfadeSamples = static_cast<SampleType>(dsp.modeCrossfadeSamples);
         for (int ch = 0; ch < numChannels; ++ch) {
-            float input = buffer.getSample(ch, s);
+            SampleType* out = channels[ch];
+            const SampleType* outgoing = fadeData[ch];
+            for (int i = 0; i < chunk; ++i) {
+                const int ramp = dsp.modeSwitchPosition + i - dsp.modeWarmupSamples;
+                const SampleType weight = juce::jlimit(
+                    SampleType{}, SampleType{1}, static_cast<SampleType>(ramp) / crossfadeSamples);
+                out[i] = outgoing[i] + weight * (out[i] - outgoing[i]);
+            }
+        }
+
+        dsp.modeSwitchPosition += chunk;
+        if (dsp.modeSwitchPosition >= dsp.modeWarmupSamples + dsp.modeCrossfadeSamples)
+            dsp.modeSwitchPosition = -1;
+
+        dsp.drive.process(channels, numChannels, chunk, drive);
+
+        // The band buffers hold the incoming engine's bands, rendered last
+        meter(dsp, numChannels, chunk, metering);
+        if (capture) captureBands(dsp, numChannels, chunk);
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::meter(Dsp<SampleType>& dsp, int numChannels, int numSamples,
+                                      bool metering) {
+    if (!metering) return;
+
+    // One deck's channels
+    const auto deckIndex = static_cast<size_t>(meteredDeck_.load(std::memory_order_relaxed));
+    const auto& deck = dsp.decks[deckIndex];
+    auto bands = dsp.getBands();
+    for (auto& band : bands) band += deck.firstChannel;
+
+    const auto& smoother = deck.gainSmoother;
+    const typename BandMeter<SampleType>::Gains gains = {
+        smoother.getCurrent(0), smoother.getCurrent(1), smoother.getCurrent(2)};
+    const int meteredChannels = std::min(deck.numChannels, numChannels - deck.firstChannel);
+    if (dsp.bandMeter.addBlock(bands, meteredChannels, numSamples, gains))
+        meterQueue_.push(dsp.bandMeter.getLevels());  // dropped if the editor is behind
+}
 
-            auto [low, mid, high] = crossover_.processSample(ch, input);
+template <typename SampleType>
+void AudioPluginAudioProcessor::captureInput(const Dsp<SampleType>& dsp,
+                                             const SampleType* const* channels, int numChannels,
+                                             int numSamples) {
+    const auto deckIndex = static_cast<size_t>(meteredDeck_.load(std::memory_order_relaxed));
+    const auto& deck = dsp.decks[deckIndex];
+    const int endChannel = std::min(deck.firstChannel + deck.numChannels, numChannels);
+    const auto scale = SampleType{1} / static_cast<SampleType>(std::max(1, deck.numChannels));
 
-            low *= smoothedLowGain_;
-            mid *= smoothedMidGain_;
-            high *= smoothedHighGain_;
+    for (int i = 0; i < numSamples; ++i) {
+        SampleType sum{};
+        for (int ch = deck.firstChannel; ch < endChannel; ++ch) sum += channels[ch][i];
+        spectrumRing_.set(0, static_cast<size_t>(i), static_cast<float>(sum * scale));
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::captureBands(Dsp<SampleType>& dsp, int numChannels,
+                                             int numSamples) {
+    const auto deckIndex = static_cast<size_t>(meteredDeck_.load(std::memory_order_relaxed));
+    const auto& deck = dsp.decks[deckIndex];
+    const int endChannel = std::min(deck.firstChannel + deck.numChannels, numChannels);
+    const auto scale = SampleType{1} / static_cast<SampleType>(std::max(1, deck.numChannels));
 
-            buffer.setSample(ch, s, low + mid + high);
+    // The band buffers hold the bands before their gains, as the meters read them
+    const auto bands = dsp.getBands();
+    for (size_t band = 0; band < kNumBands; ++band) {
+        const SampleType gain = scale * deck.gainSmoother.getCurrent(static_cast<int>(band));
+        for (int i = 0; i < numSamples; ++i) {
+            SampleType sum{};
+            for (int ch = deck.firstChannel; ch < endChannel; ++ch) sum += bands[band][ch][i];
+            spectrumRing_.set(1 + band, static_cast<size_t>(i), static_cast<float>(sum * gain));
         }
     }
+    spectrumRing_.commit(numSamples);
 }
 
 void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
-    auto state = apvts_.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    BinaryStateWriter writer(destData);
+
+    writer.writeChunk(kParametersChunk, [this](juce::OutputStream& stream) {
+        const auto count = std::count_if(parameters_.begin(), parameters_.end(),
+                                         [](const auto* param) { return param != nullptr; });
+        stream.writeByte(static_cast<char>(count));
+        for (size_t index = 0; index < parameters_.size(); ++index) {
+            const auto* param = parameters_[index];
+            if (param == nullptr) continue;
+
+            BinaryState::writeId(stream, kAllParameterIds[index]);
+            stream.writeFloat(param->convertFrom0to1(param->getValue()));
+        }
+    });
+    writer.writeChunk(MidiCcMap::kChunkTag,
+                      [this](juce::OutputStream& stream) { midiCcMap_.writeTo(stream); });
+    writer.writeChunk(SceneBank::kChunkTag,
+                      [this](juce::OutputStream& stream) { scenes_.writeTo(stream); });
+    writer.writeChunk(kWorkersChunk, [this](juce::OutputStream& stream) {
+        stream.writeByte(static_cast<char>(numWorkerThreads_.load()));
+    });
+}
+
+void AudioPluginAudioProcessor::getLoadStatsInformation(juce::MemoryBlock& destData) const {
+    BinaryStateWriter writer(destData);
+    writer.writeChunk(LoadStats::kChunkTag,
+                      [stats = loadProfiler_.getStats()](juce::OutputStream& stream) {
+                          stats.writeTo(stream);
+                      });
 }
 
 void AudioPluginAudioProcessor::setStateInformation(const void* data, int sizeInBytes) {
+    const auto size = static_cast<size_t>(std::max(sizeInBytes, 0));
+    if (BinaryStateReader::canRead(data, size))
+        setBinaryState(data, size);
+    else
+        setXmlState(data, sizeInBytes);
+}
+
+void AudioPluginAudioProcessor::setBinaryState(const void* data, size_t size) {
+    // Normalised values. Parameters the state doesn't hold go back to their defaults, as
+    // they do when the APVTS replaces its state.
+    std::array<float, kMaxParameters> values{};
+    for (size_t index = 0; index < parameters_.size(); ++index)
+        if (parameters_[index] != nullptr) values[index] = parameters_[index]->getDefaultValue();
+    bool hasMidiCc = false;
+    int numWorkers = 0;
+    scenes_ = {};
+
+    BinaryStateReader reader(data, size);
+    while (reader.nextChunk()) {
+        auto& payload = reader.getPayload();
+
+        if (reader.getTag() == MidiCcMap::kChunkTag) {
+            midiCcMap_.readFrom(payload);
+            hasMidiCc = true;
+        } else if (reader.getTag() == SceneBank::kChunkTag) {
+            scenes_.readFrom(payload);
+        } else if (reader.getTag() == kWorkersChunk && payload.getNumBytesRemaining() > 0) {
+            numWorkers = static_cast<uint8_t>(payload.readByte());
+        } else if (reader.getTag() == kParametersChunk && payload.getNumBytesRemaining() > 0) {
+            BinaryState::IdBuffer idBuffer;
+            const int count = static_cast<uint8_t>(payload.readByte());
+            for (int entry = 0; entry < count; ++entry) {
+                const auto id = BinaryState::readId(payload, idBuffer);
+                if (!id || payload.getNumBytesRemaining() < 4) break;
+
+                const float value = payload.readFloat();
+                const auto found =
+                    std::find(kAllParameterIds.begin(), kAllParameterIds.end(), *id);
+                if (found == kAllParameterIds.end()) continue;  // from a later version
+
+                // Decks this build doesn't have are dropped
+                const auto index = static_cast<size_t>(found - kAllParameterIds.begin());
+                if (parameters_[index] != nullptr)
+                    values[index] = parameters_[index]->convertTo0to1(value);
+            }
+        }
+    }
+
+    if (!hasMidiCc) midiCcMap_.clearAll();
+    publishScenes();
+
+    // Capped for states saved on a machine with more cores. Hosts may restore off the
+    // message thread, so the workers start in timerCallback(), or prepareToPlay().
+    numWorkerThreads_.store(juce::jlimit(0, getMaxWorkerThreads(), numWorkers));
+
+    for (size_t index = 0; index < parameters_.size(); ++index) {
+        auto* param = parameters_[index];
+        if (param != nullptr && !juce::exactlyEqual(param->getValue(), values[index]))
+            param->setValueNotifyingHost(values[index]);
+    }
+}
+
+void AudioPluginAudioProcessor::setXmlState(const void* data, int sizeInBytes) {
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    if (xmlState != nullptr && xmlState->hasTagName(apvts_.state.getType()))
+    if (xmlState != nullptr && xmlState->hasTagName(apvts_.state.getType())) {
+        midiCcMap_.loadFrom(*xmlState);
+        xmlState->deleteAllChildElementsWithTagName(MidiCcMap::kStateTag);
+        // Legacy XML states saved the load figures too; they are not parameters
+        xmlState->deleteAllChildElementsWithTagName(LoadStats::kStateTag);
         apvts_.replaceState(juce::ValueTree::fromXml(*xmlState));
+
+        // Scenes came with the binary format
+        scenes_ = {};
+        publishScenes();
+    }
 }
 
 bool AudioPluginAudioProcessor::hasEditor() const { return true; }
@@ -150,5 +1032,5 @@ juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor() {
 }  // namespace audio_plugin
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() {
-    return new audio_plugin::AudioPluginAudioProcessor();
+    return new audio_plugin::AudioPluginAudioProcessor(ISO3D_NUM_DECKS);
 }
@@ -0,0 +1,68 @@
+#include <Iso3D/Scenes.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace audio_plugin {
+
+namespace {
+
+constexpr int kNumBoostLevels = static_cast<int>(std::size(kBoostLevels));
+constexpr float kMaxMorphTimeSec = 60.0f;
+
+}  // namespace
+
+void SceneBank::writeTo(juce::OutputStream& stream) const {
+    stream.writeByte(static_cast<char>(kNumScenes));
+    for (const auto& scene : scenes) {
+        for (const float gainDb : scene.gainsDb) stream.writeFloat(gainDb);
+        stream.writeByte(static_cast<char>(scene.boost));
+        stream.writeFloat(scene.morphTimeSec);
+    }
+}
+
+void SceneBank::readFrom(juce::InputStream& stream) {
+    scenes = {};
+
+    constexpr juce::int64 kSceneSize = kNumBands * 4 + 1 + 4;
+    const int count = stream.getNumBytesRemaining() > 0 ? static_cast<uint8_t>(stream.readByte())
+                                                        : 0;
+    for (int index = 0; index < std::min(count, kNumScenes); ++index) {
+        if (stream.getNumBytesRemaining() < kSceneSize) return;
+
+        auto& scene = (*this)[index];
+        for (auto& gainDb : scene.gainsDb)
+            gainDb = juce::jlimit(kKillThresholdDb, kMaxBandGainDb, stream.readFloat());
+        scene.boost = juce::jlimit(0, kNumBoostLevels - 1,
+                                   static_cast<int>(static_cast<uint8_t>(stream.readByte())));
+        scene.morphTimeSec = juce::jlimit(0.0f, kMaxMorphTimeSec, stream.readFloat());
+    }
+}
+
+void SceneMorph::prepare(double sampleRate) {
+    sampleRate_ = sampleRate;
+    position_ = 0;
+    length_ = 0;
+}
+
+void SceneMorph::start(const Values& from, float morphTimeSec) {
+    from_ = from;
+    position_ = 0;
+    length_ = juce::roundToInt(static_cast<double>(morphTimeSec) * sampleRate_);
+}
+
+SceneMorph::Values SceneMorph::apply(const Values& target) const {
+    if (!isActive()) return target;
+
+    const float progress = static_cast<float>(position_) / static_cast<float>(length_);
+    Values values;
+    for (size_t band = 0; band < values.gainsDb.size(); ++band)
+        values.gainsDb[band] =
+            from_.gainsDb[band] + progress * (target.gainsDb[band] - from_.gainsDb[band]);
+    values.boostMaxDb = from_.boostMaxDb + progress * (target.boostMaxDb - from_.boostMaxDb);
+    return values;
+}
+
+void SceneMorph::advance(int numSamples) { position_ = std::min(position_ + numSamples, length_); }
+
+}  // namespace audio_plugin
@@ -0,0 +1,193 @@
+#include <Iso3D/SpectrumAnalyzer.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_plugin {
+
+namespace {
+
+constexpr int kStopTimeoutMs = 1000;
+constexpr int kFrameIntervalMs = 1000 / SpectrumAnalyzer::kFrameRateHz;
+
+// Frames with no samples before the history is treated as silence
+constexpr int kStaleFrames = static_cast<int>(
+    SpectrumAnalyzer::kStaleTimeSec * static_cast<float>(SpectrumAnalyzer::kFrameRateHz));
+
+float toDb(float magnitude) {
+    return magnitude > 0.0f
+        ? std::max(SpectrumAnalyzer::kMinDb, 20.0f * std::log10(magnitude))
+        : SpectrumAnalyzer::kMinDb;
+}
+
+}  // namespace
+
+void SpectrumRing::read(size_t trace, float* destination, size_t numSamples) const {
+    // In at most two runs, split where the ring wraps
+    const auto& samples = traces_[trace];
+    const size_t start = read_.load(std::memory_order_relaxed) & kMask;
+    const size_t first = std::min(numSamples, kCapacity - start);
+    std::copy_n(samples.begin() + static_cast<std::ptrdiff_t>(start), first, destination);
+    std::copy_n(samples.begin(), numSamples - first, destination + first);
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(SpectrumRing& ring)
+    : juce::Thread("Iso3D spectrum analyzer"), ring_(ring) {
+    for (auto& spectrum : spectra_) spectrum.fill(kMinDb);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() { stop(); }
+
+void SpectrumAnalyzer::start() {
+    stop();
+
+    // Whatever was left in the ring is from before the analyzer last stopped
+    ring_.discard(ring_.getNumReady());
+    paths_.clear();
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyzer::stop() { stopThread(kStopTimeoutMs); }
+
+SpectrumAnalyzer::FrameStats SpectrumAnalyzer::getFrameStats() const {
+    return {statsFrames_.load(), statsMeanMs_.load(), statsMaxMs_.load()};
+}
+
+float SpectrumAnalyzer::frequencyOf(size_t point) {
+    const float position = static_cast<float>(point) / static_cast<float>(kNumPoints - 1);
+    return kMinHz * std::pow(kMaxHz / kMinHz, position);
+}
+
+void SpectrumAnalyzer::run() {
+    while (!threadShouldExit()) {
+        processFrame();
+        wait(kFrameIntervalMs);
+    }
+}
+
+void SpectrumAnalyzer::prepare(double sampleRate) {
+    sampleRate_ = sampleRate;
+
+    window_.resize(kFftSize);
+    fftData_.assign(2 * kFftSize, 0.0f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(
+        window_.data(), kFftSize, juce::dsp::WindowingFunction<float>::hann, false);
+
+    // A full-scale sine on a bin comes out at half the window's sum
+    double windowSum = 0.0;
+    for (const float w : window_) windowSum += static_cast<double>(w);
+    magnitudeScale_ = static_cast<float>(2.0 / windowSum);
+
+    // Each point covers the bins within half a point of it. Low down, where points are
+    // closer together than bins, that is none, and it reads between its two nearest.
+    const double binsPerHz = static_cast<double>(kFftSize) / sampleRate;
+    const double halfStep = std::log2(static_cast<double>(kMaxHz / kMinHz))
+        / (2.0 * static_cast<double>(kNumPoints - 1));
+    const double lastBin = static_cast<double>(kFftSize / 2 - 1);
+    for (size_t point = 0; point < kNumPoints; ++point) {
+        const double centre = static_cast<double>(frequencyOf(point)) * binsPerHz;
+        const double low = std::min(lastBin, std::ceil(centre * std::exp2(-halfStep)));
+        const double high = std::min(lastBin, std::floor(centre * std::exp2(halfStep)));
+
+        auto& bins = pointBins_[point];
+        if (high >= low) {
+            bins = {static_cast<size_t>(low), static_cast<size_t>(high), 0.0f};
+        } else {
+            const double first = std::min(lastBin, std::floor(centre));
+            bins = {static_cast<size_t>(first), static_cast<size_t>(first),
+                    static_cast<float>(std::min(1.0, centre - first))};
+        }
+    }
+
+    for (auto& history : history_) history.assign(kFftSize, 0.0f);
+    for (auto& spectrum : spectra_) spectrum.fill(kMinDb);
+    framesWithoutSamples_ = 0;
+}
+
+void SpectrumAnalyzer::processFrame() {
+    const juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+
+    const double sampleRate = ring_.getSampleRate();
+    if (sampleRate <= 0.0) return;
+    if (!juce::exactlyEqual(sampleRate, sampleRate_)) prepare(sampleRate);
+
+    // Append the newest samples to each history; older ones would only be shifted out
+    const size_t numReady = ring_.getNumReady();
+    if (numReady > 0) {
+        const size_t numNew = std::min(numReady, kFftSize);
+        ring_.discard(numReady - numNew);
+        for (size_t trace = 0; trace < kNumSpectrumTraces; ++trace) {
+            auto& history = history_[trace];
+            std::copy(history.begin() + static_cast<std::ptrdiff_t>(numNew), history.end(),
+                      history.begin());
+            ring_.read(trace, history.data() + (kFftSize - numNew), numNew);
+        }
+        ring_.discard(numNew);
+        framesWithoutSamples_ = 0;
+    } else if (++framesWithoutSamples_ == kStaleFrames) {
+        for (auto& history : history_) std::fill(history.begin(), history.end(), 0.0f);
+    }
+
+    const float fallCoefficient =
+        std::exp(-1.0f / (kFallTimeSec * static_cast<float>(kFrameRateHz)));
+
+    for (size_t trace = 0; trace < kNumSpectrumTraces; ++trace) {
+        const auto& history = history_[trace];
+        for (size_t n = 0; n < kFftSize; ++n) fftData_[n] = history[n] * window_[n];
+        std::fill(fftData_.begin() + static_cast<std::ptrdiff_t>(kFftSize), fftData_.end(),
+                  0.0f);
+        fft_.performFrequencyOnlyForwardTransform(fftData_.data(), true);
+
+        auto& spectrum = spectra_[trace];
+        for (size_t point = 0; point < kNumPoints; ++point) {
+            const auto& bins = pointBins_[point];
+            float magnitude = fftData_[bins.first];
+            if (bins.first == bins.last && bins.fraction > 0.0f)
+                magnitude += bins.fraction * (fftData_[bins.first + 1] - magnitude);
+            for (size_t bin = bins.first + 1; bin <= bins.last; ++bin)
+                magnitude = std::max(magnitude, fftData_[bin]);
+
+            // Rises at once, falls back over kFallTimeSec
+            const float db = toDb(magnitude * magnitudeScale_);
+            spectrum[point] = db >= spectrum[point]
+                ? db
+                : db + fallCoefficient * (spectrum[point] - db);
+        }
+    }
+
+    // A refused push would be dropped, so no paths are built until the editor has taken
+    // the last ones
+    if (paths_.canPush()) {
+        Paths paths;
+        for (size_t trace = 0; trace < kNumSpectrumTraces; ++trace) {
+            auto& path = paths[trace];
+            path.preallocateSpace(3 * static_cast<int>(kNumPoints));
+            for (size_t point = 0; point < kNumPoints; ++point) {
+                const float x = static_cast<float>(point) / static_cast<float>(kNumPoints - 1);
+                const float y = (kMaxDb - spectra_[trace][point]) / (kMaxDb - kMinDb);
+                if (point == 0)
+                    path.startNewSubPath(x, std::clamp(y, 0.0f, 1.0f));
+                else
+                    path.lineTo(x, std::clamp(y, 0.0f, 1.0f));
+            }
+        }
+        paths_.push(paths);
+    }
+
+    const double ms = 1000.0 * juce::Time::highResolutionTicksToSeconds(
+                                   juce::Time::getHighResolutionTicks() - startTicks);
+    ++frameCount_;
+    frameTotalMs_ += ms;
+    frameMaxMs_ = std::max(frameMaxMs_, ms);
+    if (frameCount_ == kFrameRateHz) {
+        statsFrames_.store(frameCount_);
+        statsMeanMs_.store(frameTotalMs_ / static_cast<double>(frameCount_));
+        statsMaxMs_.store(frameMaxMs_);
+        frameCount_ = 0;
+        frameTotalMs_ = 0.0;
+        frameMaxMs_ = 0.0;
+    }
+}
+
+}  // namespace audio_plugin
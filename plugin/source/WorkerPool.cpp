@@ -0,0 +1,111 @@
+#include <Iso3D/WorkerPool.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace audio_plugin {
+
+namespace {
+
+// Long enough to cover the segments and chunks of one block, short enough not to keep
+// cores busy between blocks
+constexpr double kSpinTimeSec = 0.0002;
+constexpr int kStopTimeoutMs = 1000;
+
+}  // namespace
+
+class WorkerPool::Worker : public juce::Thread {
+public:
+    explicit Worker(WorkerPool& pool) : juce::Thread("Iso3D worker"), pool_(pool) {}
+    ~Worker() override { stopThread(kStopTimeoutMs); }
+
+    void run() override {
+        int generation = pool_.generation_.load(std::memory_order_acquire);
+        while (!threadShouldExit()) {
+            generation = pool_.waitForJob(*this, generation);
+            if (!threadShouldExit()) pool_.work();
+        }
+    }
+
+private:
+    WorkerPool& pool_;
+};
+
+WorkerPool::WorkerPool() = default;
+WorkerPool::~WorkerPool() { stop(); }
+
+bool WorkerPool::start(int numWorkers, double sampleRate, int samplesPerBlock) {
+    stop();
+    if (numWorkers <= 0) return true;
+
+    spinTicks_ = static_cast<juce::int64>(
+        kSpinTimeSec * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()));
+
+    const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(
+        std::max(1, samplesPerBlock), sampleRate);
+    for (int index = 0; index < numWorkers; ++index) {
+        workers_.push_back(std::make_unique<Worker>(*this));
+        if (!workers_.back()->startRealtimeThread(options)) {
+            stop();
+            return false;
+        }
+    }
+    numActiveWorkers_.store(numWorkers);
+    return true;
+}
+
+void WorkerPool::stop() {
+    // From here on run() works alone; jobs already published finish on whoever took them
+    numActiveWorkers_.store(0);
+
+    for (auto& worker : workers_) worker->signalThreadShouldExit();
+    generation_.fetch_add(1);
+    generation_.notify_all();
+    workers_.clear();
+}
+
+void WorkerPool::runJob(int numTasks, void* context, TaskFunction function) {
+    function_.store(function, std::memory_order_relaxed);
+    context_.store(context, std::memory_order_relaxed);
+    numTasks_.store(numTasks, std::memory_order_relaxed);
+    completedTasks_.store(0, std::memory_order_relaxed);
+    nextTask_.store(0, std::memory_order_release);
+
+    generation_.fetch_add(1);
+    if (numParked_.load() > 0) generation_.notify_all();
+
+    work();
+
+    // Barrier: tasks claimed by workers may still be running. Yielding lets a worker
+    // that shares this core finish them.
+    while (completedTasks_.load(std::memory_order_acquire) < numTasks)
+        std::this_thread::yield();
+    nextTask_.store(kClosed, std::memory_order_relaxed);
+}
+
+void WorkerPool::work() {
+    for (;;) {
+        const int index = nextTask_.fetch_add(1, std::memory_order_acquire);
+        if (index >= numTasks_.load(std::memory_order_relaxed)) return;
+
+        function_.load(std::memory_order_relaxed)(context_.load(std::memory_order_relaxed),
+                                                  index);
+        completedTasks_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+int WorkerPool::waitForJob(const Worker& worker, int seen) {
+    const auto spinUntil = juce::Time::getHighResolutionTicks() + spinTicks_;
+    while (generation_.load(std::memory_order_acquire) == seen && !worker.threadShouldExit()
+           && juce::Time::getHighResolutionTicks() < spinUntil)
+        std::this_thread::yield();
+
+    // Parked workers are counted before they check the generation a last time, and run()
+    // counts them after moving it on, so one of the two always sees the other
+    numParked_.fetch_add(1);
+    generation_.wait(seen);
+    numParked_.fetch_sub(1);
+    return generation_.load(std::memory_order_acquire);
+}
+
+}  // namespace audio_plugin
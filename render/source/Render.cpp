@@ -0,0 +1,362 @@
+// Iso3D offline renderer: streams WAV and AIFF files through AudioPluginAudioProcessor
+// without a host, for batch-processing recorded sets. Inputs are memory-mapped and run
+// through the processor in large blocks, and several files render in parallel on a
+// thread pool. Within a file, reading, processing and writing overlap: a reader thread
+// decodes ahead of the processor and a writer thread encodes behind it.
+//
+// Output keeps the input's format, sample rate, bit depth and metadata, and is aligned
+// with the input: the processor's latency (linear-phase mode) is trimmed from the start
+// and flushed out at the end.
+//
+// Usage:
+//   AudioPluginRender [--timeline=<timeline.txt>] [--output-dir=<dir>] [--block=<samples>]
+//                     [--jobs=<n>] <input files...>
+//
+// A timeline file holds one parameter change per line, in the parameter's own units
+// (dB, Hz, boost step, 0/1 for switches), applied at that point of the input:
+//   # seconds  parameter    value
+//   0          linearPhase  1
+//   12.5       low          -100
+//   16         low          0
+// Changes at time 0 are applied before the processor is prepared, so they also choose
+// the mode whose latency is compensated.
+
+#include <Iso3D/Constants.h>
+#include <Iso3D/PluginProcessor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace audio_plugin;
+
+namespace {
+
+constexpr int kDefaultBlockSize = 8192;
+constexpr int kMaxBlockSize = 1 << 16;
+
+// Decoded ahead of and encoded behind the processor, in blocks
+constexpr int kReadAheadBlocks = 8;
+constexpr int kWriteBehindBlocks = 8;
+constexpr int kWriterRetryMs = 1;
+
+constexpr const char* kOutputSuffix = "-iso3d";
+
+struct Settings {
+    juce::File outputDir;  // next to each input when unset
+    int blockSize = kDefaultBlockSize;
+    int numJobs = juce::SystemStats::getNumCpus();
+};
+
+struct ParameterChange {
+    double timeSec = 0.0;
+    juce::String parameterId;
+    float value = 0.0f;
+};
+
+// Sorted by time; changes at the same time keep their file order
+using Timeline = std::vector<ParameterChange>;
+
+bool isNumber(const juce::String& token) {
+    return token.isNotEmpty() && token.containsOnly("+-.0123456789eE");
+}
+
+// Parses a timeline file, checking every parameter ID against apvts. Returns false with
+// a message naming the offending line on the first malformed one.
+bool parseTimeline(const juce::File& file, const juce::AudioProcessorValueTreeState& apvts,
+                   Timeline& timeline, juce::String& error) {
+    if (!file.existsAsFile()) {
+        error = "No timeline file at " + file.getFullPathName();
+        return false;
+    }
+
+    juce::StringArray lines;
+    lines.addLines(file.loadFileAsString());
+
+    for (int i = 0; i < lines.size(); ++i) {
+        const auto line = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+        if (line.isEmpty()) continue;
+
+        const auto where = file.getFileName() + ":" + juce::String(i + 1) + ": ";
+        const auto tokens = juce::StringArray::fromTokens(line, true);
+        if (tokens.size() != 3 || !isNumber(tokens[0]) || !isNumber(tokens[2])) {
+            error = where + "expected <seconds> <parameter> <value>";
+            return false;
+        }
+        if (apvts.getParameter(tokens[1]) == nullptr) {
+            error = where + "unknown parameter '" + tokens[1] + "'";
+            return false;
+        }
+
+        const double timeSec = tokens[0].getDoubleValue();
+        if (timeSec < 0.0) {
+            error = where + "negative time";
+            return false;
+        }
+        timeline.push_back({timeSec, tokens[1], tokens[2].getFloatValue()});
+    }
+
+    std::stable_sort(timeline.begin(), timeline.end(),
+                     [](const auto& a, const auto& b) { return a.timeSec < b.timeSec; });
+    return true;
+}
+
+void applyChange(juce::AudioProcessorValueTreeState& apvts, const ParameterChange& change) {
+    auto* param = apvts.getParameter(change.parameterId);
+    param->setValueNotifyingHost(param->convertTo0to1(change.value));
+}
+
+juce::File outputFileFor(const juce::File& input, const juce::File& outputDir) {
+    const auto directory = outputDir == juce::File() ? input.getParentDirectory() : outputDir;
+    return directory.getChildFile(input.getFileNameWithoutExtension() + kOutputSuffix
+                                  + input.getFileExtension());
+}
+
+// Renders one file on a pool thread. The processor is created and destroyed with the
+// job on the main thread, which owns the message manager its parameter state expects.
+class RenderJob : public juce::ThreadPoolJob {
+public:
+    RenderJob(juce::AudioFormat& format, const Settings& settings, const Timeline& timeline,
+              const juce::File& input)
+        : juce::ThreadPoolJob("Iso3D render " + input.getFileName()),
+          format_(format),
+          settings_(settings),
+          timeline_(timeline),
+          input_(input),
+          output_(outputFileFor(input, settings.outputDir)) {}
+
+    JobStatus runJob() override {
+        const auto start = std::chrono::steady_clock::now();
+        succeeded_ = render();
+        elapsedSec_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                          .count();
+        return jobHasFinished;
+    }
+
+    const juce::File& getInput() const { return input_; }
+    const juce::File& getOutput() const { return output_; }
+    bool succeeded() const { return succeeded_; }
+    const juce::String& getError() const { return error_; }
+
+    // Audio rendered per second of wall-clock time
+    double getRealtimeFactor() const {
+        return elapsedSec_ > 0.0 ? renderedSec_ / elapsedSec_ : 0.0;
+    }
+
+private:
+    bool fail(const juce::String& message) {
+        error_ = message;
+        return false;
+    }
+
+    bool render();
+
+    juce::AudioFormat& format_;
+    const Settings& settings_;
+    const Timeline& timeline_;
+    const juce::File input_;
+    const juce::File output_;
+
+    AudioPluginAudioProcessor processor_;
+
+    bool succeeded_ = false;
+    juce::String error_;
+    double renderedSec_ = 0.0;
+    double elapsedSec_ = 0.0;
+};
+
+bool RenderJob::render() {
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(
+        format_.createMemoryMappedReader(input_));
+    if (mapped == nullptr || !mapped->mapEntireFile())
+        return fail("Could not map " + input_.getFullPathName());
+
+    const int numChannels = static_cast<int>(mapped->numChannels);
+    const double sampleRate = mapped->sampleRate;
+    const juce::int64 length = mapped->lengthInSamples;
+    const int blockSize = settings_.blockSize;
+    if (numChannels < 1 || numChannels > kMaxChannels)
+        return fail(juce::String(numChannels) + " channels, at most "
+                    + juce::String(kMaxChannels) + " are supported");
+
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(channelSet);
+    layout.outputBuses.add(channelSet);
+    if (!processor_.setBusesLayout(layout))
+        return fail("Unsupported channel layout " + channelSet.getDescription());
+
+    if (!output_.getParentDirectory().createDirectory())
+        return fail("Could not create " + output_.getParentDirectory().getFullPathName());
+
+    // FileOutputStream appends to an existing file
+    output_.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(output_);
+    if (!stream->openedOk()) return fail("Could not open " + output_.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format_.createWriterFor(
+        stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+        static_cast<int>(mapped->bitsPerSample), mapped->metadataValues, 0));
+    if (writer == nullptr) return fail("Could not write " + output_.getFullPathName());
+    stream.release();  // owned by the writer from here
+
+    // Declared before the reader and writer that use them, so they outlive both
+    juce::TimeSliceThread readThread("Iso3D render reader");
+    juce::TimeSliceThread writeThread("Iso3D render writer");
+    readThread.startThread();
+    writeThread.startThread();
+
+    juce::BufferingAudioReader reader(mapped.release(), readThread, kReadAheadBlocks * blockSize);
+    reader.setReadTimeout(-1);  // offline: wait for the reader rather than read silence
+
+    // Flushes whatever is still queued when it goes out of scope
+    juce::AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writeThread,
+                                                           kWriteBehindBlocks * blockSize);
+
+    auto& apvts = processor_.getAPVTS();
+    size_t nextChange = 0;
+    auto changeSample = [&](size_t index) {
+        return static_cast<juce::int64>(std::llround(timeline_[index].timeSec * sampleRate));
+    };
+    auto applyChangesUpTo = [&](juce::int64 sample) {
+        for (; nextChange < timeline_.size() && changeSample(nextChange) <= sample; ++nextChange)
+            applyChange(apvts, timeline_[nextChange]);
+    };
+
+    applyChangesUpTo(0);
+    // Offline, parameter changes reach the audio at the block they land in, every render
+    processor_.setNonRealtime(true);
+    processor_.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    const float* written[kMaxChannels] = {};
+
+    // The first latency samples out of the processor precede the input, so they are
+    // dropped, and silence is fed past the end of the input to flush the rest.
+    juce::int64 toSkip = processor_.getLatencySamples();
+    juce::int64 toWrite = length;
+
+    for (juce::int64 position = 0; toWrite > 0; position += blockSize) {
+        if (shouldExit()) return fail("Cancelled");
+
+        const auto numRead = static_cast<int>(
+            juce::jlimit(juce::int64{0}, juce::int64{blockSize}, length - position));
+        if (numRead > 0) reader.read(&buffer, 0, numRead, position, true, true);
+        if (numRead < blockSize) buffer.clear(numRead, blockSize - numRead);
+
+        // Timeline changes land on the sample they name, by splitting the block there
+        for (int start = 0; start < blockSize;) {
+            applyChangesUpTo(position + start);
+
+            int end = blockSize;
+            if (nextChange < timeline_.size())
+                end = static_cast<int>(
+                    std::min(juce::int64{blockSize}, changeSample(nextChange) - position));
+
+            juce::AudioBuffer<float> part(buffer.getArrayOfWritePointers(), numChannels, start,
+                                          end - start);
+            processor_.processBlock(part, midi);
+            start = end;
+        }
+
+        const auto skip = static_cast<int>(std::min(toSkip, juce::int64{blockSize}));
+        const auto numWrite = static_cast<int>(std::min(toWrite, juce::int64{blockSize - skip}));
+        toSkip -= skip;
+        if (numWrite <= 0) continue;
+
+        for (int ch = 0; ch < numChannels; ++ch) written[ch] = buffer.getReadPointer(ch, skip);
+        while (!threadedWriter.write(written, numWrite)) {
+            // The writer is behind; the disk sets the pace
+            if (shouldExit()) return fail("Cancelled");
+            juce::Thread::sleep(kWriterRetryMs);
+        }
+        toWrite -= numWrite;
+    }
+
+    processor_.releaseResources();
+    renderedSec_ = static_cast<double>(length) / sampleRate;
+    return true;
+}
+
+juce::File resolvePath(const juce::String& path) {
+    return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    juce::Array<juce::File> inputs;
+    for (const auto& arg : args.arguments)
+        if (!arg.isOption()) inputs.add(arg.resolveAsFile());
+
+    if (args.containsOption("--help|-h") || inputs.isEmpty()) {
+        std::printf("AudioPluginRender [--timeline=<file>] [--output-dir=<dir>]\n"
+                    "                  [--block=<samples>] [--jobs=<n>] <input files...>\n");
+        return inputs.isEmpty() && !args.containsOption("--help|-h") ? 1 : 0;
+    }
+
+    Settings settings;
+    const auto outputDir = args.getValueForOption("--output-dir");
+    if (outputDir.isNotEmpty()) settings.outputDir = resolvePath(outputDir);
+    const auto blockArg = args.getValueForOption("--block");
+    if (blockArg.isNotEmpty())
+        settings.blockSize = juce::jlimit(1, kMaxBlockSize, blockArg.getIntValue());
+    const auto jobsArg = args.getValueForOption("--jobs");
+    if (jobsArg.isNotEmpty()) settings.numJobs = juce::jmax(1, jobsArg.getIntValue());
+
+    Timeline timeline;
+    const auto timelinePath = args.getValueForOption("--timeline");
+    if (timelinePath.isNotEmpty()) {
+        AudioPluginAudioProcessor reference;  // parameter IDs to check against
+        juce::String error;
+        if (!parseTimeline(resolvePath(timelinePath), reference.getAPVTS(), timeline, error)) {
+            std::fprintf(stderr, "%s\n", error.toRawUTF8());
+            return 1;
+        }
+    }
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    int failures = 0;
+    std::vector<std::unique_ptr<RenderJob>> jobs;
+    for (const auto& input : inputs) {
+        auto* format = formats.findFormatForFileExtension(input.getFileExtension());
+        if (!input.existsAsFile() || format == nullptr) {
+            std::fprintf(stderr, "Skipping %s: not a readable WAV or AIFF file\n",
+                         input.getFullPathName().toRawUTF8());
+            ++failures;
+            continue;
+        }
+        jobs.push_back(std::make_unique<RenderJob>(*format, settings, timeline, input));
+    }
+
+    // Declared after the jobs, so it is gone before they are
+    juce::ThreadPool pool(juce::ThreadPoolOptions{}
+                              .withThreadName("Iso3D render")
+                              .withNumberOfThreads(settings.numJobs));
+    for (auto& job : jobs) pool.addJob(job.get(), false);
+
+    for (auto& job : jobs) {
+        pool.waitForJobToFinish(job.get(), -1);
+        if (job->succeeded()) {
+            std::printf("%s -> %s (%.1fx realtime)\n",
+                        job->getInput().getFullPathName().toRawUTF8(),
+                        job->getOutput().getFullPathName().toRawUTF8(), job->getRealtimeFactor());
+        } else {
+            std::fprintf(stderr, "%s: %s\n", job->getInput().getFullPathName().toRawUTF8(),
+                         job->getError().toRawUTF8());
+            ++failures;
+        }
+        std::fflush(stdout);
+    }
+
+    return failures > 0 ? 1 : 0;
+}
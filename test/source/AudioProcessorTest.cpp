@@ -1,18 +1,44 @@
 #include <gtest/gtest.h>
 
+#include <Iso3D/BandMeter.h>
+#include <Iso3D/BinaryState.h>
 #include <Iso3D/Constants.h>
 #include <Iso3D/Crossover.h>
+#include <Iso3D/DoubleBuffer.h>
+#include <Iso3D/Drive.h>
+#include <Iso3D/FusedCrossover.h>
+#include <Iso3D/GainSmoother.h>
+#include <Iso3D/LinearPhaseCrossover.h>
+#include <Iso3D/LoadProfiler.h>
+#include <Iso3D/MidiCcMap.h>
 #include <Iso3D/PluginProcessor.h>
+#include <Iso3D/Scenes.h>
+#include <Iso3D/SpectrumAnalyzer.h>
+#include <Iso3D/SpscFifo.h>
+#include <Iso3D/WorkerPool.h>
 
+#include "RealtimeSafety.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
 #include <numbers>
+#include <optional>
 #include <random>
+#include <thread>
+#include <vector>
 
 using namespace audio_plugin;
 
 namespace {
 
 constexpr double kSampleRate = 48000.0;
+constexpr int kNumTestChannels = 2;
 constexpr int kWarmupSamples = 10000;
 constexpr int kTestSamples = 10000;
 
@@ -49,8 +75,8 @@ void processInBlocks(AudioPluginAudioProcessor& processor, juce::AudioBuffer<flo
 // ===== Crossover Tests =====
 
 TEST(CrossoverTest, BandsSumFlat) {
-    Crossover xover;
-    xover.prepare(kSampleRate);
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
 
     std::mt19937 rng(42);
     std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
@@ -80,8 +106,8 @@ TEST(CrossoverTest, BandsSumFlat) {
 }
 
 TEST(CrossoverTest, LowFreqInLowBand) {
-    Crossover xover;
-    xover.prepare(kSampleRate);
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
 
     constexpr float kFreq = 50.0f;
 
@@ -107,8 +133,8 @@ TEST(CrossoverTest, LowFreqInLowBand) {
 }
 
 TEST(CrossoverTest, MidFreqInMidBand) {
-    Crossover xover;
-    xover.prepare(kSampleRate);
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
 
     constexpr float kFreq = 1000.0f;
 
@@ -134,8 +160,8 @@ TEST(CrossoverTest, MidFreqInMidBand) {
 }
 
 TEST(CrossoverTest, HighFreqInHighBand) {
-    Crossover xover;
-    xover.prepare(kSampleRate);
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
 
     constexpr float kFreq = 10000.0f;
 
@@ -161,8 +187,8 @@ TEST(CrossoverTest, HighFreqInHighBand) {
 }
 
 TEST(CrossoverTest, CrossoverSlopeIs24dBPerOctave) {
-    Crossover xover;
-    xover.prepare(kSampleRate);
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
 
     // Test low/mid crossover (250Hz): measure low band energy at 500Hz (1 octave above)
     constexpr float kTestFreq = 500.0f;
@@ -188,182 +214,3144 @@ TEST(CrossoverTest, CrossoverSlopeIs24dBPerOctave) {
         << "Low band at 500Hz (1 oct above 250Hz crossover): " << attenuationDb << " dB";
 }
 
-// ===== Gain Tests =====
+namespace {
 
-TEST(GainTest, KillBandRemovesSignal) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
-    processor->prepareToPlay(kSampleRate, 512);
+// Runs processBlock with numChannels independent noise channels and checks every band
+// sample against JUCE's LinkwitzRileyFilter cascade, the low band passed through the
+// midHigh allpass.
+template <typename SampleType>
+void expectBlockMatchesReferenceFilters(int numChannels, SampleType tolerance) {
+    Crossover<SampleType> xover;
+    xover.prepare(kSampleRate, numChannels);
+
+    juce::dsp::ProcessSpec spec{kSampleRate, 0, static_cast<juce::uint32>(numChannels)};
+    juce::dsp::LinkwitzRileyFilter<SampleType> refLowMid;
+    refLowMid.setCutoffFrequency(static_cast<SampleType>(kLowMidCrossoverHz));
+    refLowMid.prepare(spec);
+    juce::dsp::LinkwitzRileyFilter<SampleType> refMidHigh;
+    refMidHigh.setCutoffFrequency(static_cast<SampleType>(kMidHighCrossoverHz));
+    refMidHigh.prepare(spec);
+    juce::dsp::LinkwitzRileyFilter<SampleType> refAllpass;
+    refAllpass.setType(juce::dsp::LinkwitzRileyFilter<SampleType>::Type::allpass);
+    refAllpass.setCutoffFrequency(static_cast<SampleType>(kMidHighCrossoverHz));
+    refAllpass.prepare(spec);
 
-    auto* lowParam = processor->getAPVTS().getParameter(ParamID::kLow);
-    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-100.0f));
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<SampleType> dist(-1, 1);
+
+    // Odd block sizes exercise the pipeline prologue/epilogue, including 1-sample blocks
+    constexpr int kBlockSizes[] = {1, 2, 3, 64, 511};
+    constexpr int kMaxBlock = 511;
+
+    juce::AudioBuffer<SampleType> input(numChannels, kMaxBlock);
+    juce::AudioBuffer<SampleType> bands(kNumBands * numChannels, kMaxBlock);
+    SampleType* const* bandData = bands.getArrayOfWritePointers();
+
+    for (int round = 0; round < 20; ++round) {
+        for (int blockSize : kBlockSizes) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i) input.setSample(ch, i, dist(rng));
+
+            xover.processBlock(input.getArrayOfReadPointers(),
+                               {bandData, bandData + numChannels, bandData + 2 * numChannels},
+                               numChannels, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch) {
+                for (int i = 0; i < blockSize; ++i) {
+                    SampleType refLow = 0;
+                    SampleType refHp = 0;
+                    SampleType refMid = 0;
+                    SampleType refHigh = 0;
+                    refLowMid.processSample(ch, input.getSample(ch, i), refLow, refHp);
+                    refMidHigh.processSample(ch, refHp, refMid, refHigh);
+                    refLow = refAllpass.processSample(ch, refLow);
+
+                    ASSERT_NEAR(bands.getSample(ch, i), refLow, tolerance) << "ch " << ch;
+                    ASSERT_NEAR(bands.getSample(numChannels + ch, i), refMid, tolerance)
+                        << "ch " << ch;
+                    ASSERT_NEAR(bands.getSample(2 * numChannels + ch, i), refHigh, tolerance)
+                        << "ch " << ch;
+                }
+            }
+        }
+    }
+}
 
-    constexpr float kFreq = 50.0f;
-    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+// Low band error of Crossover<SampleType> against a long double LR4 low-pass and midHigh
+// allpass for a full-scale sine at freq, as a level relative to the signal in dB.
+template <typename SampleType>
+double lowBandErrorDb(double sampleRate, double freq) {
+    Crossover<SampleType> xover;
+    xover.prepare(sampleRate, 1);
+
+    using Ref = long double;
+    const Ref g = std::tan(std::numbers::pi_v<Ref> * static_cast<Ref>(kLowMidCrossoverHz)
+                           / static_cast<Ref>(sampleRate));
+    const Ref r2 = std::sqrt(Ref{2});
+    const Ref k = r2 + g;
+    const Ref h = 1 / (1 + r2 * g + g * g);
+    const Ref gAp = std::tan(std::numbers::pi_v<Ref> * static_cast<Ref>(kMidHighCrossoverHz)
+                             / static_cast<Ref>(sampleRate));
+    const Ref kAp = r2 + gAp;
+    const Ref hAp = 1 / (1 + r2 * gAp + gAp * gAp);
+    Ref s1 = 0, s2 = 0, s3 = 0, s4 = 0, a1 = 0, a2 = 0;
+
+    // Several periods of the test tone after the filter has settled
+    const auto warmup = static_cast<int>(sampleRate);
+    const auto measured = static_cast<int>(sampleRate);
+
+    double errorEnergy = 0.0;
+    double signalEnergy = 0.0;
+    for (int i = 0; i < warmup + measured; ++i) {
+        const auto x = static_cast<SampleType>(
+            std::sin(2.0 * std::numbers::pi * freq * static_cast<double>(i) / sampleRate));
+
+        const Ref yH = (static_cast<Ref>(x) - k * s1 - s2) * h;
+        const Ref yB = g * yH + s1;
+        s1 = g * yH + yB;
+        const Ref yL = g * yB + s2;
+        s2 = g * yB + yL;
+        const Ref yH2 = (yL - k * s3 - s4) * h;
+        const Ref yB2 = g * yH2 + s3;
+        s3 = g * yH2 + yB2;
+        const Ref yL2 = g * yB2 + s4;
+        s4 = g * yB2 + yL2;
+        const Ref yHa = (yL2 - kAp * a1 - a2) * hAp;
+        const Ref yBa = gAp * yHa + a1;
+        a1 = gAp * yHa + yBa;
+        const Ref yLa = gAp * yBa + a2;
+        a2 = gAp * yBa + yLa;
+        const Ref expected = yLa - r2 * yBa + yHa;
+
+        const auto low = xover.processSample(0, x)[0];
+        if (i < warmup) continue;
+
+        const auto error = static_cast<double>(static_cast<Ref>(low) - expected);
+        errorEnergy += error * error;
+        signalEnergy += static_cast<double>(expected * expected);
+    }
 
-    juce::AudioBuffer<float> buffer(2, kTotalSamples);
-    for (int i = 0; i < kTotalSamples; ++i) {
-        float s = generateSine(kFreq, i, kSampleRate);
-        buffer.setSample(0, i, s);
-        buffer.setSample(1, i, s);
+    return 10.0 * std::log10(std::max(errorEnergy, 1e-300) / signalEnergy);
+}
+
+}  // namespace
+
+TEST(CrossoverTest, ProcessBlockMatchesReferenceFilters) {
+    expectBlockMatchesReferenceFilters(kNumTestChannels, 1e-5f);
+}
+
+TEST(CrossoverTest, MonoMatchesReferenceFilters) { expectBlockMatchesReferenceFilters(1, 1e-5f); }
+
+TEST(CrossoverTest, MultichannelMatchesReferenceFilters) {
+    // 7.1.4 (a partial SIMD group) and the 64-channel maximum
+    expectBlockMatchesReferenceFilters(12, 1e-5f);
+    expectBlockMatchesReferenceFilters(kMaxChannels, 1e-5f);
+}
+
+TEST(CrossoverTest, DoubleMatchesReferenceFilters) {
+    // Two lanes per register, too few for the three nodes, so every layout is grouped
+    expectBlockMatchesReferenceFilters(1, 1e-12);
+    expectBlockMatchesReferenceFilters(kNumTestChannels, 1e-12);
+    expectBlockMatchesReferenceFilters(12, 1e-12);
+}
+
+TEST(CrossoverTest, LowFrequencyAccuracyAt192k) {
+    // At 192 kHz the 250 Hz split has g ~ 0.004, the worst case for rounding in the
+    // integrators. TPT keeps float around -120 dB; double should sit near its own epsilon.
+    constexpr double kHighSampleRate = 192000.0;
+
+    for (const double freq : {20.0, 50.0, 120.0}) {
+        const double floatErrorDb = lowBandErrorDb<float>(kHighSampleRate, freq);
+        const double doubleErrorDb = lowBandErrorDb<double>(kHighSampleRate, freq);
+        std::cout << "[ accuracy ] 192 kHz, " << freq << " Hz low band error: float "
+                  << floatErrorDb << " dB, double " << doubleErrorDb << " dB\n";
+
+        EXPECT_LT(floatErrorDb, -100.0) << freq << " Hz";
+        EXPECT_LT(doubleErrorDb, -250.0) << freq << " Hz";
     }
+}
 
-    processInBlocks(*processor, buffer, kTotalSamples);
+TEST(CrossoverTest, SummedPathSwitchesSeamlessly) {
+    Crossover<float> reference;
+    reference.prepare(kSampleRate, kNumTestChannels);
+    Crossover<float> switching;
+    switching.prepare(kSampleRate, kNumTestChannels);
 
-    float outputRms = rmsLevel(buffer.getReadPointer(0) + kWarmupSamples, kTestSamples);
-    // Generate reference input for the test region
-    std::vector<float> refInput(static_cast<size_t>(kTestSamples));
-    for (size_t i = 0; i < static_cast<size_t>(kTestSamples); ++i) {
-        refInput[i] = generateSine(kFreq, kWarmupSamples + static_cast<int>(i), kSampleRate);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    constexpr int kMaxBlock = 257;
+    juce::AudioBuffer<float> input(kNumTestChannels, kMaxBlock);
+    juce::AudioBuffer<float> inPlace(kNumTestChannels, kMaxBlock);
+    juce::AudioBuffer<float> bands(kNumBands * kNumTestChannels, kMaxBlock);
+    juce::AudioBuffer<float> split(kNumBands * kNumTestChannels, kMaxBlock);
+    float* const* bandData = bands.getArrayOfWritePointers();
+    float* const* splitData = split.getArrayOfWritePointers();
+
+    // Alternate the summed and split paths on one instance, in place, with uneven blocks
+    for (int block = 0; block < 40; ++block) {
+        const int blockSize = 1 + (block * 37) % kMaxBlock;
+        for (int ch = 0; ch < kNumTestChannels; ++ch) {
+            for (int i = 0; i < blockSize; ++i) {
+                const float s = dist(rng);
+                input.setSample(ch, i, s);
+                inPlace.setSample(ch, i, s);
+            }
+        }
+
+        reference.processBlock(input.getArrayOfReadPointers(),
+                               {bandData, bandData + kNumTestChannels,
+                                bandData + 2 * kNumTestChannels},
+                               kNumTestChannels, blockSize);
+
+        if (block % 2 == 0) {
+            switching.processBlockSummed(inPlace.getArrayOfReadPointers(),
+                                         inPlace.getArrayOfWritePointers(), kNumTestChannels,
+                                         blockSize);
+        } else {
+            switching.processBlock(inPlace.getArrayOfReadPointers(),
+                                   {splitData, splitData + kNumTestChannels,
+                                    splitData + 2 * kNumTestChannels},
+                                   kNumTestChannels, blockSize);
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    inPlace.setSample(ch, i, splitData[ch][i] + splitData[kNumTestChannels + ch][i]
+                                                 + splitData[2 * kNumTestChannels + ch][i]);
+        }
+
+        for (int ch = 0; ch < kNumTestChannels; ++ch) {
+            for (int i = 0; i < blockSize; ++i) {
+                const float expected = bands.getSample(ch, i)
+                    + bands.getSample(kNumTestChannels + ch, i)
+                    + bands.getSample(2 * kNumTestChannels + ch, i);
+                ASSERT_NEAR(inPlace.getSample(ch, i), expected, 1e-6f)
+                    << "block " << block << " ch " << ch << " sample " << i;
+            }
+        }
     }
-    float inputRms = rmsLevel(refInput.data(), kTestSamples);
-    float ratioDb = 20.0f * std::log10(outputRms / inputRms);
+}
 
-    // 50Hz is ~2.3 octaves below 250Hz crossover, so LR4 (24dB/oct) gives ~55dB attenuation
-    EXPECT_LT(ratioDb, -40.0f)
-        << "Killed low band should attenuate 50Hz signal, got " << ratioDb << " dB";
+namespace {
+
+struct AllpassSumError {
+    float sum = 0.0f;   // of the summed output, throughout
+    float band = 0.0f;  // of the bands, once they have settled after the allpass sum
+};
+
+// Runs noise through a crossover that takes the allpass sum for a while, in place, and
+// through one that never does, on uneven blocks, and measures how far they drift apart.
+template <int NumBands>
+AllpassSumError allpassSumError(int numChannels) {
+    using Xover = Crossover<float, NumBands>;
+    Xover full;
+    full.prepare(kSampleRate, numChannels);
+    Xover switching;
+    switching.prepare(kSampleRate, numChannels);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    constexpr int kMaxBlock = 257;
+    const int numBuffers = NumBands * numChannels;
+    juce::AudioBuffer<float> input(numChannels, kMaxBlock);
+    juce::AudioBuffer<float> inPlace(numChannels, kMaxBlock);
+    juce::AudioBuffer<float> expected(numBuffers, kMaxBlock);
+    juce::AudioBuffer<float> actual(numBuffers, kMaxBlock);
+    auto bandsOf = [numChannels](juce::AudioBuffer<float>& buffer) {
+        typename Xover::Bands bands{};
+        for (size_t band = 0; band < bands.size(); ++band)
+            bands[band] =
+                buffer.getArrayOfWritePointers() + static_cast<int>(band) * numChannels;
+        return bands;
+    };
+    auto bandSum = [numChannels](const juce::AudioBuffer<float>& bands, int ch, int i) {
+        float sum = 0.0f;
+        for (int band = 0; band < NumBands; ++band)
+            sum += bands.getSample(band * numChannels + ch, i);
+        return sum;
+    };
+
+    // Blocks 10 to 29 take the allpass sum; 80 blocks after that, some 200 ms, the bands
+    // have long settled
+    AllpassSumError error;
+    for (int block = 0; block < 110; ++block) {
+        const int blockSize = 1 + (block * 55) % kMaxBlock;
+        for (int ch = 0; ch < numChannels; ++ch) {
+            for (int i = 0; i < blockSize; ++i) {
+                const float sample = dist(rng);
+                input.setSample(ch, i, sample);
+                inPlace.setSample(ch, i, sample);
+            }
+        }
+
+        full.processBlock(input.getArrayOfReadPointers(), bandsOf(expected), numChannels,
+                          blockSize);
+
+        const bool allpassSum = block >= 10 && block < 30;
+        switching.setAllpassSum(allpassSum);
+        EXPECT_EQ(switching.isAllpassSum(), allpassSum);
+        if (allpassSum) {
+            switching.processBlockSummed(inPlace.getArrayOfReadPointers(),
+                                         inPlace.getArrayOfWritePointers(), numChannels,
+                                         blockSize);
+        } else {
+            switching.processBlock(inPlace.getArrayOfReadPointers(), bandsOf(actual),
+                                   numChannels, blockSize);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            for (int i = 0; i < blockSize; ++i) {
+                const float sum = allpassSum ? inPlace.getSample(ch, i) : bandSum(actual, ch, i);
+                error.sum = std::max(error.sum, std::abs(sum - bandSum(expected, ch, i)));
+            }
+        }
+        if (block >= 110 - 20) {
+            for (int index = 0; index < numBuffers; ++index)
+                for (int i = 0; i < blockSize; ++i)
+                    error.band = std::max(error.band, std::abs(actual.getSample(index, i)
+                                                               - expected.getSample(index, i)));
+        }
+    }
+    return error;
 }
 
-TEST(GainTest, UnityGainPassthrough) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
-    processor->prepareToPlay(kSampleRate, 512);
+}  // namespace
 
-    std::mt19937 rng(42);
+TEST(CrossoverTest, AllpassSumMatchesFullNetwork) {
+    // Mono runs its 256-sample blocks time-parallel, stereo the pipelined layout, 12 channels
+    // the grouped one, and 2 and 4 bands the shortest and a longer chain of split points
+    auto expectClose = [](const AllpassSumError& error, const char* what) {
+        std::cout << "[ accuracy ] allpass sum, " << what << ": sum " << error.sum
+                  << ", bands after " << error.band << "\n";
+        EXPECT_LT(error.sum, 1e-5f) << what;
+        EXPECT_LT(error.band, 1e-5f) << what;
+    };
+    expectClose(allpassSumError<3>(1), "3 bands, 1 ch");
+    expectClose(allpassSumError<3>(kNumTestChannels), "3 bands, 2 ch");
+    expectClose(allpassSumError<3>(12), "3 bands, 12 ch");
+    expectClose(allpassSumError<2>(kNumTestChannels), "2 bands, 2 ch");
+    expectClose(allpassSumError<4>(6), "4 bands, 6 ch");
+}
+
+namespace {
+
+// Glides one crossover to new split points and checks that, once the glide is over,
+// it behaves exactly like a crossover that started on those split points.
+void expectGlideLandsOnTarget(int numChannels) {
+    const auto target = CrossoverCoefficients<>::make(kSampleRate, {500.0f, 5000.0f});
+
+    Crossover<float> gliding;
+    gliding.prepare(kSampleRate, numChannels);
+    gliding.glideTo(target);
+    Crossover<float> fixed;
+    fixed.prepare(kSampleRate, numChannels);
+    fixed.setCoefficients(target);
+
+    std::mt19937 rng(11);
     std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
 
-    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
-    juce::AudioBuffer<float> buffer(2, kTotalSamples);
-    std::vector<float> originalInput(static_cast<size_t>(kTotalSamples));
+    constexpr int kMaxBlock = 300;
+    juce::AudioBuffer<float> input(numChannels, kMaxBlock);
+    juce::AudioBuffer<float> glidingBands(kNumBands * numChannels, kMaxBlock);
+    juce::AudioBuffer<float> fixedBands(kNumBands * numChannels, kMaxBlock);
+    float* const* g = glidingBands.getArrayOfWritePointers();
+    float* const* f = fixedBands.getArrayOfWritePointers();
+
+    // Blocks straddle the end of the glide; the filters forget the difference in the
+    // meantime, so the final blocks must agree
+    int processed = 0;
+    for (int block = 0; processed < static_cast<int>(kSampleRate); ++block) {
+        const int blockSize = 1 + (block * 53) % kMaxBlock;
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i) input.setSample(ch, i, dist(rng));
+
+        gliding.processBlock(input.getArrayOfReadPointers(),
+                             {g, g + numChannels, g + 2 * numChannels}, numChannels, blockSize);
+        fixed.processBlock(input.getArrayOfReadPointers(),
+                           {f, f + numChannels, f + 2 * numChannels}, numChannels, blockSize);
+        processed += blockSize;
+
+        if (processed < static_cast<int>(kSampleRate) / 2) continue;
+        for (int band = 0; band < kNumBands * numChannels; ++band)
+            for (int i = 0; i < blockSize; ++i)
+                ASSERT_NEAR(glidingBands.getSample(band, i), fixedBands.getSample(band, i),
+                            1e-4f)
+                    << "band/channel " << band << " sample " << i;
+    }
 
-    for (size_t i = 0; i < static_cast<size_t>(kTotalSamples); ++i) {
-        float s = dist(rng);
-        originalInput[i] = s;
-        buffer.setSample(0, static_cast<int>(i), s);
-        buffer.setSample(1, static_cast<int>(i), s);
+    EXPECT_FALSE(gliding.isGliding());
+}
+
+}  // namespace
+
+TEST(CrossoverTest, GlideLandsOnTargetCoefficients) {
+    expectGlideLandsOnTarget(kNumTestChannels);
+    expectGlideLandsOnTarget(12);
+}
+
+TEST(CrossoverTest, DecayTimeCoversTheRingDown) {
+    const auto lowest = CrossoverCoefficients<>::make(
+        kSampleRate, {kLowMidCrossoverMinHz, kMidHighCrossoverMinHz});
+    const auto defaults =
+        CrossoverCoefficients<>::make(kSampleRate, CrossoverCoefficients<>::defaultFrequencies());
+    const double decay =
+        Crossover<double>::decayTimeSeconds(kSampleRate, lowest, kSilenceThreshold);
+
+    // Lower split points ring longer
+    EXPECT_GT(decay, Crossover<double>::decayTimeSeconds(kSampleRate, defaults, kSilenceThreshold));
+    EXPECT_GT(decay, 0.01);
+    EXPECT_LT(decay, 0.5);
+
+    // Let go of full scale: the bands are still audible halfway through, and silent after
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
+    xover.setCoefficients(lowest);
+    for (int i = 0; i < kWarmupSamples; ++i)
+        for (int ch = 0; ch < kNumTestChannels; ++ch) xover.processSample(ch, 1.0f);
+    EXPECT_FALSE(xover.isSilent(kSilenceThreshold));
+
+    const int decaySamples = static_cast<int>(decay * kSampleRate);
+    float halfwayMax = 0.0f;
+    float afterMax = 0.0f;
+    for (int i = 0; i < 2 * decaySamples; ++i) {
+        for (int ch = 0; ch < kNumTestChannels; ++ch) {
+            const auto [low, mid, high] = xover.processSample(ch, 0.0f);
+            const float magnitude = std::max({std::abs(low), std::abs(mid), std::abs(high)});
+            if (i >= decaySamples / 2 && i < decaySamples * 3 / 4)
+                halfwayMax = std::max(halfwayMax, magnitude);
+            if (i >= decaySamples) afterMax = std::max(afterMax, magnitude);
+        }
     }
+    EXPECT_GT(halfwayMax, 100.0f * kSilenceThreshold);
+    EXPECT_LT(afterMax, kSilenceThreshold);
+    EXPECT_TRUE(xover.isSilent(kSilenceThreshold));
+}
 
-    processInBlocks(*processor, buffer, kTotalSamples);
+TEST(CrossoverTest, FrequencySweepIsClickFree) {
+    // Both split points sweep across their full ranges and back while a 1 kHz tone plays.
+    // The band sum is an allpass, so a glitch-free sweep only bends the tone's phase and
+    // the biggest sample-to-sample step stays near that of the tone itself.
+    constexpr float kFreq = 1000.0f;
+    constexpr int kBlockSize = 64;
+    constexpr int kNumBlocks = 1500;
+
+    Crossover<float> xover;
+    xover.prepare(kSampleRate, 1);
+
+    const float toneMaxStep = 2.0f * std::numbers::pi_v<float> * kFreq
+        / static_cast<float>(kSampleRate);
+
+    float previous = 0.0f;
+    float maxStep = 0.0f;
+    int sampleIndex = 0;
+    for (int block = 0; block < kNumBlocks; ++block) {
+        const float position = std::abs(std::sin(std::numbers::pi_v<float>
+                                                 * static_cast<float>(block)
+                                                 / static_cast<float>(kNumBlocks / 2)));
+        xover.glideTo(CrossoverCoefficients<>::make(
+            kSampleRate, {juce::jmap(position, kLowMidCrossoverMinHz, kLowMidCrossoverMaxHz),
+                          juce::jmap(position, kMidHighCrossoverMinHz, kMidHighCrossoverMaxHz)}));
+
+        std::array<float, kBlockSize> samples{};
+        for (auto& sample : samples) sample = generateSine(kFreq, sampleIndex++, kSampleRate);
+        float* channel = samples.data();
+        xover.processBlockSummed(&channel, &channel, 1, kBlockSize);
+
+        for (const float sample : samples) {
+            if (sampleIndex > kWarmupSamples)
+                maxStep = std::max(maxStep, std::abs(sample - previous));
+            previous = sample;
+        }
+    }
 
-    // Compare RMS levels (crossover introduces allpass phase shift, so sample
-    // values differ but magnitude should be preserved)
-    float outputRms = rmsLevel(buffer.getReadPointer(0) + kWarmupSamples, kTestSamples);
-    float inputRms = rmsLevel(originalInput.data() + kWarmupSamples, kTestSamples);
-    float magnitudeErrorDb = 20.0f * std::log10(outputRms / inputRms);
+    EXPECT_LT(maxStep, 1.5f * toneMaxStep);
+}
 
-    EXPECT_NEAR(magnitudeErrorDb, 0.0f, 0.1f)
-        << "Unity gain passthrough should preserve magnitude, got " << magnitudeErrorDb << " dB";
+namespace {
+
+// Feeds sines through the summed path of an N-band crossover split at the given points
+// and returns the largest deviation of the band sum's level from the input's, in dB.
+// Levels are measured over one second, a whole number of periods of every test tone.
+template <int NumBands>
+float bandSumRippleDb(int numChannels,
+                      const typename CrossoverCoefficients<NumBands>::Frequencies& frequencies =
+                          CrossoverCoefficients<NumBands>::defaultFrequencies()) {
+    constexpr int kBlockSize = 256;
+    const auto measured = static_cast<int>(kSampleRate);
+
+    float worstDb = 0.0f;
+    for (const float freq : {30.0f, 180.0f, 600.0f, 700.0f, 900.0f, 1500.0f, 4000.0f, 12000.0f}) {
+        Crossover<float, NumBands> xover;
+        xover.prepare(kSampleRate, numChannels);
+        xover.setCoefficients(CrossoverCoefficients<NumBands>::make(kSampleRate, frequencies));
+
+        juce::AudioBuffer<float> buffer(numChannels, kBlockSize);
+        double inputEnergy = 0.0;
+        double outputEnergy = 0.0;
+        for (int start = 0; start < kWarmupSamples + measured; start += kBlockSize) {
+            const int blockSize = std::min(kBlockSize, kWarmupSamples + measured - start);
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(ch, i, generateSine(freq, start + i, kSampleRate));
+
+            for (int i = std::max(0, kWarmupSamples - start); i < blockSize; ++i)
+                inputEnergy += static_cast<double>(numChannels)
+                    * static_cast<double>(buffer.getSample(0, i) * buffer.getSample(0, i));
+
+            xover.processBlockSummed(buffer.getArrayOfReadPointers(),
+                                     buffer.getArrayOfWritePointers(), numChannels, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = std::max(0, kWarmupSamples - start); i < blockSize; ++i)
+                    outputEnergy +=
+                        static_cast<double>(buffer.getSample(ch, i) * buffer.getSample(ch, i));
+        }
+
+        const auto levelDb = static_cast<float>(10.0 * std::log10(outputEnergy / inputEnergy));
+        if (std::abs(levelDb) > std::abs(worstDb)) worstDb = levelDb;
+    }
+    return worstDb;
 }
 
-TEST(GainTest, SilenceInSilenceOut) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
-    processor->prepareToPlay(kSampleRate, 512);
+// Checks a 4-band crossover against JUCE's LinkwitzRileyFilter cascade, with the two
+// lower bands passed through the allpasses of the splits above them.
+void expectFourBandsMatchReferenceFilters(int numChannels) {
+    constexpr int kBands = 4;
+    Crossover<float, kBands> xover;
+    xover.prepare(kSampleRate, numChannels);
+    const auto frequencies = CrossoverCoefficients<kBands>::defaultFrequencies();
+
+    juce::dsp::ProcessSpec spec{kSampleRate, 0, static_cast<juce::uint32>(numChannels)};
+    std::array<juce::dsp::LinkwitzRileyFilter<float>, kBands - 1> splits;
+    std::array<juce::dsp::LinkwitzRileyFilter<float>, 3> allpasses;
+    for (size_t s = 0; s < splits.size(); ++s) {
+        splits[s].setCutoffFrequency(frequencies[s]);
+        splits[s].prepare(spec);
+    }
+    // Band 0 through split 1 then split 2, band 1 through split 2
+    const std::array<size_t, 3> allpassSplits = {1, 2, 2};
+    for (size_t a = 0; a < allpasses.size(); ++a) {
+        allpasses[a].setType(juce::dsp::LinkwitzRileyFilter<float>::Type::allpass);
+        allpasses[a].setCutoffFrequency(frequencies[allpassSplits[a]]);
+        allpasses[a].prepare(spec);
+    }
 
-    juce::AudioBuffer<float> buffer(2, 512);
-    buffer.clear();
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
 
-    juce::MidiBuffer midi;
-    processor->processBlock(buffer, midi);
+    constexpr int kBlockSizes[] = {1, 2, 3, 64, 511};
+    constexpr int kMaxBlock = 511;
+    juce::AudioBuffer<float> input(numChannels, kMaxBlock);
+    juce::AudioBuffer<float> bands(kBands * numChannels, kMaxBlock);
+    Crossover<float, kBands>::Bands bandData{};
+    for (int band = 0; band < kBands; ++band)
+        bandData[static_cast<size_t>(band)] = bands.getArrayOfWritePointers() + band * numChannels;
+
+    for (int round = 0; round < 10; ++round) {
+        for (int blockSize : kBlockSizes) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i) input.setSample(ch, i, dist(rng));
+
+            xover.processBlock(input.getArrayOfReadPointers(), bandData, numChannels, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch) {
+                for (int i = 0; i < blockSize; ++i) {
+                    std::array<float, kBands> ref{};
+                    float hp0 = 0.0f;
+                    float hp1 = 0.0f;
+                    splits[0].processSample(ch, input.getSample(ch, i), ref[0], hp0);
+                    splits[1].processSample(ch, hp0, ref[1], hp1);
+                    splits[2].processSample(ch, hp1, ref[2], ref[3]);
+                    ref[0] = allpasses[1].processSample(ch, allpasses[0].processSample(ch, ref[0]));
+                    ref[1] = allpasses[2].processSample(ch, ref[1]);
+
+                    for (int band = 0; band < kBands; ++band)
+                        ASSERT_NEAR(bands.getSample(band * numChannels + ch, i),
+                                    ref[static_cast<size_t>(band)], 1e-5f)
+                            << "band " << band << " ch " << ch;
+                }
+            }
+        }
+    }
+}
 
-    for (int ch = 0; ch < 2; ++ch) {
-        for (int i = 0; i < 512; ++i) {
-            EXPECT_LT(std::abs(buffer.getSample(ch, i)), 1e-7f)
-                << "Non-silence at ch=" << ch << " sample=" << i;
+}  // namespace
+
+TEST(CrossoverTest, NBandSumIsFlat) {
+    // 2 bands are a single allpass; from 3 bands up the lower bands are phase aligned
+    // with allpasses, so the sum stays flat however many splits there are. Mono and
+    // stereo take the pipelined layout where it exists, 12 channels the grouped one.
+    for (const int numChannels : {1, kNumTestChannels, 12}) {
+        EXPECT_NEAR(bandSumRippleDb<2>(numChannels), 0.0f, 0.01f) << numChannels << " ch";
+        EXPECT_NEAR(bandSumRippleDb<3>(numChannels), 0.0f, 0.01f) << numChannels << " ch";
+        EXPECT_NEAR(bandSumRippleDb<4>(numChannels), 0.0f, 0.01f) << numChannels << " ch";
+        EXPECT_NEAR(bandSumRippleDb<5>(numChannels), 0.0f, 0.01f) << numChannels << " ch";
+        EXPECT_NEAR(bandSumRippleDb<6>(numChannels), 0.0f, 0.01f) << numChannels << " ch";
+    }
+}
+
+TEST(CrossoverTest, BandsSumFlatAtCloseSplitPoints) {
+    // Both within the split point ranges. Uncompensated, the sum would notch by 3.6 dB
+    // near 700 Hz for the first pair and by 12 dB near 900 Hz for the second.
+    for (const int numChannels : {1, kNumTestChannels}) {
+        EXPECT_NEAR(bandSumRippleDb<3>(numChannels, {500.0f, 1000.0f}), 0.0f, 0.01f)
+            << numChannels << " ch";
+        EXPECT_NEAR(bandSumRippleDb<3>(numChannels, {kLowMidCrossoverMaxHz,
+                                                     kMidHighCrossoverMinHz}),
+                    0.0f, 0.01f)
+            << numChannels << " ch";
+    }
+}
+
+TEST(CrossoverTest, FourBandsMatchReferenceFilters) {
+    expectFourBandsMatchReferenceFilters(1);
+    expectFourBandsMatchReferenceFilters(kNumTestChannels);
+    expectFourBandsMatchReferenceFilters(12);
+}
+
+namespace {
+
+// Largest band difference between a time-parallel and a channel-parallel crossover fed
+// the same noise, over uneven blocks (below and above the lane count and the chunk
+// size) and a glide that forces both back onto the channel-parallel kernels.
+template <typename SampleType, int NumBands>
+double timeParallelError(int numChannels) {
+    using Xover = Crossover<SampleType, NumBands>;
+    Xover channelParallel;
+    channelParallel.prepare(kSampleRate, numChannels);
+    channelParallel.setExecution(Xover::Execution::channelParallel);
+    Xover timeParallel;
+    timeParallel.prepare(kSampleRate, numChannels);
+    timeParallel.setExecution(Xover::Execution::timeParallel);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<SampleType> dist(-1, 1);
+
+    constexpr int kMaxBlock = 1031;
+    const int numBuffers = NumBands * numChannels;
+    juce::AudioBuffer<SampleType> input(numChannels, kMaxBlock);
+    juce::AudioBuffer<SampleType> expected(numBuffers, kMaxBlock);
+    juce::AudioBuffer<SampleType> actual(numBuffers, kMaxBlock);
+    auto bandsOf = [numChannels](juce::AudioBuffer<SampleType>& buffer) {
+        typename Xover::Bands bands{};
+        for (size_t band = 0; band < bands.size(); ++band)
+            bands[band] =
+                buffer.getArrayOfWritePointers() + static_cast<int>(band) * numChannels;
+        return bands;
+    };
+
+    auto frequencies = Xover::Coefficients::defaultFrequencies();
+    for (auto& frequency : frequencies) frequency *= 1.5f;
+    const auto glideTarget = Xover::Coefficients::make(kSampleRate, frequencies);
+
+    double maxError = 0.0;
+    for (const int blockSize : {kMaxBlock, 3, 130, 64, 517, 1, kMaxBlock, 1000, 255, 900}) {
+        if (blockSize == 1) {
+            channelParallel.glideTo(glideTarget);
+            timeParallel.glideTo(glideTarget);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i) input.setSample(ch, i, dist(rng));
+
+        channelParallel.processBlock(input.getArrayOfReadPointers(), bandsOf(expected),
+                                     numChannels, blockSize);
+        timeParallel.processBlock(input.getArrayOfReadPointers(), bandsOf(actual),
+                                  numChannels, blockSize);
+
+        for (int index = 0; index < numBuffers; ++index) {
+            for (int i = 0; i < blockSize; ++i) {
+                const auto error = static_cast<double>(actual.getSample(index, i))
+                    - static_cast<double>(expected.getSample(index, i));
+                maxError = std::max(maxError, std::abs(error));
+            }
         }
     }
+    return maxError;
 }
 
-TEST(GainTest, GainSmoothingNoClicks) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
-    processor->prepareToPlay(kSampleRate, 512);
+}  // namespace
 
-    constexpr float kFreq = 1000.0f;
+TEST(CrossoverTest, TimeParallelMatchesChannelParallel) {
+    // Mono and stereo cover the pipelined layout with its allpass bank (only mono in
+    // double), 6 channels the grouped one, and 4 bands a longer allpass chain
+    for (const int numChannels : {1, kNumTestChannels, 6}) {
+        const double floatError = timeParallelError<float, 3>(numChannels);
+        const double floatError4 = timeParallelError<float, 4>(numChannels);
+        const double doubleError = timeParallelError<double, 3>(numChannels);
+        const double doubleError4 = timeParallelError<double, 4>(numChannels);
+        std::cout << "[ accuracy ] time-parallel, " << numChannels << " ch: float "
+                  << floatError << " (" << floatError4 << " with 4 bands), double "
+                  << doubleError << " (" << doubleError4 << " with 4 bands)\n";
+
+        EXPECT_LT(floatError, 1e-5) << numChannels << " ch";
+        EXPECT_LT(floatError4, 1e-5) << numChannels << " ch";
+        EXPECT_LT(doubleError, 1e-13) << numChannels << " ch";
+        EXPECT_LT(doubleError4, 1e-13) << numChannels << " ch";
+    }
+}
 
-    // Process warmup at unity gain
-    juce::AudioBuffer<float> warmup(2, kWarmupSamples);
-    for (int i = 0; i < kWarmupSamples; ++i) {
-        float s = generateSine(kFreq, i, kSampleRate);
-        warmup.setSample(0, i, s);
-        warmup.setSample(1, i, s);
+TEST(CrossoverTest, AutomaticExecutionGoesAlongTimeUpToHalfARegister) {
+    auto timeParallelGroups = [](auto xover, int numChannels, int numSamples) {
+        xover.prepare(kSampleRate, numChannels);
+        std::vector<bool> groups;
+        for (int group = 0; group < xover.getNumGroups(numChannels); ++group)
+            groups.push_back(xover.isTimeParallel(group, numChannels, numSamples));
+        return groups;
+    };
+    using Groups = std::vector<bool>;
+
+    // Float: mono and stereo, then 5.1's second group of two; short blocks never
+    EXPECT_EQ(timeParallelGroups(Crossover<float>{}, 1, 256), Groups{true});
+    EXPECT_EQ(timeParallelGroups(Crossover<float>{}, 2, 256), Groups{true});
+    EXPECT_EQ(timeParallelGroups(Crossover<float>{}, 3, 256), Groups{false});
+    EXPECT_EQ(timeParallelGroups(Crossover<float>{}, 6, 1024), (Groups{false, true}));
+    EXPECT_EQ(timeParallelGroups(Crossover<float>{}, 2, kMinTimeParallelSamples - 1),
+              Groups{false});
+    EXPECT_EQ(timeParallelGroups(Crossover<float, 4>{}, 2, 256), Groups{true});
+
+    // Double: mono only
+    EXPECT_EQ(timeParallelGroups(Crossover<double>{}, 1, 256), Groups{true});
+    EXPECT_EQ(timeParallelGroups(Crossover<double>{}, 2, 256), Groups{false});
+}
+
+TEST(CrossoverTest, CoefficientTableTracksTan) {
+    for (const double sampleRate : {44100.0, kSampleRate, 192000.0}) {
+        const auto table = CrossoverCoefficientTable::make(sampleRate);
+
+        // Over the grid's range, or up to the highest split point the table allows, with
+        // tan() curving up more steeply above fs / 4
+        const double topHz = std::min(
+            CrossoverCoefficientTable::kMinHz * std::exp2(CrossoverCoefficientTable::kNumOctaves),
+            0.49 * sampleRate);
+        double maxError = 0.0;
+        double maxErrorAboveQuarter = 0.0;
+        for (float hz = 20.0f; static_cast<double>(hz) < topHz; hz *= 1.0013f) {
+            const double exact = std::tan(std::numbers::pi * static_cast<double>(hz) / sampleRate);
+            const double error =
+                std::abs(table.gAt(CrossoverCoefficientTable::positionOf(hz)) / exact - 1.0);
+            auto& bound = static_cast<double>(hz) < sampleRate / 4.0 ? maxError
+                                                                     : maxErrorAboveQuarter;
+            bound = std::max(bound, error);
+        }
+        std::cout << "[ accuracy ] coefficient table at " << sampleRate << " Hz: " << maxError
+                  << " (" << maxErrorAboveQuarter << " above fs / 4)\n";
+        EXPECT_LT(maxError, 1e-4) << sampleRate << " Hz";
+        EXPECT_LT(maxErrorAboveQuarter, 1e-2) << sampleRate << " Hz";
     }
-    processInBlocks(*processor, warmup, kWarmupSamples);
+}
 
-    // Kill mid band and process more audio
-    auto* midParam = processor->getAPVTS().getParameter(ParamID::kMid);
-    midParam->setValueNotifyingHost(midParam->convertTo0to1(-100.0f));
+namespace {
 
-    constexpr int kPostChangeSamples = 4096;
-    juce::AudioBuffer<float> postChange(2, kPostChangeSamples);
-    for (int i = 0; i < kPostChangeSamples; ++i) {
-        float s = generateSine(kFreq, kWarmupSamples + i, kSampleRate);
-        postChange.setSample(0, i, s);
-        postChange.setSample(1, i, s);
+// Sweeps a crossover's split points with modulate() and compares it with one stepped
+// through the same coefficients a sample at a time, returning the largest difference.
+template <int NumBands>
+float modulationError(int numChannels) {
+    using Xover = Crossover<float, NumBands>;
+    constexpr size_t kNumSplits = Xover::Coefficients::kNumSplits;
+    const auto table = CrossoverCoefficientTable::make(kSampleRate);
+    const auto centres = Xover::Coefficients::defaultFrequencies();
+
+    Xover modulated;
+    modulated.prepare(kSampleRate, numChannels);
+    Xover reference;
+    reference.prepare(kSampleRate, numChannels);
+
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    constexpr int kMaxBlock = 700;
+    const int numBuffers = NumBands * numChannels;
+    juce::AudioBuffer<float> input(numChannels, kMaxBlock);
+    juce::AudioBuffer<float> bands(numBuffers, kMaxBlock);
+    typename Xover::Bands bandPointers{};
+    for (size_t band = 0; band < bandPointers.size(); ++band)
+        bandPointers[band] = bands.getArrayOfWritePointers() + static_cast<int>(band) * numChannels;
+    std::array<std::vector<float>, kNumSplits> positions;
+    for (auto& split : positions) split.resize(kMaxBlock);
+
+    // Two octaves either way at 3 Hz. Modulating drops a glide in progress.
+    auto glideFrequencies = centres;
+    for (auto& frequency : glideFrequencies) frequency *= 2.0f;
+    const auto glideTarget = Xover::Coefficients::make(kSampleRate, glideFrequencies);
+
+    int sampleIndex = 0;
+    float maxError = 0.0f;
+    for (const int blockSize : {kMaxBlock, 1, 64, 333, 2, kMaxBlock, 129}) {
+        if (blockSize == 333) modulated.glideTo(glideTarget);
+
+        typename Xover::Positions blockPositions{};
+        for (size_t split = 0; split < kNumSplits; ++split) {
+            const float centre = CrossoverCoefficientTable::positionOf(centres[split]);
+            for (int i = 0; i < blockSize; ++i) {
+                const float phase = 2.0f * std::numbers::pi_v<float> * 3.0f
+                    * static_cast<float>(sampleIndex + i) / static_cast<float>(kSampleRate);
+                positions[split][static_cast<size_t>(i)] =
+                    centre + 128.0f * std::sin(phase + static_cast<float>(split));
+            }
+            blockPositions[split] = positions[split].data();
+        }
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i) input.setSample(ch, i, dist(rng));
+
+        modulated.modulate(table, blockPositions);
+        modulated.processBlock(input.getArrayOfReadPointers(), bandPointers, numChannels,
+                               blockSize);
+
+        for (int i = 0; i < blockSize; ++i) {
+            typename Xover::Coefficients coefficients;
+            for (size_t split = 0; split < kNumSplits; ++split) {
+                const double g = static_cast<double>(
+                    static_cast<float>(table.gAt(positions[split][static_cast<size_t>(i)])));
+                const double k = std::sqrt(2.0) + g;
+                coefficients.splits[split] = {g, k, 1.0 / (1.0 + g * k)};
+            }
+            reference.setCoefficients(coefficients);
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const auto expected = reference.processSample(ch, input.getSample(ch, i));
+                for (size_t band = 0; band < expected.size(); ++band) {
+                    const int index = static_cast<int>(band) * numChannels + ch;
+                    maxError = std::max(maxError,
+                                        std::abs(bands.getSample(index, i) - expected[band]));
+                }
+            }
+        }
+        sampleIndex += blockSize;
     }
-    processInBlocks(*processor, postChange, kPostChangeSamples);
 
-    // Verify no sample exceeds the pre-change level
-    for (int i = 0; i < kPostChangeSamples; ++i) {
-        EXPECT_LE(std::abs(postChange.getSample(0, i)), 1.01f)
-            << "Click/overshoot at sample " << i << ": " << postChange.getSample(0, i);
+    EXPECT_FALSE(modulated.isModulated());
+    EXPECT_FALSE(modulated.isGliding());
+    return maxError;
+}
+
+}  // namespace
+
+TEST(CrossoverTest, ModulationMatchesPerSampleCoefficients) {
+    // Mono and stereo cover the pipelined layout, lagged and allpass lanes included, 6
+    // channels the grouped one, and 4 bands a longer allpass chain
+    for (const int numChannels : {1, kNumTestChannels, 6}) {
+        EXPECT_LT(modulationError<3>(numChannels), 1e-5f) << numChannels << " ch";
+        EXPECT_LT(modulationError<4>(numChannels), 1e-5f) << numChannels << " ch";
     }
 }
 
-TEST(GainTest, BoostClamping) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
-    processor->prepareToPlay(kSampleRate, 512);
+// ===== Fused Crossover Tests =====
 
-    // Set band to +12dB, boost to 0dB -> effective should be 0dB
-    auto& apvts = processor->getAPVTS();
-    auto* lowParam = apvts.getParameter(ParamID::kLow);
-    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(12.0f));
-    // boost stays at index 0 = "0 dB"
+namespace {
 
-    constexpr float kFreq = 50.0f;
-    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+// Largest difference between FusedCrossover and Crossover's bands weighted by the same
+// gains, over noise with steady gains, ramping gains and a jump in split points.
+template <typename SampleType>
+double fusedCrossoverError(double sampleRate, int numChannels,
+                           const CrossoverCoefficients<kNumBands>::Frequencies& jumpTo) {
+    using Coefficients = CrossoverCoefficients<kNumBands>;
+    Crossover<SampleType> reference;
+    reference.prepare(sampleRate, numChannels);
+    FusedCrossover<SampleType> fused;
+    fused.prepare(sampleRate, numChannels);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<SampleType> dist(-1, 1);
+
+    constexpr int kBlockSize = 256;
+    constexpr int kNumBlocks = 48;
+    juce::AudioBuffer<SampleType> input(numChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> output(numChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> bands(kNumBands * numChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> ramps(kNumBands * numChannels, kBlockSize);
+    SampleType* const* bandData = bands.getArrayOfWritePointers();
+    const auto channels = static_cast<size_t>(numChannels);
+    std::vector<typename FusedCrossover<SampleType>::ChannelGains> gains(channels);
+
+    double maxError = 0.0;
+    for (int block = 0; block < kNumBlocks; ++block) {
+        if (block == kNumBlocks / 2) {
+            const auto coefficients = Coefficients::make(sampleRate, jumpTo);
+            reference.setCoefficients(coefficients);
+            fused.setCoefficients(coefficients);
+        }
 
-    juce::AudioBuffer<float> buffer(2, kTotalSamples);
-    std::vector<float> originalInput(static_cast<size_t>(kTotalSamples));
-    for (size_t i = 0; i < static_cast<size_t>(kTotalSamples); ++i) {
-        float s = generateSine(kFreq, static_cast<int>(i), kSampleRate);
-        originalInput[i] = s;
-        buffer.setSample(0, static_cast<int>(i), s);
-        buffer.setSample(1, static_cast<int>(i), s);
+        // Steady gains that change every 8 blocks, ramps every 8 blocks after that
+        const bool ramping = block % 16 >= 8 && block % 16 < 12;
+        for (size_t ch = 0; ch < channels; ++ch) {
+            for (size_t band = 0; band < kNumBands; ++band) {
+                const auto index = static_cast<int>(band * channels + ch);
+                const auto step = static_cast<double>((block / 8 + index) % 4);
+                const auto gain = static_cast<SampleType>(0.25 + 0.5 * step);
+                gains[ch].current[band] = gain;
+                gains[ch].ramps[band] = nullptr;
+                if (!ramping) continue;
+
+                for (int i = 0; i < kBlockSize; ++i)
+                    ramps.setSample(index, i, gain * static_cast<SampleType>(1 + i) / kBlockSize);
+                gains[ch].ramps[band] = ramps.getReadPointer(index);
+            }
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < kBlockSize; ++i) input.setSample(ch, i, dist(rng));
+
+        reference.processBlock(input.getArrayOfReadPointers(),
+                               {bandData, bandData + numChannels, bandData + 2 * numChannels},
+                               numChannels, kBlockSize);
+        fused.processBlock(input.getArrayOfReadPointers(), output.getArrayOfWritePointers(),
+                           gains.data(), numChannels, kBlockSize);
+
+        for (size_t ch = 0; ch < channels; ++ch) {
+            for (int i = 0; i < kBlockSize; ++i) {
+                double expected = 0.0;
+                for (size_t band = 0; band < kNumBands; ++band) {
+                    const auto index = static_cast<int>(band * channels + ch);
+                    const auto gain = gains[ch].ramps[band] != nullptr
+                        ? gains[ch].ramps[band][i] : gains[ch].current[band];
+                    expected += static_cast<double>(gain * bands.getSample(index, i));
+                }
+                const auto actual =
+                    static_cast<double>(output.getSample(static_cast<int>(ch), i));
+                maxError = std::max(maxError, std::abs(actual - expected));
+            }
+        }
     }
+    return maxError;
+}
 
-    processInBlocks(*processor, buffer, kTotalSamples);
+}  // namespace
 
-    // Measure output vs input energy ratio (should be near unity = 0 dB)
-    float outputRms = rmsLevel(buffer.getReadPointer(0) + kWarmupSamples, kTestSamples);
-    float inputRms = rmsLevel(originalInput.data() + kWarmupSamples, kTestSamples);
-    float ratioDb = 20.0f * std::log10(outputRms / inputRms);
+TEST(FusedCrossoverTest, MatchesCrossoverAndGainSum) {
+    // Mono takes the folded layout in float, stereo and 6 channels the grouped one; at
+    // 192 kHz an 80 Hz split is the worst case for the rotations' rounding
+    for (const int numChannels : {1, kNumTestChannels, 6}) {
+        const double floatError = fusedCrossoverError<float>(kSampleRate, numChannels,
+                                                             {400.0f, 2500.0f});
+        const double floatError192 = fusedCrossoverError<float>(192000.0, numChannels,
+                                                                {80.0f, 1000.0f});
+        const double doubleError = fusedCrossoverError<double>(kSampleRate, numChannels,
+                                                               {400.0f, 2500.0f});
+        const double doubleError192 = fusedCrossoverError<double>(192000.0, numChannels,
+                                                                  {80.0f, 1000.0f});
+        std::cout << "[ accuracy ] fused, " << numChannels << " ch: float " << floatError
+                  << " (" << floatError192 << " at 192 kHz), double " << doubleError << " ("
+                  << doubleError192 << " at 192 kHz)\n";
+
+        EXPECT_LT(floatError, 1e-5) << numChannels << " ch";
+        EXPECT_LT(floatError192, 1e-5) << numChannels << " ch";
+        EXPECT_LT(doubleError, 1e-11) << numChannels << " ch";
+        EXPECT_LT(doubleError192, 1e-11) << numChannels << " ch";
+    }
+}
 
-    EXPECT_NEAR(ratioDb, 0.0f, 0.5f)
-        << "With +12dB gain but 0dB boost limit, effective should be ~0dB, got " << ratioDb;
+namespace {
+
+// Largest difference between a Crossover that hands its state to a FusedCrossover and
+// takes it back every few blocks, weighting its bands by the gains while it runs, and a
+// Crossover running throughout
+template <typename SampleType>
+double fusedHandoffError(int numChannels) {
+    using Coefficients = CrossoverCoefficients<kNumBands>;
+    const auto coefficients = Coefficients::make(kSampleRate, {300.0f, 3000.0f});
+    Crossover<SampleType> reference;
+    Crossover<SampleType> crossover;
+    FusedCrossover<SampleType> fused;
+    for (auto* xover : {&reference, &crossover}) {
+        xover->prepare(kSampleRate, numChannels);
+        xover->setCoefficients(coefficients);
+    }
+    fused.prepare(kSampleRate, numChannels);
+    fused.setCoefficients(coefficients);
+
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<SampleType> dist(-1, 1);
+
+    constexpr int kBlockSize = 64;
+    constexpr int kNumBlocks = 40;
+    const auto channels = static_cast<size_t>(numChannels);
+    juce::AudioBuffer<SampleType> input(numChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> output(numChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> bands(kNumBands * numChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> referenceBands(kNumBands * numChannels, kBlockSize);
+    SampleType* const* bandData = bands.getArrayOfWritePointers();
+    SampleType* const* referenceData = referenceBands.getArrayOfWritePointers();
+
+    std::vector<typename FusedCrossover<SampleType>::ChannelGains> gains(channels);
+    for (auto& channelGains : gains)
+        channelGains.current = {SampleType(0.5), SampleType(1.5), SampleType(0.25)};
+    auto weighted = [&](const juce::AudioBuffer<SampleType>& from, size_t ch, int i) {
+        double sum = 0.0;
+        for (size_t band = 0; band < kNumBands; ++band)
+            sum += static_cast<double>(gains[ch].current[band]
+                                       * from.getSample(static_cast<int>(band * channels + ch), i));
+        return sum;
+    };
+
+    double maxError = 0.0;
+    bool fusedActive = false;
+    for (int block = 0; block < kNumBlocks; ++block) {
+        // Runs of 1 to 3 blocks on each engine
+        if (block % 3 == 0 || block % 7 == 0) {
+            if (fusedActive)
+                fused.handState(crossover);
+            else
+                fused.takeState(crossover);
+            fusedActive = !fusedActive;
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < kBlockSize; ++i) input.setSample(ch, i, dist(rng));
+
+        reference.processBlock(
+            input.getArrayOfReadPointers(),
+            {referenceData, referenceData + numChannels, referenceData + 2 * numChannels},
+            numChannels, kBlockSize);
+        if (fusedActive)
+            fused.processBlock(input.getArrayOfReadPointers(), output.getArrayOfWritePointers(),
+                               gains.data(), numChannels, kBlockSize);
+        else
+            crossover.processBlock(input.getArrayOfReadPointers(),
+                                   {bandData, bandData + numChannels, bandData + 2 * numChannels},
+                                   numChannels, kBlockSize);
+
+        for (size_t ch = 0; ch < channels; ++ch) {
+            for (int i = 0; i < kBlockSize; ++i) {
+                const double actual =
+                    fusedActive ? static_cast<double>(output.getSample(static_cast<int>(ch), i))
+                                : weighted(bands, ch, i);
+                maxError = std::max(maxError, std::abs(actual - weighted(referenceBands, ch, i)));
+            }
+        }
+    }
+    return maxError;
 }
 
-// ===== Plugin Tests =====
+}  // namespace
 
-TEST(PluginTest, PluginInstantiation) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
-    EXPECT_EQ(processor->getName(), "Iso3D");
+TEST(FusedCrossoverTest, HandsStateToAndFromCrossover) {
+    // Mono folds in float; 6 channels take two groups of each engine
+    for (const int numChannels : {1, kNumTestChannels, 6}) {
+        EXPECT_LT(fusedHandoffError<float>(numChannels), 1e-5) << numChannels << " ch";
+        EXPECT_LT(fusedHandoffError<double>(numChannels), 1e-11) << numChannels << " ch";
+    }
 }
 
-TEST(PluginTest, BusLayout) {
-    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+// ===== Linear-Phase Crossover Tests =====
 
-    // Stereo in/out should be accepted
-    juce::AudioProcessor::BusesLayout stereoLayout;
-    stereoLayout.inputBuses.add(juce::AudioChannelSet::stereo());
-    stereoLayout.outputBuses.add(juce::AudioChannelSet::stereo());
-    EXPECT_TRUE(processor->isBusesLayoutSupported(stereoLayout));
+namespace {
 
-    // Mono should be rejected
-    juce::AudioProcessor::BusesLayout monoLayout;
-    monoLayout.inputBuses.add(juce::AudioChannelSet::mono());
-    monoLayout.outputBuses.add(juce::AudioChannelSet::mono());
-    EXPECT_FALSE(processor->isBusesLayoutSupported(monoLayout));
+// Runs noise through a linear-phase crossover in odd block sizes, alternating between
+// the band and the summed path and changing the kernel midway, and checks that the
+// output is always exactly the input delayed by the reported latency.
+template <typename SampleType, int NumBands>
+void expectLinearPhaseSumIsDelay(int numChannels) {
+    using Crossover = LinearPhaseCrossover<SampleType, NumBands>;
+    Crossover xover;
+    xover.prepare(kSampleRate, numChannels);
+    const int latency = xover.getLatencySamples();
 
-    // Mono in, stereo out should be rejected
-    juce::AudioProcessor::BusesLayout mixedLayout;
-    mixedLayout.inputBuses.add(juce::AudioChannelSet::mono());
-    mixedLayout.outputBuses.add(juce::AudioChannelSet::stereo());
-    EXPECT_FALSE(processor->isBusesLayoutSupported(mixedLayout));
+    constexpr int kTotal = 24000;
+    const auto channels = static_cast<size_t>(numChannels);
+    std::vector<std::vector<SampleType>> inputs(channels, std::vector<SampleType>(kTotal));
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (auto& input : inputs)
+        for (auto& s : input) s = static_cast<SampleType>(dist(rng));
+
+    constexpr int kMaxBlock = 700;
+    std::vector<std::vector<SampleType>> bandData(static_cast<size_t>(NumBands) * channels,
+                                                  std::vector<SampleType>(kMaxBlock));
+    std::vector<SampleType*> bandPointers;
+    for (auto& band : bandData) bandPointers.push_back(band.data());
+    typename Crossover::Bands bands{};
+    for (size_t b = 0; b < bands.size(); ++b) bands[b] = bandPointers.data() + b * channels;
+
+    std::vector<std::vector<SampleType>> outputs(channels, std::vector<SampleType>(kTotal));
+    std::vector<const SampleType*> in(channels);
+    std::vector<SampleType*> out(channels);
+
+    // Split points an octave up; the change is crossfaded while the stream runs
+    auto frequencies = CrossoverCoefficients<NumBands>::defaultFrequencies();
+    for (auto& frequency : frequencies) frequency *= 2.0f;
+    const auto kernel = Crossover::Kernel::make(kSampleRate, frequencies);
+    constexpr int kKernelChangeBlock = 40;
+
+    int block = 0;
+    for (int pos = 0, blockSize = 1; pos < kTotal; pos += blockSize, ++block) {
+        blockSize = std::min(1 + (block * 173) % kMaxBlock, kTotal - pos);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            in[ch] = inputs[ch].data() + pos;
+            out[ch] = outputs[ch].data() + pos;
+        }
+
+        if (block == kKernelChangeBlock)
+            xover.updateKernel([&kernel](typename Crossover::Kernel& slot) {
+                slot = kernel;
+                return true;
+            });
+        if (block % 3 == 2) {
+            xover.processBlockSummed(in.data(), out.data(), numChannels, blockSize);
+            continue;
+        }
+
+        xover.processBlock(in.data(), bands, numChannels, blockSize);
+        for (size_t ch = 0; ch < channels; ++ch)
+            for (int i = 0; i < blockSize; ++i) {
+                SampleType sum{};
+                for (size_t b = 0; b < bands.size(); ++b) sum += bands[b][ch][i];
+                out[ch][i] = sum;
+            }
+    }
+
+    for (size_t ch = 0; ch < channels; ++ch)
+        for (int i = latency; i < kTotal; ++i)
+            ASSERT_NEAR(static_cast<double>(outputs[ch][static_cast<size_t>(i)]),
+                        static_cast<double>(inputs[ch][static_cast<size_t>(i - latency)]), 1e-5)
+                << NumBands << " bands, " << numChannels << " ch, sample " << i;
+}
+
+// Feeds input through a 3-band float linear-phase crossover on one channel and
+// returns the band outputs.
+std::array<std::vector<float>, 3> linearPhaseBands(const std::vector<float>& input) {
+    LinearPhaseCrossover<float> xover;
+    xover.prepare(kSampleRate, 1);
+
+    std::array<std::vector<float>, 3> bands;
+    for (auto& band : bands) band.resize(input.size());
+
+    constexpr int kBlockSize = 512;
+    for (size_t pos = 0; pos < input.size(); pos += kBlockSize) {
+        const size_t blockSize = std::min(size_t{kBlockSize}, input.size() - pos);
+        const float* in[] = {input.data() + pos};
+        float* low[] = {bands[0].data() + pos};
+        float* mid[] = {bands[1].data() + pos};
+        float* high[] = {bands[2].data() + pos};
+        xover.processBlock(in, {low, mid, high}, 1, static_cast<int>(blockSize));
+    }
+    return bands;
+}
+
+}  // namespace
+
+TEST(LinearPhaseCrossoverTest, BandsAreSymmetricAboutLatency) {
+    LinearPhaseCrossover<float> xover;
+    xover.prepare(kSampleRate, 1);
+    const auto latency = static_cast<size_t>(xover.getLatencySamples());
+    EXPECT_EQ(latency, 2303u) << "256-sample partitions at 48 kHz";
+
+    std::vector<float> impulse(2 * latency + 1);
+    impulse[0] = 1.0f;
+    const auto bands = linearPhaseBands(impulse);
+
+    // Linear phase: every band's impulse response is even about the latency
+    for (size_t b = 0; b < bands.size(); ++b)
+        for (size_t k = 0; k <= latency; ++k)
+            ASSERT_NEAR(bands[b][latency + k], bands[b][latency - k], 1e-6f)
+                << "band " << b << " tap " << k;
+}
+
+TEST(LinearPhaseCrossoverTest, TonesLandInTheirBands) {
+    const std::array<float, 3> frequencies = {50.0f, 1000.0f, 10000.0f};
+    for (size_t expected = 0; expected < frequencies.size(); ++expected) {
+        std::vector<float> input(kWarmupSamples + kTestSamples);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = generateSine(frequencies[expected], static_cast<int>(i), kSampleRate);
+        const auto bands = linearPhaseBands(input);
+
+        std::array<double, 3> energy{};
+        for (size_t b = 0; b < bands.size(); ++b)
+            for (size_t i = kWarmupSamples; i < input.size(); ++i)
+                energy[b] += static_cast<double>(bands[b][i]) * static_cast<double>(bands[b][i]);
+
+        const double total = energy[0] + energy[1] + energy[2];
+        EXPECT_GT(energy[expected] / total, 0.999) << frequencies[expected] << " Hz";
+    }
+}
+
+TEST(LinearPhaseCrossoverTest, BandsSumToDelayedInput) {
+    for (const int numChannels : {1, kNumTestChannels, 12}) {
+        expectLinearPhaseSumIsDelay<float, 3>(numChannels);
+        expectLinearPhaseSumIsDelay<double, 5>(numChannels);
+    }
+}
+
+// ===== Double Buffer Tests =====
+
+TEST(DoubleBufferTest, DeliversEachValueOnce) {
+    DoubleBuffer<int> buffer;
+    int value = 0;
+
+    EXPECT_FALSE(buffer.pull(value));
+    EXPECT_TRUE(buffer.push(1));
+    EXPECT_FALSE(buffer.push(2)) << "unread value must not be overwritten";
+    ASSERT_TRUE(buffer.pull(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(buffer.pull(value));
+
+    EXPECT_TRUE(buffer.push(3));
+    ASSERT_TRUE(buffer.pull(value));
+    EXPECT_EQ(value, 3);
+}
+
+TEST(DoubleBufferTest, ConsumerSeesCompleteValues) {
+    // Each pushed array holds one repeated number; a torn read would mix two of them
+    using Payload = std::array<int, 64>;
+    DoubleBuffer<Payload> buffer;
+    constexpr int kNumValues = 5000;
+
+    std::thread producer([&buffer] {
+        for (int i = 1; i <= kNumValues;) {
+            Payload payload;
+            payload.fill(i);
+            if (buffer.push(payload))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    int last = 0;
+    int torn = 0;
+    int stale = 0;
+    Payload payload{};
+    while (last < kNumValues) {
+        if (!buffer.pull(payload)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (std::any_of(payload.begin(), payload.end(), [&](int v) { return v != payload[0]; }))
+            ++torn;
+        if (payload[0] <= last) ++stale;
+        last = std::max(last, payload[0]);
+    }
+
+    producer.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(stale, 0);
+}
+
+// ===== SPSC FIFO Tests =====
+
+TEST(SpscFifoTest, KeepsOrderAndCapacity) {
+    SpscFifo<int, 4> fifo;
+    int value = 0;
+    EXPECT_FALSE(fifo.pop(value));
+
+    for (int i = 1; i <= 4; ++i) EXPECT_TRUE(fifo.push(i));
+    EXPECT_FALSE(fifo.push(5)) << "full";
+
+    for (int i = 1; i <= 4; ++i) {
+        ASSERT_TRUE(fifo.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(fifo.pop(value));
+}
+
+TEST(SpscFifoTest, ConsumerSeesEveryValueInOrder) {
+    // Each pushed array holds one repeated number; a torn read would mix two of them
+    using Payload = std::array<int, 64>;
+    SpscFifo<Payload, 8> fifo;
+    constexpr int kNumValues = 20000;
+
+    std::thread producer([&fifo] {
+        for (int i = 1; i <= kNumValues;) {
+            Payload payload;
+            payload.fill(i);
+            if (fifo.push(payload))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    int expected = 1;
+    int torn = 0;
+    int outOfOrder = 0;
+    Payload payload{};
+    while (expected <= kNumValues) {
+        if (!fifo.pop(payload)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (std::any_of(payload.begin(), payload.end(), [&](int v) { return v != payload[0]; }))
+            ++torn;
+        if (payload[0] != expected) ++outOfOrder;
+        ++expected;
+    }
+
+    producer.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(outOfOrder, 0);
+}
+
+// ===== Band Meter Tests =====
+
+TEST(BandMeterTest, MeasuresEachBandOverWindows) {
+    BandMeter<float> meter;
+    meter.prepare(kSampleRate);
+
+    // Band 0 a full-scale sine, band 1 a constant 0.25, band 2 silent, on every channel
+    constexpr int kBlockSize = 96;
+    std::vector<float> sine(kBlockSize);
+    std::vector<float> constant(kBlockSize, 0.25f);
+    std::vector<float> silence(kBlockSize, 0.0f);
+    float* sineChannels[] = {sine.data(), sine.data()};
+    float* constantChannels[] = {constant.data(), constant.data()};
+    float* silentChannels[] = {silence.data(), silence.data()};
+    const BandMeter<float>::Bands bands = {sineChannels, constantChannels, silentChannels};
+    const BandMeter<float>::Gains gains = {1.0f, 0.5f, 0.0f};
+
+    // 10 ms windows at 48 kHz are 480 samples, so every fifth block completes one
+    int windows = 0;
+    for (int block = 0; block < 50; ++block) {
+        for (int i = 0; i < kBlockSize; ++i)
+            sine[static_cast<size_t>(i)] = generateSine(1000.0f, block * kBlockSize + i,
+                                                        kSampleRate);
+        const bool complete = meter.addBlock(bands, kNumTestChannels, kBlockSize, gains);
+        EXPECT_EQ(complete, block % 5 == 4) << "block " << block;
+        if (!complete) continue;
+
+        ++windows;
+        const auto& levels = meter.getLevels();
+        EXPECT_NEAR(levels.peak[0], 1.0f, 1e-3f);
+        EXPECT_NEAR(levels.rms[0], std::sqrt(0.5f), 1e-3f);
+        EXPECT_FLOAT_EQ(levels.peak[1], 0.25f);
+        EXPECT_FLOAT_EQ(levels.rms[1], 0.25f);
+        EXPECT_EQ(levels.peak[2], 0.0f);
+        EXPECT_EQ(levels.rms[2], 0.0f);
+        EXPECT_EQ(levels.gain, gains);
+    }
+    EXPECT_EQ(windows, 10);
+}
+
+// ===== Spectrum Analyzer Tests =====
+
+TEST(SpectrumRingTest, PublishesWholeChunksAcrossTheWrap) {
+    auto ring = std::make_unique<SpectrumRing>();
+    constexpr int kChunk = 1000;
+    constexpr auto kChunkSize = static_cast<size_t>(kChunk);
+
+    // Trace t of chunk c holds c * 10 + t; chunks past capacity are refused whole
+    int written = 0;
+    for (; ring->hasRoom(kChunk); ++written) {
+        const auto base = static_cast<float>(written * 10);
+        for (size_t trace = 0; trace < kNumSpectrumTraces; ++trace)
+            for (size_t n = 0; n < kChunkSize; ++n)
+                ring->set(trace, n, base + static_cast<float>(trace));
+        ring->commit(kChunk);
+    }
+    EXPECT_EQ(written, static_cast<int>(SpectrumRing::kCapacity / kChunkSize));
+    EXPECT_EQ(ring->getNumReady(), static_cast<size_t>(written) * kChunkSize);
+
+    // Reading makes room, and the next chunk wraps round the end
+    std::vector<float> samples(kChunkSize);
+    for (int chunk = 0; chunk < 2; ++chunk) {
+        for (size_t trace = 0; trace < kNumSpectrumTraces; ++trace) {
+            ring->read(trace, samples.data(), kChunkSize);
+            const auto expected = static_cast<float>(chunk * 10) + static_cast<float>(trace);
+            for (const float x : samples) EXPECT_FLOAT_EQ(x, expected);
+        }
+        ring->discard(kChunkSize);
+    }
+    ASSERT_TRUE(ring->hasRoom(kChunk));
+    for (size_t n = 0; n < kChunkSize; ++n) ring->set(0, n, static_cast<float>(n));
+    ring->commit(kChunk);
+
+    ring->discard(ring->getNumReady() - kChunkSize);
+    ring->read(0, samples.data(), kChunkSize);
+    for (size_t n = 0; n < kChunkSize; ++n) EXPECT_FLOAT_EQ(samples[n], static_cast<float>(n));
+}
+
+TEST(SpectrumAnalyzerTest, SineShowsAtItsFrequencyAndLevel) {
+    auto ring = std::make_unique<SpectrumRing>();
+    ring->setSampleRate(kSampleRate);
+    SpectrumAnalyzer analyzer(*ring);
+
+    // A half-scale 1 kHz sine in the input, silence in the bands
+    constexpr int kChunk = 512;
+    constexpr float kFreq = 1000.0f;
+    int sampleIndex = 0;
+    while (static_cast<size_t>(sampleIndex) < SpectrumAnalyzer::kFftSize) {
+        ASSERT_TRUE(ring->hasRoom(kChunk));
+        for (size_t n = 0; n < static_cast<size_t>(kChunk); ++n, ++sampleIndex) {
+            ring->set(0, n, 0.5f * generateSine(kFreq, sampleIndex, kSampleRate));
+            for (size_t trace = 1; trace < kNumSpectrumTraces; ++trace) ring->set(trace, n, 0.0f);
+        }
+        ring->commit(kChunk);
+    }
+    analyzer.processFrame();
+    EXPECT_EQ(ring->getNumReady(), 0u);
+
+    // Loudest near 1 kHz at -6 dB, give or take the window's scalloping; an octave and a
+    // half away the window's sidelobes are far down
+    const auto& input = analyzer.getSpectrum(0);
+    const auto loudest = static_cast<size_t>(
+        std::distance(input.begin(), std::max_element(input.begin(), input.end())));
+    EXPECT_NEAR(SpectrumAnalyzer::frequencyOf(loudest), kFreq, 0.03f * kFreq);
+    EXPECT_NEAR(input[loudest], 20.0f * std::log10(0.5f), 1.5f);
+    for (size_t point = 0; point < SpectrumAnalyzer::kNumPoints; ++point) {
+        const float octaves = std::abs(std::log2(SpectrumAnalyzer::frequencyOf(point) / kFreq));
+        if (octaves > 1.5f) {
+            EXPECT_LT(input[point], -60.0f) << "point " << point;
+        }
+    }
+    for (size_t trace = 1; trace < kNumSpectrumTraces; ++trace)
+        for (const float db : analyzer.getSpectrum(trace))
+            EXPECT_FLOAT_EQ(db, SpectrumAnalyzer::kMinDb);
+
+    // Paths for every trace, published once
+    SpectrumAnalyzer::Paths paths;
+    ASSERT_TRUE(analyzer.pullPaths(paths));
+    for (const auto& path : paths) EXPECT_FALSE(path.isEmpty());
+    EXPECT_FALSE(analyzer.pullPaths(paths));
+}
+
+// ===== Gain Smoother Tests =====
+
+TEST(MidiCcMapTest, MapsSevenBitControllers) {
+    MidiCcMap map;
+    map.assign(1, {3, 20, false});
+
+    const auto change = map.handleController(3, 20, 127);
+    ASSERT_TRUE(change.has_value());
+    EXPECT_EQ(change->target, 1);
+    EXPECT_FLOAT_EQ(change->value, 1.0f);
+    EXPECT_FLOAT_EQ(map.handleController(3, 20, 0)->value, 0.0f);
+
+    // Other channels and controllers are left alone
+    EXPECT_FALSE(map.handleController(4, 20, 64).has_value());
+    EXPECT_FALSE(map.handleController(3, 21, 64).has_value());
+
+    // Reassigning the controller takes it away from its previous target
+    map.assign(2, {3, 20, false});
+    EXPECT_FALSE(map.getAssignment(1).has_value());
+    EXPECT_EQ(map.handleController(3, 20, 64)->target, 2);
+
+    map.clear(2);
+    EXPECT_FALSE(map.handleController(3, 20, 64).has_value());
+}
+
+TEST(MidiCcMapTest, CombinesFourteenBitPairs) {
+    MidiCcMap map;
+    map.assign(0, {1, 7, true});
+
+    // MSB alone, with the LSB reset
+    EXPECT_FLOAT_EQ(map.handleController(1, 7, 64)->value, 8192.0f / 16383.0f);
+
+    // LSB completes it, one step of 1/16383 at a time
+    EXPECT_FLOAT_EQ(map.handleController(1, 39, 1)->value, 8193.0f / 16383.0f);
+    EXPECT_FLOAT_EQ(map.handleController(1, 39, 127)->value, 8319.0f / 16383.0f);
+    EXPECT_FLOAT_EQ(map.handleController(1, 7, 127)->value, 16256.0f / 16383.0f);
+    EXPECT_FLOAT_EQ(map.handleController(1, 39, 127)->value, 1.0f);
+
+    // Controllers above 31 have no LSB partner and stay 7-bit
+    map.assign(1, {1, 80, true});
+    EXPECT_FALSE(map.getAssignment(1)->highResolution);
+}
+
+TEST(MidiCcMapTest, LearnsControllerAndItsPair) {
+    MidiCcMap map;
+    map.assign(0, {2, 5, false});
+
+    map.startLearning(3);
+    EXPECT_FALSE(map.handleController(2, 5, 10).has_value());  // consumed by learning
+    EXPECT_FALSE(map.handleController(2, 37, 3).has_value());
+    EXPECT_TRUE(map.hasLearned());
+
+    EXPECT_TRUE(map.commitLearned());
+    EXPECT_EQ(map.getLearningTarget(), -1);
+    EXPECT_FALSE(map.getAssignment(0).has_value());
+    EXPECT_EQ(map.getAssignment(3), (MidiCcMap::Assignment{2, 5, true}));
+    EXPECT_FALSE(map.commitLearned());
+
+    // Cancelled learning changes nothing
+    map.startLearning(1);
+    map.handleController(1, 9, 0);
+    map.stopLearning();
+    EXPECT_FALSE(map.commitLearned());
+    EXPECT_FALSE(map.getAssignment(1).has_value());
+}
+
+TEST(MidiCcMapTest, SavesAndRestoresAssignments) {
+    MidiCcMap map;
+    map.assign(0, {1, 1, true});
+    map.assign(5, {16, 100, false});
+
+    juce::XmlElement state("Parameters");
+    map.saveTo(state);
+
+    MidiCcMap restored;
+    restored.assign(2, {1, 2, false});
+    restored.loadFrom(state);
+    EXPECT_EQ(restored.getAssignment(0), (MidiCcMap::Assignment{1, 1, true}));
+    EXPECT_EQ(restored.getAssignment(5), (MidiCcMap::Assignment{16, 100, false}));
+    EXPECT_FALSE(restored.getAssignment(2).has_value());
+
+    // A state saved before MIDI mapping existed clears the map
+    restored.loadFrom(juce::XmlElement("Parameters"));
+    EXPECT_FALSE(restored.getAssignment(0).has_value());
+}
+
+TEST(LoadProfilerTest, GathersHistogramWorstBlockAndOverruns) {
+    LoadProfiler profiler;
+    profiler.prepare(kSampleRate, 480);  // 10 ms budget
+
+    profiler.addBlock(1.2, 480);   // 12%
+    profiler.addBlock(1.4, 480);   // 14%
+    profiler.addBlock(4.9, 240);   // 98% of a 5 ms budget
+    profiler.addBlock(12.0, 480);  // 120%: overrun
+
+    auto stats = profiler.getStats();
+    EXPECT_EQ(stats.numBlocks, 4);
+    EXPECT_EQ(stats.numOverruns, 1);
+    EXPECT_EQ(stats.histogram[2], 2);
+    EXPECT_EQ(stats.histogram[19], 1);
+    EXPECT_EQ(stats.histogram[LoadStats::kNumBins - 1], 1);
+    EXPECT_DOUBLE_EQ(stats.worstLoad, 1.2);
+    EXPECT_DOUBLE_EQ(stats.worstBlockMs, 12.0);
+    EXPECT_EQ(stats.worstBlockSize, 480);
+    EXPECT_GT(stats.averageLoad, 0.0);
+
+    // A reset takes effect with the next block
+    profiler.reset();
+    profiler.addBlock(0.1, 480);
+    stats = profiler.getStats();
+    EXPECT_EQ(stats.numBlocks, 1);
+    EXPECT_EQ(stats.numOverruns, 0);
+    EXPECT_EQ(stats.histogram[0], 1);
+    EXPECT_DOUBLE_EQ(stats.worstLoad, 0.01);
+}
+
+TEST(GainSmootherTest, RampMatchesPerSampleRecurrence) {
+    constexpr int kBlockSize = 128;
+    GainSmoother<float> smoother;
+    smoother.prepare(kSampleRate, kBlockSize);
+
+    const GainSmoother<float>::Gains targets = {0.0f, 0.5f, 3.98f};
+    const double alpha =
+        1.0 - std::exp(-1.0 / (static_cast<double>(kGainSmoothTimeSec) * kSampleRate));
+
+    std::array<double, kNumBands> reference = {1.0, 1.0, 1.0};
+    for (int block = 0; block < 8; ++block) {
+        ASSERT_FALSE(smoother.advance(targets, kBlockSize));
+        for (int i = 0; i < kBlockSize; ++i) {
+            for (size_t band = 0; band < reference.size(); ++band) {
+                reference[band] += alpha * (static_cast<double>(targets[band]) - reference[band]);
+                ASSERT_NEAR(smoother.getRamp(static_cast<int>(band))[i], reference[band], 1e-5)
+                    << "band " << band << " sample " << (block * kBlockSize + i);
+            }
+        }
+    }
+}
+
+TEST(GainSmootherTest, ConvergesToSteadyState) {
+    constexpr int kBlockSize = 512;
+    GainSmoother<float> smoother;
+    smoother.prepare(kSampleRate, kBlockSize);
+
+    const GainSmoother<float>::Gains targets = {0.0f, 1.0f, 2.0f};
+    EXPECT_FALSE(smoother.advance(targets, kBlockSize));
+
+    // 100 ms is 20 time constants, far past the snap threshold
+    for (int i = 0; i < 10; ++i) smoother.advance(targets, kBlockSize);
+
+    EXPECT_TRUE(smoother.advance(targets, kBlockSize));
+    for (int band = 0; band < kNumBands; ++band)
+        EXPECT_FLOAT_EQ(smoother.getCurrent(band), targets[static_cast<size_t>(band)]);
+}
+
+// ===== Drive Tests =====
+
+namespace {
+
+// Level in dB (re full scale) of the component of data at freq, through a Hann window so
+// a loud tone does not leak into the bins of quiet ones
+double toneLevelDb(const std::vector<double>& data, double freq, double sampleRate) {
+    const auto size = static_cast<double>(data.size());
+    double re = 0.0;
+    double im = 0.0;
+    double windowSum = 0.0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        const double n = static_cast<double>(i);
+        const double window = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * n / (size - 1.0));
+        const double phase = 2.0 * std::numbers::pi * freq * n / sampleRate;
+        re += data[i] * window * std::cos(phase);
+        im += data[i] * window * std::sin(phase);
+        windowSum += window;
+    }
+    return 20.0 * std::log10(2.0 * std::hypot(re, im) / windowSum + 1e-20);
+}
+
+}  // namespace
+
+TEST(DriveTest, OversamplerPassesTheAudioBand) {
+    constexpr int kNumSamples = 8192;
+
+    for (const double freq : {100.0, 5000.0, 19000.0}) {
+        HalfBandOversampler<double> oversampler;
+        std::vector<double> output;
+        for (int i = 0; i < kNumSamples; ++i) {
+            const double input =
+                std::sin(2.0 * std::numbers::pi * freq * static_cast<double>(i) / kSampleRate);
+            const auto upsampled = oversampler.upsample(input);
+            output.push_back(oversampler.downsample(upsampled[0], upsampled[1]));
+        }
+        output.erase(output.begin(), output.begin() + kNumSamples / 2);
+        EXPECT_NEAR(toneLevelDb(output, freq, kSampleRate), 0.0, 0.01) << freq << " Hz";
+    }
+}
+
+TEST(DriveTest, OversamplingKeepsAliasesOutOfTheAudioBand) {
+    constexpr int kNumSamples = 8192;
+    constexpr double kFreq = kSampleRate * 299.0 / 4096.0;  // about 3.5 kHz
+    constexpr double kAmplitude = 0.9;
+    constexpr double kNyquist = kSampleRate / 2.0;
+    constexpr auto kDrive = static_cast<double>(kMaxDrive);
+
+    DriveStage<double> drive;
+    drive.prepare(kSampleRate, 1);
+    std::vector<double> driven(kNumSamples);
+    std::vector<double> naive(kNumSamples);
+    for (int i = 0; i < kNumSamples; ++i) {
+        const double input = kAmplitude
+            * std::sin(2.0 * std::numbers::pi * kFreq * static_cast<double>(i) / kSampleRate);
+        naive[static_cast<size_t>(i)] = std::tanh(kDrive * input) / kDrive;
+        driven[static_cast<size_t>(i)] = input;
+    }
+    double* channel = driven.data();
+    drive.process(&channel, 1, kNumSamples, 1.0);
+
+    // Past the fade-in
+    driven.erase(driven.begin(), driven.begin() + kNumSamples / 2);
+    naive.erase(naive.begin(), naive.begin() + kNumSamples / 2);
+    EXPECT_NEAR(toneLevelDb(driven, kFreq, kSampleRate), toneLevelDb(naive, kFreq, kSampleRate),
+                0.1);
+
+    // Odd harmonics above Nyquist fold back into the audio band without oversampling
+    for (int harmonic = 9; harmonic <= 15; harmonic += 2) {
+        const double folded = std::fmod(harmonic * kFreq, kSampleRate);
+        const double alias = folded <= kNyquist ? folded : kSampleRate - folded;
+        EXPECT_GT(toneLevelDb(naive, alias, kSampleRate), -70.0) << "harmonic " << harmonic;
+        EXPECT_LT(toneLevelDb(driven, alias, kSampleRate), -110.0) << "harmonic " << harmonic;
+    }
+}
+
+TEST(WorkerPoolTest, RunsEveryTaskOnceBeforeReturning) {
+    constexpr int kNumTasks = 37;
+    WorkerPool pool;
+
+    for (int numWorkers : {0, 3}) {
+        // Without real-time scheduling the pool stays off and run() works alone
+        const bool started = pool.start(numWorkers, kSampleRate, 512);
+        EXPECT_EQ(pool.getNumWorkers(), started ? numWorkers : 0);
+
+        std::array<std::atomic<int>, kNumTasks> calls{};
+        auto task = [&calls](int index) { calls[static_cast<size_t>(index)].fetch_add(1); };
+        for (int job = 1; job <= 1000; ++job) {
+            pool.run(kNumTasks, task);
+            for (int index = 0; index < kNumTasks; ++index)
+                ASSERT_EQ(calls[static_cast<size_t>(index)].load(), job)
+                    << numWorkers << " workers, task " << index;
+        }
+    }
+
+    // Restarting the pool under a running audio thread loses no task
+    std::atomic<bool> done{false};
+    std::atomic<int> numCalls{0};
+    int numJobs = 0;
+    std::thread audio([&] {
+        auto task = [&numCalls](int) { numCalls.fetch_add(1); };
+        for (; !done.load(); ++numJobs) pool.run(8, task);
+    });
+    for (int restart = 0; restart < 20; ++restart) {
+        pool.start(restart % 4, kSampleRate, 512);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    done = true;
+    audio.join();
+    EXPECT_EQ(numCalls.load(), 8 * numJobs);
+    pool.stop();
+    EXPECT_EQ(pool.getNumWorkers(), 0);
+}
+
+// ===== Gain Tests =====
+
+TEST(GainTest, KillBandRemovesSignal) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    auto* lowParam = processor->getAPVTS().getParameter(ParamID::kLow);
+    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-100.0f));
+
+    constexpr float kFreq = 50.0f;
+    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+
+    juce::AudioBuffer<float> buffer(2, kTotalSamples);
+    for (int i = 0; i < kTotalSamples; ++i) {
+        float s = generateSine(kFreq, i, kSampleRate);
+        buffer.setSample(0, i, s);
+        buffer.setSample(1, i, s);
+    }
+
+    processInBlocks(*processor, buffer, kTotalSamples);
+
+    float outputRms = rmsLevel(buffer.getReadPointer(0) + kWarmupSamples, kTestSamples);
+    // Generate reference input for the test region
+    std::vector<float> refInput(static_cast<size_t>(kTestSamples));
+    for (size_t i = 0; i < static_cast<size_t>(kTestSamples); ++i) {
+        refInput[i] = generateSine(kFreq, kWarmupSamples + static_cast<int>(i), kSampleRate);
+    }
+    float inputRms = rmsLevel(refInput.data(), kTestSamples);
+    float ratioDb = 20.0f * std::log10(outputRms / inputRms);
+
+    // 50Hz is ~2.3 octaves below 250Hz crossover, so LR4 (24dB/oct) gives ~55dB attenuation
+    EXPECT_LT(ratioDb, -40.0f)
+        << "Killed low band should attenuate 50Hz signal, got " << ratioDb << " dB";
+}
+
+TEST(GainTest, UnityGainPassthrough) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+    juce::AudioBuffer<float> buffer(2, kTotalSamples);
+    std::vector<float> originalInput(static_cast<size_t>(kTotalSamples));
+
+    for (size_t i = 0; i < static_cast<size_t>(kTotalSamples); ++i) {
+        float s = dist(rng);
+        originalInput[i] = s;
+        buffer.setSample(0, static_cast<int>(i), s);
+        buffer.setSample(1, static_cast<int>(i), s);
+    }
+
+    processInBlocks(*processor, buffer, kTotalSamples);
+
+    // Compare RMS levels (crossover introduces allpass phase shift, so sample
+    // values differ but magnitude should be preserved)
+    float outputRms = rmsLevel(buffer.getReadPointer(0) + kWarmupSamples, kTestSamples);
+    float inputRms = rmsLevel(originalInput.data() + kWarmupSamples, kTestSamples);
+    float magnitudeErrorDb = 20.0f * std::log10(outputRms / inputRms);
+
+    EXPECT_NEAR(magnitudeErrorDb, 0.0f, 0.1f)
+        << "Unity gain passthrough should preserve magnitude, got " << magnitudeErrorDb << " dB";
+}
+
+TEST(GainTest, SilenceInSilenceOut) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    juce::AudioBuffer<float> buffer(2, 512);
+    buffer.clear();
+
+    juce::MidiBuffer midi;
+    processor->processBlock(buffer, midi);
+
+    for (int ch = 0; ch < 2; ++ch) {
+        for (int i = 0; i < 512; ++i) {
+            EXPECT_LT(std::abs(buffer.getSample(ch, i)), 1e-7f)
+                << "Non-silence at ch=" << ch << " sample=" << i;
+        }
+    }
+}
+
+TEST(GainTest, GainSmoothingNoClicks) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    constexpr float kFreq = 1000.0f;
+
+    // Process warmup at unity gain
+    juce::AudioBuffer<float> warmup(2, kWarmupSamples);
+    for (int i = 0; i < kWarmupSamples; ++i) {
+        float s = generateSine(kFreq, i, kSampleRate);
+        warmup.setSample(0, i, s);
+        warmup.setSample(1, i, s);
+    }
+    processInBlocks(*processor, warmup, kWarmupSamples);
+
+    // Kill mid band and process more audio
+    auto* midParam = processor->getAPVTS().getParameter(ParamID::kMid);
+    midParam->setValueNotifyingHost(midParam->convertTo0to1(-100.0f));
+
+    constexpr int kPostChangeSamples = 4096;
+    juce::AudioBuffer<float> postChange(2, kPostChangeSamples);
+    for (int i = 0; i < kPostChangeSamples; ++i) {
+        float s = generateSine(kFreq, kWarmupSamples + i, kSampleRate);
+        postChange.setSample(0, i, s);
+        postChange.setSample(1, i, s);
+    }
+    processInBlocks(*processor, postChange, kPostChangeSamples);
+
+    // Verify no sample exceeds the pre-change level
+    for (int i = 0; i < kPostChangeSamples; ++i) {
+        EXPECT_LE(std::abs(postChange.getSample(0, i)), 1.01f)
+            << "Click/overshoot at sample " << i << ": " << postChange.getSample(0, i);
+    }
+}
+
+TEST(GainTest, BoostClamping) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    // Set band to +12dB, boost to 0dB -> effective should be 0dB
+    auto& apvts = processor->getAPVTS();
+    auto* lowParam = apvts.getParameter(ParamID::kLow);
+    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(12.0f));
+    // boost stays at index 0 = "0 dB"
+
+    constexpr float kFreq = 50.0f;
+    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+
+    juce::AudioBuffer<float> buffer(2, kTotalSamples);
+    std::vector<float> originalInput(static_cast<size_t>(kTotalSamples));
+    for (size_t i = 0; i < static_cast<size_t>(kTotalSamples); ++i) {
+        float s = generateSine(kFreq, static_cast<int>(i), kSampleRate);
+        originalInput[i] = s;
+        buffer.setSample(0, static_cast<int>(i), s);
+        buffer.setSample(1, static_cast<int>(i), s);
+    }
+
+    processInBlocks(*processor, buffer, kTotalSamples);
+
+    // Measure output vs input energy ratio (should be near unity = 0 dB)
+    float outputRms = rmsLevel(buffer.getReadPointer(0) + kWarmupSamples, kTestSamples);
+    float inputRms = rmsLevel(originalInput.data() + kWarmupSamples, kTestSamples);
+    float ratioDb = 20.0f * std::log10(outputRms / inputRms);
+
+    EXPECT_NEAR(ratioDb, 0.0f, 0.5f)
+        << "With +12dB gain but 0dB boost limit, effective should be ~0dB, got " << ratioDb;
+}
+
+// ===== Plugin Tests =====
+
+TEST(PluginTest, PluginInstantiation) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    EXPECT_EQ(processor->getName(), "Iso3D");
+}
+
+TEST(PluginTest, BusLayout) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+
+    auto makeLayout = [](const juce::AudioChannelSet& in, const juce::AudioChannelSet& out) {
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(in);
+        layout.outputBuses.add(out);
+        return layout;
+    };
+
+    // Matching layouts up to kMaxChannels are accepted
+    EXPECT_TRUE(processor->isBusesLayoutSupported(
+        makeLayout(juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo())));
+    EXPECT_TRUE(processor->isBusesLayoutSupported(
+        makeLayout(juce::AudioChannelSet::mono(), juce::AudioChannelSet::mono())));
+    EXPECT_TRUE(processor->isBusesLayoutSupported(makeLayout(
+        juce::AudioChannelSet::create5point1(), juce::AudioChannelSet::create5point1())));
+    EXPECT_TRUE(processor->isBusesLayoutSupported(
+        makeLayout(juce::AudioChannelSet::create7point1point4(),
+                   juce::AudioChannelSet::create7point1point4())));
+    EXPECT_TRUE(processor->isBusesLayoutSupported(
+        makeLayout(juce::AudioChannelSet::discreteChannels(kMaxChannels),
+                   juce::AudioChannelSet::discreteChannels(kMaxChannels))));
+
+    // Mono in, stereo out should be rejected
+    EXPECT_FALSE(processor->isBusesLayoutSupported(
+        makeLayout(juce::AudioChannelSet::mono(), juce::AudioChannelSet::stereo())));
+
+    // Wider than the crossover supports should be rejected
+    EXPECT_FALSE(processor->isBusesLayoutSupported(
+        makeLayout(juce::AudioChannelSet::discreteChannels(kMaxChannels + 1),
+                   juce::AudioChannelSet::discreteChannels(kMaxChannels + 1))));
+}
+
+TEST(PluginTest, MultichannelKillAppliesToEveryChannel) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::create7point1point4());
+    layout.outputBuses.add(juce::AudioChannelSet::create7point1point4());
+    ASSERT_TRUE(processor->setBusesLayout(layout));
+    processor->prepareToPlay(kSampleRate, 512);
+
+    auto* lowParam = processor->getAPVTS().getParameter(ParamID::kLow);
+    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-100.0f));
+
+    constexpr float kFreq = 50.0f;
+    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+    const int numChannels = processor->getTotalNumInputChannels();
+
+    juce::AudioBuffer<float> buffer(numChannels, kTotalSamples);
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < kTotalSamples; ++i)
+            buffer.setSample(ch, i, generateSine(kFreq, i, kSampleRate));
+
+    juce::MidiBuffer midi;
+    for (int pos = 0; pos < kTotalSamples; pos += 512) {
+        const int blockSize = std::min(512, kTotalSamples - pos);
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, pos,
+                                       blockSize);
+        processor->processBlock(block, midi);
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        const float outputRms =
+            rmsLevel(buffer.getReadPointer(ch) + kWarmupSamples, kTestSamples);
+        EXPECT_LT(20.0f * std::log10(outputRms / std::sqrt(0.5f)), -40.0f) << "channel " << ch;
+    }
+}
+
+TEST(PluginTest, DoublePrecisionMatchesSinglePrecision) {
+    auto floatProcessor = std::make_unique<AudioPluginAudioProcessor>();
+    auto doubleProcessor = std::make_unique<AudioPluginAudioProcessor>();
+    ASSERT_TRUE(doubleProcessor->supportsDoublePrecisionProcessing());
+    doubleProcessor->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+    for (auto* processor : {floatProcessor.get(), doubleProcessor.get()}) {
+        processor->prepareToPlay(kSampleRate, 512);
+        auto* midParam = processor->getAPVTS().getParameter(ParamID::kMid);
+        midParam->setValueNotifyingHost(midParam->convertTo0to1(-100.0f));
+    }
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    juce::AudioBuffer<float> floatBuffer(kNumTestChannels, kTestSamples);
+    juce::AudioBuffer<double> doubleBuffer(kNumTestChannels, kTestSamples);
+    for (int ch = 0; ch < kNumTestChannels; ++ch) {
+        for (int i = 0; i < kTestSamples; ++i) {
+            const float s = dist(rng);
+            floatBuffer.setSample(ch, i, s);
+            doubleBuffer.setSample(ch, i, static_cast<double>(s));
+        }
+    }
+
+    // Uneven host blocks, including ones larger than the prepared block size
+    juce::MidiBuffer midi;
+    for (int pos = 0, blockSize = 1; pos < kTestSamples; pos += blockSize, blockSize += 97) {
+        blockSize = std::min(blockSize, kTestSamples - pos);
+        juce::AudioBuffer<float> floatBlock(floatBuffer.getArrayOfWritePointers(),
+                                            kNumTestChannels, pos, blockSize);
+        juce::AudioBuffer<double> doubleBlock(doubleBuffer.getArrayOfWritePointers(),
+                                              kNumTestChannels, pos, blockSize);
+        floatProcessor->processBlock(floatBlock, midi);
+        doubleProcessor->processBlock(doubleBlock, midi);
+    }
+
+    for (int ch = 0; ch < kNumTestChannels; ++ch)
+        for (int i = 0; i < kTestSamples; ++i)
+            ASSERT_NEAR(static_cast<double>(floatBuffer.getSample(ch, i)),
+                        doubleBuffer.getSample(ch, i), 1e-4)
+                << "ch " << ch << " sample " << i;
+}
+
+TEST(PluginTest, CrossoverFrequencyParameterReachesAudio) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    // 180 Hz sits in the low band at the default 250 Hz split. Kill low, then move the
+    // split below the tone so it lands in the mid band and passes.
+    auto& apvts = processor->getAPVTS();
+    auto* lowParam = apvts.getParameter(ParamID::kLow);
+    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-100.0f));
+
+    constexpr float kFreq = 180.0f;
+    constexpr int kBlockSize = 512;
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer midi;
+    int sampleIndex = 0;
+
+    auto processAndMeasureDb = [&] {
+        for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                buffer.setSample(ch, i, generateSine(kFreq, sampleIndex, kSampleRate));
+        processor->processBlock(buffer, midi);
+        return 20.0f * std::log10(rmsLevel(buffer.getReadPointer(0), kBlockSize)
+                                  / std::sqrt(0.5f) + 1e-9f);
+    };
+
+    for (int block = 0; block < 40; ++block) processAndMeasureDb();
+    EXPECT_LT(processAndMeasureDb(), -12.0f);
+
+    auto* splitParam = apvts.getParameter(ParamID::kLowMidFreq);
+    splitParam->setValueNotifyingHost(splitParam->convertTo0to1(kLowMidCrossoverMinHz));
+
+    // The tuner thread picks the change up within a few ms; allow plenty of slack
+    float levelDb = -100.0f;
+    for (int attempt = 0; attempt < 200 && levelDb < -1.0f; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        for (int block = 0; block < 4; ++block) levelDb = processAndMeasureDb();
+    }
+    EXPECT_GT(levelDb, -1.0f);
+}
+
+// Offline the split point moves at the block it changes in, not whenever the tuner thread
+// wakes, so a render comes out the same every time
+TEST(PluginTest, OfflineFrequencyChangeRendersTheSameEveryTime) {
+    constexpr int kBlockSize = 512;
+    constexpr int kNumBlocks = 32;
+    constexpr int kChangeBlock = 16;
+
+    juce::AudioBuffer<float> input(kNumTestChannels, kBlockSize * kNumBlocks);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int ch = 0; ch < kNumTestChannels; ++ch)
+        for (int i = 0; i < input.getNumSamples(); ++i) input.setSample(ch, i, dist(rng));
+
+    // The second render is switched offline only once prepared, as some hosts do
+    auto render = [&](bool linearPhase, bool moveSplit, bool switchAfterPrepare = false) {
+        auto processor = std::make_unique<AudioPluginAudioProcessor>();
+        auto& apvts = processor->getAPVTS();
+        apvts.getParameter(ParamID::kLinearPhase)->setValueNotifyingHost(linearPhase ? 1.0f
+                                                                                     : 0.0f);
+        // Kill the low band so the split point is audible at either phase response
+        auto* lowParam = apvts.getParameter(ParamID::kLow);
+        lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-100.0f));
+        processor->setNonRealtime(!switchAfterPrepare);
+        processor->prepareToPlay(kSampleRate, kBlockSize);
+        processor->setNonRealtime(true);
+
+        juce::AudioBuffer<float> output(input);
+        juce::MidiBuffer midi;
+        for (int block = 0; block < kNumBlocks; ++block) {
+            if (moveSplit && block == kChangeBlock) {
+                auto* splitParam = apvts.getParameter(ParamID::kLowMidFreq);
+                splitParam->setValueNotifyingHost(splitParam->convertTo0to1(kLowMidCrossoverMaxHz));
+            }
+            juce::AudioBuffer<float> view(output.getArrayOfWritePointers(), kNumTestChannels,
+                                          block * kBlockSize, kBlockSize);
+            processor->processBlock(view, midi);
+        }
+        return output;
+    };
+
+    for (const bool linearPhase : {false, true}) {
+        SCOPED_TRACE(linearPhase ? "linear phase" : "IIR");
+        const auto first = render(linearPhase, true);
+        const auto second = render(linearPhase, true, true);
+        const auto unmoved = render(linearPhase, false);
+
+        int firstDifference = -1;
+        for (int i = 0; i < first.getNumSamples(); ++i) {
+            for (int ch = 0; ch < kNumTestChannels; ++ch) {
+                ASSERT_EQ(first.getSample(ch, i), second.getSample(ch, i))
+                    << "ch " << ch << " sample " << i;
+                if (firstDifference < 0
+                    && !juce::exactlyEqual(first.getSample(ch, i), unmoved.getSample(ch, i)))
+                    firstDifference = i;
+            }
+        }
+
+        // Before the change block the renders match; the change is heard within it
+        EXPECT_GE(firstDifference, kChangeBlock * kBlockSize);
+        EXPECT_LT(firstDifference, (kChangeBlock + 1) * kBlockSize);
+    }
+}
+
+TEST(PluginTest, LinearPhaseReportsLatency) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+    EXPECT_EQ(processor->getLatencySamples(), 0);
+
+    auto* linearPhaseParam = processor->getAPVTS().getParameter(ParamID::kLinearPhase);
+    linearPhaseParam->setValueNotifyingHost(1.0f);
+    processor->prepareToPlay(kSampleRate, 512);
+
+    LinearPhaseCrossover<float> reference;
+    reference.prepare(kSampleRate, kNumTestChannels);
+    const int latency = processor->getLatencySamples();
+    ASSERT_EQ(latency, reference.getLatencySamples());
+
+    // At unity the output is exactly the input, that many samples late
+    constexpr int kTotal = 8192;
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kTotal);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int ch = 0; ch < kNumTestChannels; ++ch)
+        for (int i = 0; i < kTotal; ++i) buffer.setSample(ch, i, dist(rng));
+    const juce::AudioBuffer<float> input(buffer);
+
+    processInBlocks(*processor, buffer, kTotal);
+    for (int ch = 0; ch < kNumTestChannels; ++ch)
+        for (int i = latency; i < kTotal; ++i)
+            ASSERT_FLOAT_EQ(buffer.getSample(ch, i), input.getSample(ch, i - latency))
+                << "ch " << ch << " sample " << i;
+}
+
+TEST(PluginTest, ModeSwitchIsClickFree) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    // Off unity, so both engines run their bands and gain stage through the switch
+    auto& apvts = processor->getAPVTS();
+    auto* lowParam = apvts.getParameter(ParamID::kLow);
+    lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-6.0f));
+    auto* linearPhaseParam = apvts.getParameter(ParamID::kLinearPhase);
+
+    constexpr float kFreq = 440.0f;
+    constexpr int kBlockSize = 512;
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer midi;
+    int sampleIndex = 0;
+    float previous = 0.0f;
+    float maxStep = 0.0f;
+
+    auto processBlocks = [&](int numBlocks) {
+        for (int block = 0; block < numBlocks; ++block) {
+            for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+                for (int ch = 0; ch < kNumTestChannels; ++ch)
+                    buffer.setSample(ch, i, generateSine(kFreq, sampleIndex, kSampleRate));
+            processor->processBlock(buffer, midi);
+
+            for (int i = 0; i < kBlockSize; ++i) {
+                const float s = buffer.getSample(0, i);
+                maxStep = std::max(maxStep, std::abs(s - previous));
+                previous = s;
+            }
+        }
+    };
+
+    processBlocks(40);
+    const float settledStep = maxStep;
+
+    // Into linear phase and back, each switch given time to finish
+    linearPhaseParam->setValueNotifyingHost(1.0f);
+    processBlocks(40);
+    linearPhaseParam->setValueNotifyingHost(0.0f);
+    processBlocks(40);
+
+    EXPECT_LT(maxStep, 1.5f * settledStep);
+}
+
+TEST(PluginTest, DriveSaturatesAndSwitchesOffWithoutTrace) {
+    constexpr int kBlockSize = 512;
+    constexpr float kFreq = 100.0f;
+
+    auto driven = std::make_unique<AudioPluginAudioProcessor>();
+    auto reference = std::make_unique<AudioPluginAudioProcessor>();
+    for (auto* processor : {driven.get(), reference.get()})
+        processor->prepareToPlay(kSampleRate, kBlockSize);
+    auto* driveParam = driven->getAPVTS().getParameter(ParamID::kDrive);
+
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::AudioBuffer<float> expected(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer midi;
+    int sampleIndex = 0;
+    auto processBlock = [&] {
+        for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                buffer.setSample(ch, i, 0.9f * generateSine(kFreq, sampleIndex, kSampleRate));
+        expected.makeCopyOf(buffer);
+        driven->processBlock(buffer, midi);
+        reference->processBlock(expected, midi);
+    };
+
+    // Full drive rounds the peaks off to tanh(0.9 k) / k
+    driveParam->setValueNotifyingHost(1.0f);
+    for (int block = 0; block < 10; ++block) processBlock();
+    const float peak = buffer.getMagnitude(0, 0, kBlockSize);
+    EXPECT_NEAR(peak, std::tanh(0.9f * kMaxDrive) / kMaxDrive, 0.01f);
+    EXPECT_GT(expected.getMagnitude(0, 0, kBlockSize), 0.85f);
+
+    // Once faded out, the stage leaves the signal exactly as it was
+    driveParam->setValueNotifyingHost(0.0f);
+    processBlock();
+    for (int block = 0; block < 4; ++block) {
+        processBlock();
+        for (int ch = 0; ch < kNumTestChannels; ++ch)
+            for (int i = 0; i < kBlockSize; ++i)
+                ASSERT_EQ(buffer.getSample(ch, i), expected.getSample(ch, i))
+                    << "block " << block << ", channel " << ch << ", sample " << i;
+    }
+}
+
+TEST(PluginTest, SweepMovesSplitPointsAndSettlesBack) {
+    // With the low band killed, a 400 Hz tone comes through at a level set by how far
+    // above the low/mid split point it is, so the sweep shows as a swing in level
+    constexpr int kBlockSize = 480;
+    constexpr float kFreq = 400.0f;
+
+    auto swept = std::make_unique<AudioPluginAudioProcessor>();
+    auto reference = std::make_unique<AudioPluginAudioProcessor>();
+    for (auto* processor : {swept.get(), reference.get()}) {
+        processor->prepareToPlay(kSampleRate, kBlockSize);
+        processor->getAPVTS().getParameter(ParamID::kLow)->setValueNotifyingHost(0.0f);
+    }
+    auto setParameter = [&swept](const char* id, float value) {
+        auto* param = swept->getAPVTS().getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    };
+
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::AudioBuffer<float> expected(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer midi;
+    int sampleIndex = 0;
+    auto processBlock = [&] {
+        for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                buffer.setSample(ch, i, 0.5f * generateSine(kFreq, sampleIndex, kSampleRate));
+        expected.makeCopyOf(buffer);
+        swept->processBlock(buffer, midi);
+        reference->processBlock(expected, midi);
+    };
+
+    // Two octaves at 5 Hz: over a second, blocks of 10 ms catch both ends of the swing
+    setParameter(ParamID::kSweepDepth, kMaxSweepOctaves);
+    setParameter(ParamID::kSweepRate, 5.0f);
+    for (int block = 0; block < 20; ++block) processBlock();
+    float quietest = 1.0f;
+    float loudest = 0.0f;
+    for (int block = 0; block < 100; ++block) {
+        processBlock();
+        const float level = buffer.getRMSLevel(0, 0, kBlockSize);
+        quietest = std::min(quietest, level);
+        loudest = std::max(loudest, level);
+    }
+    EXPECT_GT(20.0f * std::log10(loudest / quietest), 6.0f);
+
+    // Back at depth 0 the crossover glides home and ends up like one that never swept
+    setParameter(ParamID::kSweepDepth, 0.0f);
+    for (int block = 0; block < 100; ++block) processBlock();
+    for (int ch = 0; ch < kNumTestChannels; ++ch)
+        for (int i = 0; i < kBlockSize; ++i)
+            ASSERT_NEAR(buffer.getSample(ch, i), expected.getSample(ch, i), 1e-4f)
+                << "channel " << ch << ", sample " << i;
+}
+
+TEST(PluginTest, WorkerThreadsMatchInlineProcessing) {
+    constexpr int kBlockSize = 256;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(kMaxChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(kMaxChannels));
+
+    auto parallel = std::make_unique<AudioPluginAudioProcessor>();
+    auto serial = std::make_unique<AudioPluginAudioProcessor>();
+    for (auto* processor : {parallel.get(), serial.get()}) {
+        ASSERT_TRUE(processor->setBusesLayout(layout));
+        processor->prepareToPlay(kSampleRate, kBlockSize);
+    }
+    // Capped at one fewer than the machine's cores
+    const int numWorkers = std::min(3, AudioPluginAudioProcessor::getMaxWorkerThreads());
+    parallel->setNumWorkerThreads(kMaxWorkerThreads + 1);
+    EXPECT_EQ(parallel->getNumWorkerThreads(), AudioPluginAudioProcessor::getMaxWorkerThreads());
+    EXPECT_LT(parallel->getNumWorkerThreads(), juce::SystemStats::getNumCpus());
+    parallel->setNumWorkerThreads(3);
+    EXPECT_EQ(parallel->getNumWorkerThreads(), numWorkers);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    juce::AudioBuffer<float> buffer(kMaxChannels, kBlockSize);
+    juce::AudioBuffer<float> expected(kMaxChannels, kBlockSize);
+    juce::MidiBuffer midi;
+
+    // Moving gains, converged unity, and blocks too short to share out
+    for (int block = 0; block < 40; ++block) {
+        const float lowDb = block < 20 ? -6.0f * static_cast<float>(block % 4) : 0.0f;
+        for (auto* processor : {parallel.get(), serial.get()}) {
+            auto* lowParam = processor->getAPVTS().getParameter(ParamID::kLow);
+            lowParam->setValueNotifyingHost(lowParam->convertTo0to1(lowDb));
+        }
+
+        const int numSamples = block % 5 == 4 ? kMinParallelSamples / 2 : kBlockSize;
+        juce::AudioBuffer<float> output(buffer.getArrayOfWritePointers(), kMaxChannels,
+                                        numSamples);
+        juce::AudioBuffer<float> reference(expected.getArrayOfWritePointers(), kMaxChannels,
+                                           numSamples);
+        for (int ch = 0; ch < kMaxChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i) {
+                const float sample = dist(rng);
+                output.setSample(ch, i, sample);
+                reference.setSample(ch, i, sample);
+            }
+        parallel->processBlock(output, midi);
+        serial->processBlock(reference, midi);
+
+        for (int ch = 0; ch < kMaxChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                ASSERT_EQ(output.getSample(ch, i), reference.getSample(ch, i))
+                    << "block " << block << ", channel " << ch << ", sample " << i;
+    }
+
+    // The worker count is saved with the state
+    juce::MemoryBlock state;
+    parallel->getStateInformation(state);
+    serial->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    EXPECT_EQ(serial->getNumWorkerThreads(), numWorkers);
+
+    // Restoring only stores the count; the workers start once the processor is prepared
+    EXPECT_EQ(serial->getNumRunningWorkerThreads(), 0);
+    serial->releaseResources();
+    serial->prepareToPlay(kSampleRate, kBlockSize);
+    EXPECT_EQ(serial->getNumRunningWorkerThreads(), parallel->getNumRunningWorkerThreads());
+
+    // A state saved on a machine with more cores restores with the cap
+    juce::MemoryBlock widerState;
+    {
+        BinaryStateWriter writer(widerState);
+        writer.writeChunk(chunkTag("WRKR"), [](juce::OutputStream& stream) {
+            stream.writeByte(static_cast<char>(kMaxWorkerThreads));
+        });
+    }
+    serial->setStateInformation(widerState.getData(), static_cast<int>(widerState.getSize()));
+    EXPECT_EQ(serial->getNumWorkerThreads(), AudioPluginAudioProcessor::getMaxWorkerThreads());
+}
+
+TEST(PluginTest, MeteringQueuesBandLevelsWhenEnabled) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    constexpr float kFreq = 50.0f;
+    juce::AudioBuffer<float> buffer(kNumTestChannels, static_cast<int>(kSampleRate) / 10);
+    auto fillAndProcess = [&] {
+        for (int ch = 0; ch < kNumTestChannels; ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, generateSine(kFreq, i, kSampleRate));
+        processInBlocks(*processor, buffer, buffer.getNumSamples());
+    };
+
+    // Off by default: nothing is queued
+    BandLevels levels;
+    fillAndProcess();
+    EXPECT_FALSE(processor->popBandLevels(levels));
+
+    // On, at unity: the bands still run, so a low tone shows in the low band only
+    processor->setMeteringEnabled(true);
+    fillAndProcess();
+
+    int windows = 0;
+    BandLevels last;
+    while (processor->popBandLevels(levels)) {
+        last = levels;
+        ++windows;
+    }
+    EXPECT_GE(windows, 9);  // 100 ms in 10 ms windows
+    EXPECT_NEAR(last.rms[0], std::sqrt(0.5f), 0.02f);
+    EXPECT_LT(last.rms[1], 0.02f);
+    EXPECT_LT(last.rms[2], 0.001f);
+    EXPECT_FLOAT_EQ(last.gain[0], 1.0f);
+}
+
+TEST(PluginTest, AnalyzerCapturesInputAndBandsWhenEnabled) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+    auto& ring = processor->getSpectrumRing();
+    EXPECT_DOUBLE_EQ(ring.getSampleRate(), kSampleRate);
+
+    // A 1 kHz tone, with the low band killed
+    processor->getAPVTS().getParameter(ParamID::kLow)->setValueNotifyingHost(0.0f);
+    constexpr float kFreq = 1000.0f;
+    juce::AudioBuffer<float> buffer(kNumTestChannels, static_cast<int>(kSampleRate) / 10);
+    auto fillAndProcess = [&] {
+        for (int ch = 0; ch < kNumTestChannels; ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, generateSine(kFreq, i, kSampleRate));
+        processInBlocks(*processor, buffer, buffer.getNumSamples());
+    };
+
+    // Off by default: nothing is captured
+    fillAndProcess();
+    EXPECT_EQ(ring.getNumReady(), 0u);
+
+    // On: every sample of the input, mixed to mono, and of each band after its gain.
+    // The first pass lets the low band's gain ramp down.
+    processor->setAnalyzerEnabled(true);
+    fillAndProcess();
+    ring.discard(ring.getNumReady());
+    fillAndProcess();
+
+    const auto numSamples = static_cast<size_t>(buffer.getNumSamples());
+    ASSERT_EQ(ring.getNumReady(), numSamples);
+    std::vector<float> input(numSamples);
+    std::vector<float> low(numSamples);
+    std::vector<float> mid(numSamples);
+    ring.read(0, input.data(), numSamples);
+    ring.read(1, low.data(), numSamples);
+    ring.read(2, mid.data(), numSamples);
+    ring.discard(numSamples);
+
+    for (size_t i = 0; i < numSamples; ++i)
+        EXPECT_FLOAT_EQ(input[i], generateSine(kFreq, static_cast<int>(i), kSampleRate));
+    EXPECT_FLOAT_EQ(rmsLevel(low.data(), buffer.getNumSamples()), 0.0f);
+    EXPECT_NEAR(rmsLevel(mid.data(), buffer.getNumSamples()), std::sqrt(0.5f), 0.05f);
+}
+
+TEST(PluginTest, MidiControllerActsAtItsSamplePosition) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    auto reference = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+    reference->prepareToPlay(kSampleRate, 512);
+    EXPECT_TRUE(processor->acceptsMidi());
+
+    processor->getMidiCcMap().assign(MidiCcMap::targetFor(ParamID::kLow), {1, 1, true});
+
+    constexpr float kFreq = 50.0f;
+    constexpr int kBlockSize = 512;
+    constexpr int kChangeAt = 200;
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::AudioBuffer<float> expected(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer midi;
+    juce::MidiBuffer noMidi;
+    int sampleIndex = 0;
+
+    auto processBlock = [&] {
+        for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                buffer.setSample(ch, i, generateSine(kFreq, sampleIndex, kSampleRate));
+        expected.makeCopyOf(buffer);
+        processor->processBlock(buffer, midi);
+        reference->processBlock(expected, noMidi);
+    };
+
+    for (int block = 0; block < 10; ++block) processBlock();
+
+    // Kill the low band (the bottom of the knob) from sample kChangeAt
+    midi.addEvent(juce::MidiMessage::controllerEvent(1, 1, 0), kChangeAt);
+    midi.addEvent(juce::MidiMessage::controllerEvent(1, 33, 0), kChangeAt);
+    processBlock();
+
+    // Split at the event, the block's first part may run a different crossover kernel
+    // from the reference's, so it matches up to rounding
+    for (int i = 0; i < kChangeAt; ++i)
+        ASSERT_NEAR(buffer.getSample(0, i), expected.getSample(0, i), 1.0e-5f) << "sample " << i;
+    EXPECT_GT(std::abs(buffer.getSample(0, kChangeAt + 50) - expected.getSample(0, kChangeAt + 50)),
+              1.0e-3f);
+
+    midi.clear();
+    for (int block = 0; block < 4; ++block) processBlock();
+    EXPECT_LT(rmsLevel(buffer.getReadPointer(0), kBlockSize), 0.01f);
+}
+
+TEST(PluginTest, LoadStatsCoverEveryBlockAndStayOutOfTheState) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, 512);
+
+    juce::AudioBuffer<float> buffer(kNumTestChannels, 512);
+    juce::MidiBuffer midi;
+    for (int block = 0; block < 20; ++block) {
+        buffer.clear();
+        processor->processBlock(buffer, midi);
+    }
+
+    const auto stats = processor->getLoadStats();
+    EXPECT_EQ(stats.numBlocks, 20);
+    int64_t binned = 0;
+    for (const auto count : stats.histogram) binned += count;
+    EXPECT_EQ(binned, 20);
+    EXPECT_GT(stats.worstBlockMs, 0.0);
+    EXPECT_EQ(stats.worstBlockSize, 512);
+
+    // Playing doesn't change the state, so a session isn't marked as edited by it
+    juce::MemoryBlock state;
+    processor->getStateInformation(state);
+    processor->processBlock(buffer, midi);
+    juce::MemoryBlock laterState;
+    processor->getStateInformation(laterState);
+    EXPECT_EQ(state, laterState);
+
+    BinaryStateReader reader(state.getData(), state.getSize());
+    while (reader.nextChunk()) EXPECT_NE(reader.getTag(), LoadStats::kChunkTag);
+
+    // They have a state block of their own, written on request
+    juce::MemoryBlock loadState;
+    processor->getLoadStatsInformation(loadState);
+    ASSERT_TRUE(BinaryStateReader::canRead(loadState.getData(), loadState.getSize()));
+    BinaryStateReader loadReader(loadState.getData(), loadState.getSize());
+    ASSERT_TRUE(loadReader.nextChunk());
+    EXPECT_EQ(loadReader.getTag(), LoadStats::kChunkTag);
+    const auto saved = LoadStats::readFrom(loadReader.getPayload());
+    ASSERT_TRUE(saved.has_value());
+    EXPECT_EQ(saved->numBlocks, 21);
+    EXPECT_EQ(saved->histogram, processor->getLoadStats().histogram);
+    EXPECT_EQ(saved->worstBlockSize, 512);
+    EXPECT_FALSE(loadReader.nextChunk());
+
+    // States saved with the figures still restore; preparing starts them over
+    juce::MemoryBlock oldState;
+    {
+        BinaryStateWriter writer(oldState);
+        writer.writeChunk(chunkTag("LOAD"), [](juce::OutputStream& stream) {
+            stream.writeInt64(20);
+        });
+        writer.writeChunk(chunkTag("PARM"), [](juce::OutputStream& stream) {
+            stream.writeByte(1);
+            BinaryState::writeId(stream, ParamID::kHigh);
+            stream.writeFloat(-6.0f);
+        });
+    }
+    processor->setStateInformation(oldState.getData(), static_cast<int>(oldState.getSize()));
+    EXPECT_FLOAT_EQ(processor->getAPVTS().getRawParameterValue(ParamID::kHigh)->load(), -6.0f);
+    processor->prepareToPlay(kSampleRate, 512);
+    EXPECT_EQ(processor->getLoadStats().numBlocks, 0);
+}
+
+TEST(PluginTest, SilenceIdlesAndResumesFromRest) {
+    constexpr int kBlockSize = 512;
+    constexpr float kFreq = 100.0f;
+
+    for (const bool linearPhase : {false, true}) {
+        SCOPED_TRACE(linearPhase ? "linear phase" : "minimum phase");
+
+        auto played = std::make_unique<AudioPluginAudioProcessor>();
+        auto fresh = std::make_unique<AudioPluginAudioProcessor>();
+        for (auto* processor : {played.get(), fresh.get()}) {
+            processor->getAPVTS()
+                .getParameter(ParamID::kLinearPhase)
+                ->setValueNotifyingHost(linearPhase ? 1.0f : 0.0f);
+            processor->prepareToPlay(kSampleRate, kBlockSize);
+            processor->setMeteringEnabled(true);  // runs the bands even at unity
+        }
+
+        juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+        juce::AudioBuffer<float> expected(kNumTestChannels, kBlockSize);
+        juce::MidiBuffer midi;
+        int sampleIndex = 0;
+        auto fillTone = [&] {
+            for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+                for (int ch = 0; ch < kNumTestChannels; ++ch)
+                    buffer.setSample(ch, i, generateSine(kFreq, sampleIndex, kSampleRate));
+        };
+        auto processSilence = [&](AudioPluginAudioProcessor& processor) {
+            buffer.clear();
+            processor.processBlock(buffer, midi);
+        };
+
+        for (int block = 0; block < 20; ++block) {
+            fillTone();
+            played->processBlock(buffer, midi);
+        }
+        EXPECT_FALSE(played->isIdle());
+
+        // Idle once the filters have rung down, within the reported tail
+        const double tailSamples = played->getTailLengthSeconds() * kSampleRate;
+        const int tailBlocks = static_cast<int>(std::ceil(tailSamples / kBlockSize));
+        int silentBlocks = 0;
+        while (!played->isIdle() && silentBlocks <= tailBlocks + 1) {
+            processSilence(*played);
+            ++silentBlocks;
+        }
+        EXPECT_TRUE(played->isIdle());
+        EXPECT_LE(silentBlocks, tailBlocks + 1);
+        EXPECT_FLOAT_EQ(buffer.getMagnitude(0, 0, kBlockSize), 0.0f);
+
+        for (int block = 0; block <= tailBlocks + 1 && !fresh->isIdle(); ++block)
+            processSilence(*fresh);
+        ASSERT_TRUE(fresh->isIdle());
+
+        // Resumes exactly like a processor that has never played
+        for (int block = 0; block < 10; ++block) {
+            fillTone();
+            expected.makeCopyOf(buffer);
+            played->processBlock(buffer, midi);
+            fresh->processBlock(expected, midi);
+            for (int i = 0; i < kBlockSize; ++i)
+                ASSERT_NEAR(buffer.getSample(0, i), expected.getSample(0, i), 1.0e-6f)
+                    << "block " << block << ", sample " << i;
+        }
+        EXPECT_FALSE(played->isIdle());
+        EXPECT_GT(rmsLevel(buffer.getReadPointer(0), kBlockSize), 0.5f);
+    }
+}
+
+TEST(PluginTest, SilentChannelGroupsPassThrough) {
+    constexpr int kBlockSize = 512;
+    constexpr int kNumChannels = 8;
+
+    // The last crossover group of channels goes quiet while the first keeps playing
+    Crossover<float> layout;
+    layout.prepare(kSampleRate, kNumChannels);
+    const int firstQuiet = (layout.getNumGroups(kNumChannels) - 1) * layout.getGroupSize();
+    ASSERT_GT(firstQuiet, 0);
+
+    juce::AudioProcessor::BusesLayout buses;
+    buses.inputBuses.add(juce::AudioChannelSet::discreteChannels(kNumChannels));
+    buses.outputBuses.add(juce::AudioChannelSet::discreteChannels(kNumChannels));
+
+    // played has the quiet channels play first; fresh never hears them until they resume
+    auto played = std::make_unique<AudioPluginAudioProcessor>();
+    auto fresh = std::make_unique<AudioPluginAudioProcessor>();
+    for (auto* processor : {played.get(), fresh.get()}) {
+        ASSERT_TRUE(processor->setBusesLayout(buses));
+        auto* lowParam = processor->getAPVTS().getParameter(ParamID::kLow);
+        lowParam->setValueNotifyingHost(lowParam->convertTo0to1(-6.0f));
+        processor->prepareToPlay(kSampleRate, kBlockSize);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    juce::AudioBuffer<float> buffer(kNumChannels, kBlockSize);
+    juce::AudioBuffer<float> expected(kNumChannels, kBlockSize);
+    juce::MidiBuffer midi;
+
+    // Noise on the playing channels; the quiet ones get quietValue, or noise too
+    auto fill = [&](bool quietPlaying, float quietValue) {
+        for (int ch = 0; ch < kNumChannels; ++ch)
+            for (int i = 0; i < kBlockSize; ++i)
+                buffer.setSample(ch, i, ch < firstQuiet || quietPlaying ? dist(rng) : quietValue);
+        expected.makeCopyOf(buffer);
+    };
+
+    for (int block = 0; block < 10; ++block) {
+        fill(true, 0.0f);
+        played->processBlock(buffer, midi);
+    }
+
+    const double tailSamples = played->getTailLengthSeconds() * kSampleRate;
+    const int tailBlocks = static_cast<int>(std::ceil(tailSamples / kBlockSize));
+    for (int block = 0; block < tailBlocks + 2; ++block) {
+        fill(false, 0.0f);
+        played->processBlock(buffer, midi);
+        fresh->processBlock(expected, midi);
+    }
+
+    // Rung down, the quiet group passes input below the threshold through untouched,
+    // which filtering at these gains would not
+    fill(false, 0.5f * kSilenceThreshold);
+    played->processBlock(buffer, midi);
+    EXPECT_FALSE(played->isIdle());
+    for (int ch = firstQuiet; ch < kNumChannels; ++ch)
+        for (int i = 0; i < kBlockSize; ++i)
+            ASSERT_EQ(buffer.getSample(ch, i), 0.5f * kSilenceThreshold)
+                << "channel " << ch << ", sample " << i;
+
+    // Resumes from rest, like a group that has never played
+    for (int block = 0; block < 4; ++block) {
+        fill(true, 0.0f);
+        played->processBlock(buffer, midi);
+        fresh->processBlock(expected, midi);
+        for (int ch = firstQuiet; ch < kNumChannels; ++ch)
+            for (int i = 0; i < kBlockSize; ++i)
+                ASSERT_NEAR(buffer.getSample(ch, i), expected.getSample(ch, i), 1.0e-6f)
+                    << "block " << block << ", channel " << ch << ", sample " << i;
+    }
+}
+
+TEST(PluginTest, MidiMapIsSavedWithState) {
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->getMidiCcMap().assign(2, {10, 12, false});
+
+    juce::MemoryBlock state;
+    processor->getStateInformation(state);
+
+    auto restored = std::make_unique<AudioPluginAudioProcessor>();
+    restored->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    EXPECT_EQ(restored->getMidiCcMap().getAssignment(2), (MidiCcMap::Assignment{10, 12, false}));
+}
+
+TEST(PluginTest, StateRestoresParametersAndReadsXmlStates) {
+    auto source = std::make_unique<AudioPluginAudioProcessor>();
+    auto& apvts = source->getAPVTS();
+    const std::array<std::pair<const char*, float>, 4> values = {
+        {{ParamID::kLow, -100.0f}, {ParamID::kHigh, 6.0f}, {ParamID::kLowMidFreq, 400.0f},
+         {ParamID::kLinearPhase, 1.0f}}};
+    for (const auto& [id, value] : values)
+        apvts.getParameter(id)->setValueNotifyingHost(
+            apvts.getParameter(id)->convertTo0to1(value));
+    source->getMidiCcMap().assign(1, {3, 20, true});
+    const Scene scene{{kKillThresholdDb, 3.0f, -6.0f}, 1, 0.5f};
+    source->storeScene(3, scene);
+
+    // The XML state earlier versions saved
+    juce::MemoryBlock xmlState;
+    {
+        std::unique_ptr<juce::XmlElement> xml(apvts.copyState().createXml());
+        source->getMidiCcMap().saveTo(*xml);
+        xml->createNewChildElement(LoadStats::kStateTag);
+        juce::AudioProcessor::copyXmlToBinary(*xml, xmlState);
+    }
+    juce::MemoryBlock binaryState;
+    source->getStateInformation(binaryState);
+    EXPECT_TRUE(BinaryStateReader::canRead(binaryState.getData(), binaryState.getSize()));
+    EXPECT_FALSE(BinaryStateReader::canRead(xmlState.getData(), xmlState.getSize()));
+
+    for (const auto* state : {&binaryState, &xmlState}) {
+        SCOPED_TRACE(state == &binaryState ? "binary" : "xml");
+
+        auto restored = std::make_unique<AudioPluginAudioProcessor>();
+        restored->getAPVTS().getParameter(ParamID::kMid)->setValueNotifyingHost(0.0f);
+        restored->setStateInformation(state->getData(), static_cast<int>(state->getSize()));
+
+        for (const auto* id : kParameterIds)
+            EXPECT_FLOAT_EQ(*restored->getAPVTS().getRawParameterValue(id),
+                            *apvts.getRawParameterValue(id))
+                << id;
+        EXPECT_EQ(restored->getMidiCcMap().getAssignment(1), (MidiCcMap::Assignment{3, 20, true}));
+        EXPECT_EQ(restored->getScene(3), state == &binaryState ? scene : Scene{});
+    }
+}
+
+TEST(PluginTest, ProgramChangeRecallsSceneAtItsSample) {
+    constexpr int kBlockSize = 512;
+    constexpr int kPosition = 300;
+
+    auto recalled = std::make_unique<AudioPluginAudioProcessor>();
+    auto reference = std::make_unique<AudioPluginAudioProcessor>();
+    for (auto* processor : {recalled.get(), reference.get()})
+        processor->prepareToPlay(kSampleRate, kBlockSize);
+    const Scene kill{{kKillThresholdDb, kKillThresholdDb, kKillThresholdDb}, 0, 0.0f};
+    recalled->storeScene(2, kill);
+
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::AudioBuffer<float> expected(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer programChange;
+    programChange.addEvent(juce::MidiMessage::programChange(1, 2), kPosition);
+    juce::MidiBuffer noMidi;
+    int sampleIndex = 0;
+
+    // Long enough for the gain smoothing to settle on the kill
+    for (int block = 0; block < 10; ++block) {
+        for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                buffer.setSample(ch, i, generateSine(1000.0f, sampleIndex, kSampleRate));
+        expected.makeCopyOf(buffer);
+        recalled->processBlock(buffer, block == 0 ? programChange : noMidi);
+        reference->processBlock(expected, noMidi);
+
+        if (block == 0) {
+            // Untouched up to the program change, moving from its sample on
+            for (int i = 0; i < kPosition; ++i)
+                ASSERT_FLOAT_EQ(buffer.getSample(0, i), expected.getSample(0, i)) << i;
+            EXPECT_GT(std::abs(buffer.getSample(0, kPosition) - expected.getSample(0, kPosition)),
+                      1.0e-4f);
+        }
+    }
+
+    // Killed, with the parameters set to the scene
+    EXPECT_LT(rmsLevel(buffer.getReadPointer(0), kBlockSize), 1.0e-4f);
+    EXPECT_EQ(recalled->captureScene(), kill);
+}
+
+TEST(PluginTest, SceneMorphsInOverItsTime) {
+    constexpr int kBlockSize = 480;  // 10 ms
+    constexpr int kMorphBlocks = 10;
+
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    processor->prepareToPlay(kSampleRate, kBlockSize);
+    processor->storeScene(1, {{kKillThresholdDb, kKillThresholdDb, kKillThresholdDb}, 0, 0.1f});
+    ASSERT_TRUE(processor->recallScene(1));
+
+    juce::AudioBuffer<float> buffer(kNumTestChannels, kBlockSize);
+    juce::MidiBuffer midi;
+    int sampleIndex = 0;
+    std::vector<float> levelsDb;
+    for (int block = 0; block < kMorphBlocks + 4; ++block) {
+        for (int i = 0; i < kBlockSize; ++i, ++sampleIndex)
+            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                buffer.setSample(ch, i, generateSine(1000.0f, sampleIndex, kSampleRate));
+        processor->processBlock(buffer, midi);
+        levelsDb.push_back(20.0f * std::log10(rmsLevel(buffer.getReadPointer(0), kBlockSize)));
+    }
+
+    // Down the dB range in step with the morph, then killed
+    for (size_t block = 1; block < kMorphBlocks; ++block)
+        EXPECT_LT(levelsDb[block], levelsDb[block - 1]) << block;
+    EXPECT_NEAR(levelsDb[4] - levelsDb[0], -40.0f, 10.0f);
+    EXPECT_LT(levelsDb.back(), -90.0f);
+}
+
+TEST(PluginTest, DecksHaveTheirOwnBandGains) {
+    constexpr int kNumDecks = 4;
+    constexpr int kBlockSize = 512;
+
+    auto decks = std::make_unique<AudioPluginAudioProcessor>(kNumDecks);
+    auto single = std::make_unique<AudioPluginAudioProcessor>();
+    ASSERT_EQ(decks->getTotalNumInputChannels(), 2 * kNumDecks);
+
+    // A stereo pair per deck, and nothing else
+    auto makeLayout = [](const juce::AudioChannelSet& lastOutput) {
+        juce::AudioProcessor::BusesLayout layout;
+        for (int deck = 0; deck < kNumDecks; ++deck) {
+            layout.inputBuses.add(juce::AudioChannelSet::stereo());
+            layout.outputBuses.add(deck + 1 < kNumDecks ? juce::AudioChannelSet::stereo()
+                                                        : lastOutput);
+        }
+        return layout;
+    };
+    EXPECT_TRUE(decks->isBusesLayoutSupported(makeLayout(juce::AudioChannelSet::stereo())));
+    EXPECT_FALSE(decks->isBusesLayoutSupported(makeLayout(juce::AudioChannelSet::mono())));
+    EXPECT_NE(decks->getAPVTS().getParameter(kDeckBandIds[3][2]), nullptr);
+    EXPECT_EQ(single->getAPVTS().getParameter(kDeckBandIds[1][0]), nullptr);
+
+    // Deck 2's low killed, deck 3 cut like the single-deck instance
+    auto setParameter = [](AudioPluginAudioProcessor& processor, const char* id, float value) {
+        auto* param = processor.getAPVTS().getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    };
+    setParameter(*decks, kDeckBandIds[1][0], kKillThresholdDb);
+    setParameter(*decks, kDeckBandIds[2][1], -12.0f);
+    setParameter(*single, ParamID::kMid, -12.0f);
+    decks->prepareToPlay(kSampleRate, kBlockSize);
+    single->prepareToPlay(kSampleRate, kBlockSize);
+
+    constexpr int kTotalSamples = kWarmupSamples + kTestSamples;
+    juce::AudioBuffer<float> buffer(2 * kNumDecks, kTotalSamples);
+    juce::AudioBuffer<float> expected(kNumTestChannels, kTotalSamples);
+    for (int i = 0; i < kTotalSamples; ++i) {
+        const float sample =
+            generateSine(50.0f, i, kSampleRate) + generateSine(1000.0f, i, kSampleRate);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch) buffer.setSample(ch, i, sample);
+        for (int ch = 0; ch < kNumTestChannels; ++ch) expected.setSample(ch, i, sample);
+    }
+    const juce::AudioBuffer<float> input(buffer);
+
+    juce::MidiBuffer midi;
+    for (int pos = 0; pos < kTotalSamples; pos += kBlockSize) {
+        const int blockSize = std::min(kBlockSize, kTotalSamples - pos);
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                       pos, blockSize);
+        juce::AudioBuffer<float> reference(expected.getArrayOfWritePointers(), kNumTestChannels,
+                                           pos, blockSize);
+        decks->processBlock(block, midi);
+        single->processBlock(reference, midi);
+    }
+
+    auto levelDb = [](const juce::AudioBuffer<float>& source, int ch) {
+        const float rms = rmsLevel(source.getReadPointer(ch) + kWarmupSamples, kTestSamples);
+        return 20.0f * std::log10(rms);
+    };
+    const float inputDb = levelDb(input, 0);
+    for (int ch = 0; ch < 2 * kNumDecks; ++ch) {
+        SCOPED_TRACE(ch);
+        const int deck = ch / 2;
+        if (deck == 1) {
+            // The 50 Hz half gone, the 1 kHz half left
+            EXPECT_NEAR(levelDb(buffer, ch) - inputDb, -3.0f, 0.5f);
+        } else if (deck == 2) {
+            for (int i = kWarmupSamples; i < kTotalSamples; ++i)
+                ASSERT_NEAR(buffer.getSample(ch, i), expected.getSample(ch % 2, i), 1.0e-4f) << i;
+        } else {
+            EXPECT_NEAR(levelDb(buffer, ch) - inputDb, 0.0f, 0.1f);
+        }
+    }
+}
+
+TEST(PluginTest, DeckScenesAndStateFollowTheDeck) {
+    constexpr int kNumDecks = 3;
+    constexpr int kBlockSize = 256;
+
+    auto decks = std::make_unique<AudioPluginAudioProcessor>(kNumDecks);
+    decks->prepareToPlay(kSampleRate, kBlockSize);
+    const Scene scene{{-20.0f, kKillThresholdDb, 3.0f}, 1, 0.0f};
+    decks->storeScene(4, scene);
+
+    // Program change 4 on MIDI channel 3 recalls onto deck 3 alone; channel 4 has no deck
+    juce::AudioBuffer<float> buffer(2 * kNumDecks, kBlockSize);
+    buffer.clear();
+    juce::MidiBuffer midi;
+    midi.addEvent(juce::MidiMessage::programChange(3, 4), 10);
+    midi.addEvent(juce::MidiMessage::programChange(4, 4), 20);
+    decks->processBlock(buffer, midi);
+    decks->processBlock(buffer, midi);
+
+    const Scene untouched{{0.0f, 0.0f, 0.0f}, 1, 0.0f};
+    EXPECT_EQ(decks->captureScene(0.0f, 2), scene);
+    EXPECT_EQ(decks->captureScene(0.0f, 0), untouched);
+    EXPECT_EQ(decks->captureScene(0.0f, 1), untouched);
+
+    // The deck gains are saved; an instance with fewer decks restores the ones it has
+    auto* high2 = decks->getAPVTS().getParameter(kDeckBandIds[1][2]);
+    high2->setValueNotifyingHost(high2->convertTo0to1(6.0f));
+    juce::MemoryBlock state;
+    decks->getStateInformation(state);
+    for (int restoredDecks : {kNumDecks, 1}) {
+        SCOPED_TRACE(restoredDecks);
+        auto restored = std::make_unique<AudioPluginAudioProcessor>(restoredDecks);
+        restored->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+        EXPECT_FLOAT_EQ(restored->captureScene().gainsDb[2], 0.0f);
+        if (restoredDecks > 1) {
+            EXPECT_FLOAT_EQ(restored->captureScene(0.0f, 1).gainsDb[2], 6.0f);
+        }
+    }
+}
+
+TEST(SceneMorphTest, MorphsLinearlyInDbInSteps) {
+    SceneMorph morph;
+    morph.prepare(kSampleRate);
+    const SceneMorph::Values from{{kKillThresholdDb, 0.0f, 6.0f}, 6.0f};
+    const SceneMorph::Values to{{0.0f, -20.0f, 6.0f}, 12.0f};
+
+    morph.start(from, 0.01f);  // 480 samples
+    EXPECT_TRUE(morph.isActive());
+    EXPECT_EQ(morph.getStepSamples(512), SceneMorph::kStepSamples);
+    EXPECT_FLOAT_EQ(morph.apply(to).gainsDb[0], kKillThresholdDb);
+
+    morph.advance(240);
+    const auto halfway = morph.apply(to);
+    EXPECT_FLOAT_EQ(halfway.gainsDb[0], -50.0f);
+    EXPECT_FLOAT_EQ(halfway.gainsDb[1], -10.0f);
+    EXPECT_FLOAT_EQ(halfway.gainsDb[2], 6.0f);
+    EXPECT_FLOAT_EQ(halfway.boostMaxDb, 9.0f);
+
+    morph.advance(1000);
+    EXPECT_FALSE(morph.isActive());
+    EXPECT_FLOAT_EQ(morph.apply(to).gainsDb[1], -20.0f);
+    EXPECT_EQ(morph.getStepSamples(512), 512);
+
+    // Shorter than a sample is at once
+    morph.start(from, 0.0f);
+    EXPECT_FALSE(morph.isActive());
+}
+
+TEST(BinaryStateTest, SkipsUnknownChunksAndRejectsDamage) {
+    juce::MemoryBlock state;
+    {
+        BinaryStateWriter writer(state);
+        writer.writeChunk(chunkTag("NEXT"), [](juce::OutputStream& stream) {
+            stream.writeInt64(42);  // from a later version
+        });
+        writer.writeChunk(MidiCcMap::kChunkTag, [](juce::OutputStream& stream) {
+            MidiCcMap map;
+            map.assign(MidiCcMap::targetFor(ParamID::kBoost), {16, 100, false});
+            map.writeTo(stream);
+        });
+    }
+
+    auto readMap = [](const juce::MemoryBlock& data) {
+        MidiCcMap map;
+        map.assign(0, {1, 1, false});
+        BinaryStateReader reader(data.getData(), data.getSize());
+        while (reader.nextChunk())
+            if (reader.getTag() == MidiCcMap::kChunkTag) map.readFrom(reader.getPayload());
+        return map.getAssignment(MidiCcMap::targetFor(ParamID::kBoost));
+    };
+    ASSERT_TRUE(BinaryStateReader::canRead(state.getData(), state.getSize()));
+    EXPECT_EQ(readMap(state), (MidiCcMap::Assignment{16, 100, false}));
+
+    // A truncated chunk is not read
+    juce::MemoryBlock truncated;
+    truncated.append(state.getData(), state.getSize() - 1);
+    EXPECT_FALSE(readMap(truncated).has_value());
+
+    // Nor is a state from a newer version
+    auto* version = static_cast<char*>(state.getData()) + 4;
+    version[0] = static_cast<char>(BinaryState::kVersion + 1);
+    EXPECT_FALSE(BinaryStateReader::canRead(state.getData(), state.getSize()));
+}
+
+// ===== Real-time safety =====
+
+TEST(RealtimeSafetyTest, CatchesAllocationsLocksAndSleeps) {
+    if (!realtime_safety::isSupported()) GTEST_SKIP() << "needs glibc symbol interposition";
+
+    // Called through volatile pointers so the compiler cannot pair them up and elide them
+    void* (*volatile allocate)(size_t) = std::malloc;
+    void (*volatile release)(void*) = std::free;
+    std::mutex mutex;
+
+    const auto report = realtime_safety::check([&] {
+        release(allocate(64));
+        const std::lock_guard lock(mutex);
+        std::this_thread::sleep_for(std::chrono::microseconds(1));
+    });
+    EXPECT_EQ(report.numViolations, 4);
+    EXPECT_EQ(report.firstViolation.rfind("malloc called from", 0), 0u) << report.firstViolation;
+
+    // Disarmed: nothing is recorded
+    release(allocate(64));
+    EXPECT_EQ(realtime_safety::check([] {}).numViolations, 0);
+}
+
+namespace {
+
+template <typename SampleType>
+void expectCrossoverIsRealtimeSafe() {
+    constexpr int kBlockSize = 512;
+    Crossover<SampleType> xover;
+    xover.prepare(kSampleRate, kNumTestChannels);
+    const auto retuned = CrossoverCoefficients<>::make(kSampleRate, {120.0f, 5000.0f});
+
+    juce::AudioBuffer<SampleType> input(kNumTestChannels, kBlockSize);
+    juce::AudioBuffer<SampleType> bands(kNumBands * kNumTestChannels, kBlockSize);
+    SampleType* const* bandData = bands.getArrayOfWritePointers();
+    for (int ch = 0; ch < kNumTestChannels; ++ch)
+        for (int i = 0; i < kBlockSize; ++i)
+            input.setSample(ch, i, static_cast<SampleType>(generateSine(1000.0f, i, kSampleRate)));
+
+    SampleType sum = 0;
+    const auto report = realtime_safety::check([&] {
+        xover.glideTo(retuned);
+        xover.processBlock(input.getArrayOfReadPointers(),
+                           {bandData, bandData + kNumTestChannels, bandData + 2 * kNumTestChannels},
+                           kNumTestChannels, kBlockSize);
+        xover.processBlockSummed(input.getArrayOfReadPointers(), input.getArrayOfWritePointers(),
+                                 kNumTestChannels, kBlockSize);
+        for (int i = 0; i < kBlockSize; ++i) {
+            const auto [low, mid, high] = xover.processSample(0, input.getSample(0, i));
+            sum += low + mid + high;
+        }
+    });
+    EXPECT_EQ(report.numViolations, 0) << report.firstViolation;
+    EXPECT_TRUE(std::isfinite(sum));
+}
+
+// Runs the processor over every combination of band gains, boost, mode and metering, in
+// blocks of blockSize, with the checks armed around each processBlock call only. MIDI
+// controllers and crossover frequency changes arrive along the way.
+template <typename SampleType>
+void expectProcessBlockIsRealtimeSafe(int blockSize) {
+    constexpr int kPreparedBlockSize = 512;
+    constexpr float kGainsDb[] = {kKillThresholdDb, -12.0f, 0.0f, 6.0f};
+
+    auto processor = std::make_unique<AudioPluginAudioProcessor>();
+    if constexpr (std::is_same_v<SampleType, double>)
+        processor->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    processor->prepareToPlay(kSampleRate, kPreparedBlockSize);
+    processor->getMidiCcMap().assign(MidiCcMap::targetFor(ParamID::kLow), {1, 1, true});
+
+    auto& apvts = processor->getAPVTS();
+    auto setParameter = [&apvts](const char* id, float value) {
+        auto* param = apvts.getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    };
+
+    juce::AudioBuffer<SampleType> buffer(kNumTestChannels, blockSize);
+    juce::MidiBuffer controllers;
+    juce::MidiBuffer noMidi;
+    controllers.addEvent(juce::MidiMessage::controllerEvent(1, 1, 90), blockSize / 2);
+    controllers.addEvent(juce::MidiMessage::controllerEvent(1, 33, 17), blockSize / 2);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<SampleType> dist(-1, 1);
+    BandLevels levels;
+    int combination = 0;
+
+    for (int boost = 0; boost < 3; ++boost) {
+        for (float lowDb : kGainsDb) {
+            for (float midDb : kGainsDb) {
+                for (float highDb : kGainsDb) {
+                    for (int linearPhase = 0; linearPhase < 2; ++linearPhase) {
+                        for (int metering = 0; metering < 2; ++metering, ++combination) {
+                            setParameter(ParamID::kBoost, static_cast<float>(boost));
+                            setParameter(ParamID::kLow, lowDb);
+                            setParameter(ParamID::kMid, midDb);
+                            setParameter(ParamID::kHigh, highDb);
+                            setParameter(ParamID::kLinearPhase, static_cast<float>(linearPhase));
+                            setParameter(ParamID::kLowMidFreq, combination % 8 < 4 ? 250.0f
+                                                                                   : 400.0f);
+                            setParameter(ParamID::kDrive, combination % 16 < 8 ? 0.0f : 60.0f);
+                            setParameter(ParamID::kSweepDepth,
+                                         combination % 32 < 16 ? 0.0f : 1.0f);
+                            processor->setMeteringEnabled(metering != 0);
+                            processor->setAnalyzerEnabled(combination % 64 >= 32);
+
+                            for (int ch = 0; ch < kNumTestChannels; ++ch)
+                                for (int i = 0; i < blockSize; ++i)
+                                    buffer.setSample(ch, i, dist(rng));
+                            auto& midi = combination % 3 == 0 ? controllers : noMidi;
+
+                            const auto report = realtime_safety::check(
+                                [&] { processor->processBlock(buffer, midi); });
+                            if (report.numViolations > 0) {
+                                ADD_FAILURE() << report.numViolations << " violations with boost "
+                                              << boost << ", gains " << lowDb << "/" << midDb
+                                              << "/" << highDb << " dB, linear phase "
+                                              << linearPhase << ", metering " << metering
+                                              << ", block size " << blockSize << ": "
+                                              << report.firstViolation;
+                                return;
+                            }
+
+                            while (processor->popBandLevels(levels)) {
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Scene recalls by program change, at once and morphing in
+    processor->storeScene(1, {{kKillThresholdDb, 0.0f, 6.0f}, 2, 0.0f});
+    processor->storeScene(2, {{0.0f, -12.0f, 0.0f}, 0, 0.05f});
+    juce::MidiBuffer programChanges;
+    programChanges.addEvent(juce::MidiMessage::programChange(1, 1), 0);
+    programChanges.addEvent(juce::MidiMessage::programChange(1, 2), blockSize / 2);
+    for (int block = 0; block < 8; ++block) {
+        auto& midi = block == 0 ? programChanges : noMidi;
+        const auto report = realtime_safety::check([&] { processor->processBlock(buffer, midi); });
+        if (report.numViolations > 0) {
+            ADD_FAILURE() << report.numViolations << " violations recalling scenes, block size "
+                          << blockSize << ": " << report.firstViolation;
+            return;
+        }
+    }
+    EXPECT_TRUE(std::isfinite(buffer.getSample(0, blockSize - 1)));
+
+    // Four decks, one metered, with their gains moving and a recall on deck 3
+    auto decks = std::make_unique<AudioPluginAudioProcessor>(kMaxDecks);
+    if constexpr (std::is_same_v<SampleType, double>)
+        decks->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    decks->prepareToPlay(kSampleRate, kPreparedBlockSize);
+    decks->setMeteringEnabled(true);
+    decks->setMeteredDeck(1);
+    decks->storeScene(2, {{0.0f, -12.0f, 0.0f}, 0, 0.05f});
+
+    juce::AudioBuffer<SampleType> deckBuffer(2 * kMaxDecks, blockSize);
+    juce::MidiBuffer deckRecall;
+    deckRecall.addEvent(juce::MidiMessage::programChange(3, 2), blockSize / 2);
+    for (int block = 0; block < 8; ++block) {
+        const auto band = static_cast<size_t>(block % kNumBands);
+        for (size_t deck = 0; deck < kDeckBandIds.size(); ++deck) {
+            auto* param = decks->getAPVTS().getParameter(kDeckBandIds[deck][band]);
+            const float gainDb =
+                kGainsDb[(deck + static_cast<size_t>(block)) % std::size(kGainsDb)];
+            param->setValueNotifyingHost(param->convertTo0to1(gainDb));
+        }
+        for (int ch = 0; ch < deckBuffer.getNumChannels(); ++ch)
+            for (int i = 0; i < blockSize; ++i) deckBuffer.setSample(ch, i, dist(rng));
+
+        auto& midi = block == 0 ? deckRecall : noMidi;
+        const auto report = realtime_safety::check([&] { decks->processBlock(deckBuffer, midi); });
+        if (report.numViolations > 0) {
+            ADD_FAILURE() << report.numViolations << " violations with " << kMaxDecks
+                          << " decks, block size " << blockSize << ": " << report.firstViolation;
+            return;
+        }
+        while (decks->popBandLevels(levels)) {
+        }
+    }
+
+    // A 7.1.4 layout shared out to worker threads, with its gains moving
+    auto parallel = std::make_unique<AudioPluginAudioProcessor>();
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::create7point1point4());
+    layout.outputBuses.add(juce::AudioChannelSet::create7point1point4());
+    ASSERT_TRUE(parallel->setBusesLayout(layout));
+    if constexpr (std::is_same_v<SampleType, double>)
+        parallel->setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    parallel->prepareToPlay(kSampleRate, kPreparedBlockSize);
+    parallel->setNumWorkerThreads(2);
+
+    juce::AudioBuffer<SampleType> wideBuffer(parallel->getTotalNumInputChannels(), blockSize);
+    auto* lowParam = parallel->getAPVTS().getParameter(ParamID::kLow);
+    for (int block = 0; block < 8; ++block) {
+        const float lowDb = kGainsDb[static_cast<size_t>(block) % std::size(kGainsDb)];
+        lowParam->setValueNotifyingHost(lowParam->convertTo0to1(lowDb));
+        for (int ch = 0; ch < wideBuffer.getNumChannels(); ++ch)
+            for (int i = 0; i < blockSize; ++i) wideBuffer.setSample(ch, i, dist(rng));
+
+        const auto report =
+            realtime_safety::check([&] { parallel->processBlock(wideBuffer, noMidi); });
+        if (report.numViolations > 0) {
+            ADD_FAILURE() << report.numViolations << " violations with worker threads, block size "
+                          << blockSize << ": " << report.firstViolation;
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+TEST(RealtimeSafetyTest, CrossoverIsRealtimeSafe) {
+    if (!realtime_safety::isSupported()) GTEST_SKIP() << "needs glibc symbol interposition";
+    expectCrossoverIsRealtimeSafe<float>();
+    expectCrossoverIsRealtimeSafe<double>();
+}
+
+TEST(RealtimeSafetyTest, ProcessBlockIsRealtimeSafe) {
+    if (!realtime_safety::isSupported()) GTEST_SKIP() << "needs glibc symbol interposition";
+
+    // 1500 is larger than the block size the processor was prepared for
+    for (int blockSize : {1, 32, 512, 1500}) {
+        SCOPED_TRACE(blockSize);
+        expectProcessBlockIsRealtimeSafe<float>(blockSize);
+        expectProcessBlockIsRealtimeSafe<double>(blockSize);
+    }
 }
@@ -0,0 +1,286 @@
+#include "RealtimeSafety.h"
+
+#include <sstream>
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define ISO3D_REALTIME_CHECKS 1
+#else
+#define ISO3D_REALTIME_CHECKS 0
+#endif
+
+#if ISO3D_REALTIME_CHECKS
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+
+// glibc's own allocator entry points, which the interposed malloc family forwards to
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+
+// Declared here rather than through <unistd.h>, whose fortified inline wrappers could not
+// be redefined
+ssize_t write(int fd, const void* buffer, size_t count);
+int usleep(useconds_t microseconds);
+unsigned int sleep(unsigned int seconds);
+}
+
+namespace {
+
+constexpr int kMaxFrames = 48;
+
+struct Violation {
+    const char* function;
+    void* frames[kMaxFrames];
+    int numFrames;
+};
+
+constinit thread_local bool armed = false;
+constinit thread_local bool recording = false;  // set while a violation is recorded
+constinit thread_local int numViolations = 0;
+constinit thread_local Violation firstViolation{};
+
+void record(const char* function) {
+    if (!armed || recording) return;
+
+    // backtrace() may allocate the first time it runs; that is not the caller's doing
+    recording = true;
+    if (numViolations++ == 0) {
+        firstViolation.function = function;
+        firstViolation.numFrames = backtrace(firstViolation.frames, kMaxFrames);
+    }
+    recording = false;
+}
+
+// The next definition of an interposed function, normally the C library's. Resolved
+// during static initialisation, or on first use if that comes earlier.
+template <typename Function>
+Function next(Function& cached, const char* name) {
+    if (cached == nullptr) cached = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    return cached;
+}
+
+struct NextFunctions {
+    decltype(&pthread_mutex_lock) mutexLock = nullptr;
+    decltype(&pthread_rwlock_rdlock) rwlockReadLock = nullptr;
+    decltype(&pthread_rwlock_wrlock) rwlockWriteLock = nullptr;
+    decltype(&pthread_cond_wait) condWait = nullptr;
+    decltype(&pthread_cond_timedwait) condTimedWait = nullptr;
+    decltype(&pthread_join) join = nullptr;
+    decltype(&sem_wait) semWait = nullptr;
+    decltype(&nanosleep) nanoSleep = nullptr;
+    decltype(&clock_nanosleep) clockNanoSleep = nullptr;
+    decltype(&usleep) microSleep = nullptr;
+    decltype(&sleep) secondSleep = nullptr;
+    decltype(&write) writeFd = nullptr;
+};
+
+NextFunctions nextFunctions;
+
+// Resolves everything up front and runs backtrace() once, so neither happens for the
+// first time on a thread being checked
+const bool resolved = [] {
+    auto& f = nextFunctions;
+    next(f.mutexLock, "pthread_mutex_lock");
+    next(f.rwlockReadLock, "pthread_rwlock_rdlock");
+    next(f.rwlockWriteLock, "pthread_rwlock_wrlock");
+    next(f.condWait, "pthread_cond_wait");
+    next(f.condTimedWait, "pthread_cond_timedwait");
+    next(f.join, "pthread_join");
+    next(f.semWait, "sem_wait");
+    next(f.nanoSleep, "nanosleep");
+    next(f.clockNanoSleep, "clock_nanosleep");
+    next(f.microSleep, "usleep");
+    next(f.secondSleep, "sleep");
+    next(f.writeFd, "write");
+
+    void* frame[1];
+    return backtrace(frame, 1) >= 0;
+}();
+
+std::string describeFrame(const char* symbol) {
+    // glibc formats frames as "binary(mangled+offset) [address]"
+    std::string frame = symbol;
+    const auto open = frame.find('(');
+    const auto plus = frame.find('+', open);
+    if (open == std::string::npos || plus == std::string::npos || plus == open + 1) return frame;
+
+    const std::string mangled = frame.substr(open + 1, plus - open - 1);
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(
+        abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status), &std::free);
+    if (status != 0 || demangled == nullptr) return frame;
+
+    // "name+offset [address]"
+    std::string offsetAndAddress = frame.substr(plus);
+    const auto close = offsetAndAddress.find(')');
+    if (close != std::string::npos) offsetAndAddress.erase(close, 1);
+    return demangled.get() + offsetAndAddress;
+}
+
+}  // namespace
+
+// ----- Interposed C library functions -----
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    record("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    record("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+    record("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) noexcept {
+    if (pointer != nullptr) record("free");
+    __libc_free(pointer);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    record("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    record("posix_memalign");
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+
+    void* allocated = __libc_memalign(alignment, size);
+    if (allocated == nullptr) return ENOMEM;
+    *pointer = allocated;
+    return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    record("pthread_mutex_lock");
+    return next(nextFunctions.mutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept {
+    record("pthread_rwlock_rdlock");
+    return next(nextFunctions.rwlockReadLock, "pthread_rwlock_rdlock")(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept {
+    record("pthread_rwlock_wrlock");
+    return next(nextFunctions.rwlockWriteLock, "pthread_rwlock_wrlock")(lock);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex) {
+    record("pthread_cond_wait");
+    return next(nextFunctions.condWait, "pthread_cond_wait")(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex,
+                           const struct timespec* deadline) {
+    record("pthread_cond_timedwait");
+    return next(nextFunctions.condTimedWait, "pthread_cond_timedwait")(condition, mutex,
+                                                                       deadline);
+}
+
+int pthread_join(pthread_t thread, void** result) {
+    record("pthread_join");
+    return next(nextFunctions.join, "pthread_join")(thread, result);
+}
+
+int sem_wait(sem_t* semaphore) {
+    record("sem_wait");
+    return next(nextFunctions.semWait, "sem_wait")(semaphore);
+}
+
+int nanosleep(const struct timespec* duration, struct timespec* remaining) {
+    record("nanosleep");
+    return next(nextFunctions.nanoSleep, "nanosleep")(duration, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* duration,
+                    struct timespec* remaining) {
+    record("clock_nanosleep");
+    return next(nextFunctions.clockNanoSleep, "clock_nanosleep")(clock, flags, duration,
+                                                                 remaining);
+}
+
+int usleep(useconds_t microseconds) {
+    record("usleep");
+    return next(nextFunctions.microSleep, "usleep")(microseconds);
+}
+
+unsigned int sleep(unsigned int seconds) {
+    record("sleep");
+    return next(nextFunctions.secondSleep, "sleep")(seconds);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count) {
+    record("write");
+    return next(nextFunctions.writeFd, "write")(fd, buffer, count);
+}
+
+}  // extern "C"
+
+#endif  // ISO3D_REALTIME_CHECKS
+
+namespace realtime_safety {
+
+bool isSupported() { return ISO3D_REALTIME_CHECKS != 0; }
+
+#if ISO3D_REALTIME_CHECKS
+
+void arm() {
+    numViolations = 0;
+    firstViolation = {};
+    armed = resolved;
+}
+
+Report disarm() {
+    armed = false;
+
+    Report report;
+    report.numViolations = numViolations;
+    if (numViolations == 0) return report;
+
+    std::ostringstream description;
+    description << firstViolation.function << " called from\n";
+    std::unique_ptr<char*, decltype(&std::free)> symbols(
+        backtrace_symbols(firstViolation.frames, firstViolation.numFrames), &std::free);
+
+    // Skip record() and the interposed function itself
+    for (int frame = 2; frame < firstViolation.numFrames; ++frame) {
+        description << "  #" << frame - 2 << ' ';
+        if (symbols != nullptr)
+            description << describeFrame(symbols.get()[frame]);
+        else
+            description << firstViolation.frames[frame];
+        description << '\n';
+    }
+    report.firstViolation = description.str();
+    return report;
+}
+
+#else
+
+void arm() {}
+Report disarm() { return {}; }
+
+#endif
+
+}  // namespace realtime_safety
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+// Real-time-safety checks for code that has to run on an audio thread.
+//
+// While the checks are armed on a thread, everything that thread does that can block or
+// take unbounded time is recorded as a violation: heap allocation and free, mutex and
+// rwlock acquisition, condition variable, semaphore and thread joins, sleeps and writes
+// to file descriptors. The stack trace of the first violation is kept for the report.
+//
+// The test executable interposes the C library functions behind all of these, so calls
+// made deep inside JUCE or the standard library are caught too. Other threads, such as
+// the crossover tuner's, are never affected. Interposition relies on glibc: elsewhere
+// isSupported() is false and nothing is recorded.
+namespace realtime_safety {
+
+struct Report {
+    int numViolations = 0;
+    std::string firstViolation;  // the function called, then the stack trace leading to it
+};
+
+bool isSupported();
+
+// Arms the checks on the calling thread, and disarms them, returning what happened in
+// between. Prefer check().
+void arm();
+Report disarm();
+
+// Runs fn with the checks armed on the calling thread.
+template <typename Fn>
+Report check(Fn&& fn) {
+    arm();
+    std::forward<Fn>(fn)();
+    return disarm();
+}
+
+}  // namespace realtime_safety